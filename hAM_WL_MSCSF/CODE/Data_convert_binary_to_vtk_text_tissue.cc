@@ -113,6 +113,11 @@ int main(int argc, char *argv[])
 	end_time 	= 10;
 	interval	= 10;
 
+    int Nslices = 0;                    // 2D slices to write (in addition to or instead of full volumes)
+    char const *slice_plane[20];        // XY/XZ/YZ
+    int slice_pos[20];                  // position of slice along the normal axis
+    int Nthreads = omp_get_max_threads();
+
     Argument_parameters Argin;                                  // Initialise struct                            || lib/Arguments.h
     set_argument_defaults(&Argin);
     int counter = 1;
@@ -186,6 +191,28 @@ int main(int argc, char *argv[])
             }
             counter++;
         }
+        else if (strcmp(argv[counter], "Slice") == 0)
+        {
+            if (Nslices >= 20 || counter + 2 >= argc)
+            {
+                printf("ERROR: Slice requires [XY/XZ/YZ] [position], and a maximum of 20 slices can be set\n");
+                exit(1);
+            }
+            slice_plane[Nslices] = argv[counter+1];
+            slice_pos[Nslices]   = atoi(argv[counter+2]);
+            if (strcmp(slice_plane[Nslices], "XY") != 0 && strcmp(slice_plane[Nslices], "XZ") != 0 && strcmp(slice_plane[Nslices], "YZ") != 0)
+            {
+                printf("ERROR: Slice plane can only be XY, XZ or YZ\n");
+                exit(1);
+            }
+            Nslices++;
+            counter += 2;
+        }
+        else if (strcmp(argv[counter], "Threads") == 0)
+        {
+            Nthreads        = atoi(argv[counter+1]);
+            counter++;
+        }
         else if (strcmp(argv[counter], "Write_data") == 0)
         {
             if (strcmp(argv[counter+1], "On") == 0) write_data = true;
@@ -203,7 +230,7 @@ int main(int argc, char *argv[])
             printf("Please use ONLY:\n");
             printf("\tReference [text]\tResults_Reference [text]\tModel [text]\tTissue_order  [1D/2D/3D/geo]\t Tissue_model [basic, ...]\tModel_type [native/integrated]\n");
             printf("\tVarianble [Vm/Cai/CaSR]\tstart_time [int]\tend_time [int]\tinterval [n ms]\n");
-            printf("\tWrite_vtk [On/Off]\tWrite_data [On/Off]");
+            printf("\tWrite_vtk [On/Off]\tWrite_data [On/Off]\tSlice [XY/XZ/YZ] [position] (repeatable)\tThreads [n]\n");
             exit(1);
         }
         counter++;
@@ -220,7 +247,6 @@ int main(int argc, char *argv[])
     char * directory    = (char*)malloc(500);
     char * results_dir  = (char*)malloc(500);
     char * sr_dir       = (char*)malloc(500);
-    char * filename_out = (char*)malloc(500);
 
     if (strcmp(model_type, "native") == 0) 
     {
@@ -242,63 +268,117 @@ int main(int argc, char *argv[])
     else sprintf(results_dir, "Results");
     sprintf(sr_dir, "Spatial_%s", results_dir);
 
-    Cell_parameters                 Params_global;
-    Tissue_parameters               Tissue;
-    double                          *V;            // Whichever variable is to be written
+    SC_variables                    SC;
+
+    // Geometry: read the sidecar written by the simulator if present; otherwise re-create from the tissue settings
+    bool sidecar = read_geometry_sidecar(directory, sr_dir, &SC);   // lib/Outputs.cpp
+    if (sidecar == false)
+    {
+        Cell_parameters                 Params_global;
+        Tissue_parameters               Tissue;
+
+        set_model_conditions(&Params_global, Argin);
+        set_tissue_model_conditions(&Tissue, Argin);    // lib/Tissue.cpp
+        if (strcmp(Tissue.Tissue_order, "geo") == 0) set_tissue_settings_anatomical(Params_global, &Tissue);
+        else set_tissue_settings_idealised(Params_global, &Tissue);
+
+        printf("\nNo geometry sidecar found; geometry set from tissue settings:\n");
+        printf("\tTissue order: %s; Tissue model: %s ", Tissue.Tissue_order, Tissue.Tissue_model);
+        if (strcmp(Tissue.Tissue_order, "geo") == 0) printf("and tissue geometry file is: %s\n", Tissue.geo_file);
+        else printf("\n");
 
-    set_model_conditions(&Params_global, Argin);
-    set_tissue_model_conditions(&Tissue, Argin);    // lib/Tissue.cpp
-    if (strcmp(Tissue.Tissue_order, "geo") == 0) set_tissue_settings_anatomical(Params_global, &Tissue);
-    else set_tissue_settings_idealised(Params_global, &Tissue);
+        // Allocate arrays || lib/Spatial_coupling.cpp
+        SC_set_array_sizes(&SC, Tissue.NX, Tissue.NY, Tissue.NZ);   // Sets array sizes in SC struct from tissue settings
+        SC_array_allocation_N3(&SC, SC.NX, SC.NY, SC.NZ);           // Allocates arrays of size NX*NY*NZ || geo and 3D->1D geo index
+        printf(">Spatial coupling NX*NY*NZ arrays allocated\n");
+        select_tissue_geometry_function(Tissue, &SC, PATH, directory);  // lib/Tissue.cpp
+
+        // 3D -> 1D index (used by slice outputs)
+        int count = 0;
+        for (int idx = 0; idx < SC.NX*SC.NY*SC.NZ; idx++) if (SC.geo[idx] > 0) SC.geo_index[idx] = count++;
+    }
+    else printf("\nGeometry read from sidecar %s/%s/Geometry_sidecar.bin\n", directory, sr_dir);
 
     printf("\nbinary data to vtk being written for the following settings:\n");
-    printf("\tTissue order: %s; Tissue model: %s ", Tissue.Tissue_order, Tissue.Tissue_model);
-    if (strcmp(Tissue.Tissue_order, "geo") == 0) printf("and tissue geometry file is: %s\n", Tissue.geo_file);
-    else printf("\n");
+    printf("\tGeometry size (X*Y*Z, %d * %d * %d) || Ncells = %d\n", SC.NX, SC.NY, SC.NZ, SC.N);
     printf("\tstart time: %d\n\tend time: %d\n\tinterval: %d\n", start_time, end_time, interval);
     printf("\tOutputs directory: %s\n\tSpatial results directory: %s\n", directory, sr_dir);
     printf("\tWriting for variable: %s ", variable);
     if (write_vtk == true) printf("\tWriting to vtk");
     if (write_data == true) printf("\tWriting to text data file");
-    printf("\n\n\n");
+    for (int i = 0; i < Nslices; i++) printf("\tWriting %s slice at %d", slice_plane[i], slice_pos[i]);
+    printf("\n\tThreads: %d\n\n\n", Nthreads);
 
-    SC_variables                    SC;
-    // Allocate arrays || lib/Spatial_coupling.cpp
-    SC_set_array_sizes(&SC, Tissue.NX, Tissue.NY, Tissue.NZ);   // Sets array sizes in SC struct from tissue settings
-    SC_array_allocation_N3(&SC, SC.NX, SC.NY, SC.NZ);           // Allocates arrays of size NX*NY*NZ || geo and 3D->1D geo index
-    printf(">Spatial coupling NX*NY*NZ arrays allocated\n");
-    select_tissue_geometry_function(Tissue, &SC, PATH, directory);  // lib/Tissue.cpp
-    printf("\tGeometry size (X*Y*Z, %d * %d * %d) || Ncells = %d\n\n", Tissue.NX, SC.NY, SC.NZ, SC.N);
-
-    // Allocate variable
-    V = new double [SC.N];
+    for (int i = 0; i < Nslices; i++)
+    {
+        int Nmax = (strcmp(slice_plane[i], "XY") == 0) ? SC.NZ : (strcmp(slice_plane[i], "XZ") == 0) ? SC.NY : SC.NX;
+        if (slice_pos[i] < 0 || slice_pos[i] >= Nmax)
+        {
+            printf("ERROR: %s slice position %d is outside of the geometry (0 - %d)\n", slice_plane[i], slice_pos[i], Nmax-1);
+            exit(1);
+        }
+    }
 
-    int iteration;
+    // Frames are independent; each thread streams one frame at a time through its own buffer,
+    // so memory is bounded by Nthreads frames regardless of the time range
+    int Nframes = (interval > 0 && end_time >= start_time) ? (end_time - start_time)/interval + 1 : 0;
 
-    for (iteration = start_time; iteration <= end_time; iteration += interval)
+    // Check every frame exists before the parallel region, so a missing file exits cleanly from the main thread
+    for (int f = 0; f < Nframes; f++)
     {
-        // Read in binary data || lib/Outputs.cpp
-        array_1D_binary_read(variable, directory, sr_dir, V, SC, iteration);
-
-        // Output as vtk
-        if (write_vtk == true) 
+        char filename_in[1000];
+        sprintf(filename_in, "%s/%s/%s_output_%04d.bin", directory, sr_dir, variable, start_time + f*interval);
+        FILE *in = fopen(filename_in, "r");
+        if (in == NULL)
         {
-            sprintf(filename_out, "%s/%s/%s_output_%04d.vtk", directory, sr_dir, variable, iteration);
-            printf("Creating visualisation file %s\n", filename_out);
-            vtk_3D_output(variable, directory, sr_dir, V, SC, iteration);
+            printf("Cannot load data file %s; are the directories correct? Does the file exist?\n", filename_in);
+            exit(1);
         }
+        fclose(in);
+    }
 
-        // Output as data
-        if (write_data == true) 
+    omp_set_num_threads(Nthreads);
+#pragma omp parallel default(none) shared(SC, Nframes, start_time, interval, variable, directory, sr_dir, write_vtk, write_data, Nslices, slice_plane, slice_pos)
+    {
+        double *V = new double [SC.N];  // Whichever variable is to be written
+        char filename_out[1000];
+
+#pragma omp for schedule(dynamic)
+        for (int f = 0; f < Nframes; f++)
         {
-            sprintf(filename_out, "%s/%s/%s_output_%04d.dat", directory, sr_dir, variable, iteration);
-            printf("Creating visualisation file %s\n", filename_out);
-            data_3D_output(variable, directory, sr_dir, V, SC, iteration);
+            int iteration = start_time + f*interval;
+
+            // Read in binary data || lib/Outputs.cpp
+            array_1D_binary_read(variable, directory, sr_dir, V, SC, iteration);
+
+            // Output as vtk
+            if (write_vtk == true) 
+            {
+                sprintf(filename_out, "%s/%s/%s_output_%04d.vtk", directory, sr_dir, variable, iteration);
+                printf("Creating visualisation file %s\n", filename_out);
+                vtk_3D_output(variable, directory, sr_dir, V, SC, iteration);
+            }
+
+            // Output as data
+            if (write_data == true) 
+            {
+                sprintf(filename_out, "%s/%s/%s_output_%04d.dat", directory, sr_dir, variable, iteration);
+                printf("Creating visualisation file %s\n", filename_out);
+                data_3D_output(variable, directory, sr_dir, V, SC, iteration);
+            }
+
+            // Slices || lib/Outputs.cpp
+            for (int i = 0; i < Nslices; i++)
+            {
+                if      (strcmp(slice_plane[i], "XY") == 0) data_2D_XYslice_output(variable, directory, sr_dir, V, SC, iteration, slice_pos[i], 1);
+                else if (strcmp(slice_plane[i], "XZ") == 0) data_2D_XZslice_output(variable, directory, sr_dir, V, SC, iteration, slice_pos[i], 1);
+                else                                        data_2D_YZslice_output(variable, directory, sr_dir, V, SC, iteration, slice_pos[i], 1);
+            }
         }
+        delete [] V;
     }
 
     // delete
-    delete [] V;
     delete [] SC.geo;
     delete [] SC.geo_index;
     free(directory);
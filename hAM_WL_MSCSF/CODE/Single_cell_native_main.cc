@@ -78,6 +78,8 @@
 #include "lib/Model.h"
 #include "lib/Read_write_state.h"
 #include "lib/Outputs.h"
+#include "lib/Batch.h"
+#include "lib/Restitution.h"
 
 using namespace std;
 
@@ -116,12 +118,13 @@ int main(int argc, char *argv[])
     call_argument_functions(argc, argv, &Argin, "Single_cell_native"); // Reads settings file and calls set args
 	// End Argument handling ============================//|
 
-	// Set and assign simulation settings ===============\\|
-	// Assigns Sim.{BCL, reference, Beats, Total_time, read/write_state, dt, ..} from Argin struct
+	// Set and assign simulation settings and parameters \\|
+	// Assigns Sim.{BCL, reference, Beats, Total_time, read/write_state, dt, ..} from Argin struct, then sets the model
+	// conditions, checks the model, and sets the full parameter set with modification, heterogeneity and modulation
 	Simulation_parameters Sim;									// Initialise sim parameters struct || lib/Structs.h
-	set_simulation_defaults(&Sim, 0.02);						// (sim struct, dt)					|| lib/Initialisation.c
-	set_simulation_settings(&Sim, Argin, "native");				// Set from arguments				|| lib/Initialisation.c
-	// End set and assign settings ======================//|
+	Cell_parameters Params;										// Parameters/constants				|| lib/Structs.h
+	set_single_cell_native(&Argin, &Sim, &Params);				// As all batch modes				|| lib/Batch.cpp
+	// End set and assign settings and parameters =======//|
 
 	// Output files =====================================\\|
 	// Create folders by default or references passed in
@@ -145,6 +148,22 @@ int main(int argc, char *argv[])
 	sprintf(mkdirectory, "mkdir -p %s", params_dir);
 	system(mkdirectory);
 	
+	// Batch, population-of-models and restitution modes || all jobs/members/intervals are run in this process; results to one table
+	if (Argin.Batch_file_arg == true || Argin.Population_arg == true || Argin.S2_range_arg == true || Argin.Dynamic_BCLs_arg == true)
+	{
+		if (strcmp(Sim.Vclamp, "On") == 0)
+		{
+			printf("ERROR: Vclamp cannot be combined with Batch_file, Population, S2_range or Dynamic_BCLs\n");
+			exit(1);
+		}
+		if (Argin.Dynamic_BCLs_arg == true) run_dynamic_restitution(&Argin, PATH, directory, res_dir_full); // lib/Restitution.cpp
+		else if (Argin.S2_range_arg == true) run_S1S2_restitution(&Argin, PATH, directory, res_dir_full); // lib/Restitution.cpp
+		else if (Argin.Population_arg == true) run_population_of_models(&Argin, PATH, res_dir_full); // lib/Batch.cpp
+		else run_single_cell_batch(&Argin, PATH, res_dir_full); // lib/Batch.cpp
+		free(directory); free(results_dir); free(res_dir_full); free(params_dir); free(mkdirectory); free(mkfile);
+		return 0;
+	}
+
 	// Now create actual output files
 	printf(">Creating output files...\n");
 
@@ -167,79 +186,12 @@ int main(int argc, char *argv[])
 	int			outcount				= 0; 	// Output number reference
 
 	// All below defined in lib/Structs.h
-	Cell_parameters					Params;		// Parameters/constants	
 	State_variables					State;		// Time-dependent state variables
 	Model_variables					Variables;	// Calculated variables
 	double 							Vm;			// Global copy of voltage
 	printf(">Variables and structs declared\n");
 	// End Initialise simulation structs and variables ==//|
 
-	// Set model condition parameters from arguments | lib/Initialisation.c
-	// Sets Params.{Model, modulation(ISO,remodelling, mutation etc), model group} to defaults
-	// then overwrites with Argin values, if arguments have been passed 
-	set_model_conditions(&Params, Argin);
-
-	// Currently only sets human atrial flag to true if a human atrial model is set 
-    set_model_group_variables(&Params, Argin); // lib/Initialisation.c 
-
-	// Check Model is appropriate for this code version =\\|
-	// Add your new model clause here so it doesn't return an error
-	if      (strcmp(Params.Model, "minimal") == 0);			// hybrid minimal model; Colman 2019
-	else if (strcmp(Params.Model, "hAM_GB") == 0);			// human atrial cell; Grandi et al 2011 Circ Res 2011; 109(9):1055-66
-	else if (strcmp(Params.Model, "hAM_CRN") == 0);			// human atrial cell; Courtemanche et al 1998 Am J Physiol 1998; 275(1 Pt 2):H301-21.
-	else if (strcmp(Params.Model, "hAM_NG") == 0);			// human atrial cell; Nygren et al 1998 Circ Res 1998;82(1):63-81
-	else if (strcmp(Params.Model, "hAM_MT") == 0);			// human atrial cell; Maleckar et al 2009  Am. J. Physiol Heart Circ Physiol 2009;297(4):H1398-410
-	else if (strcmp(Params.Model, "hAM_WL_CRN") == 0);		// human atrial cell; Colman et al 2018 Front Physiol 9:1211; CRN Ca2+ handling
-	else if (strcmp(Params.Model, "hAM_WL_GB") == 0);		// human atrial cell; Colman et al 2018 Front Physiol 9:1211; GB Ca2+ handling
-	else if (strcmp(Params.Model, "hAM_GB_mWL") == 0);		// human atrial cell; Colman et al 2018 Front Physiol 9:1211; GB modified
-	else if (strcmp(Params.Model, "hAM_CRN_mWL") == 0);		// human atrial cell; Colman et al 2018 Front Physiol 9:1211; CRN modified
-	else if (strcmp(Params.Model, "hAM_NG_mWL") == 0);		// human atrial cell; Colman et al 2018 Front Physiol 9:1211; NG modified
-	else if (strcmp(Params.Model, "dAM_VA") == 0);			// dog atrial cell; Varela et al 2016 PLOS Computational Biology 12(12): e1005245
-	else if (strcmp(Params.Model, "hAM_GB_modded") == 0);	// human atrial cell; Grandi et al 2011 Circ Res 2011; 109(9):1055-66 MODDED
-	else
-	{
-		printf("ERROR: \"%s\" is not a valid Model selection for this code version\n", Params.Model);
-		exit(1);
-	}
-	// End appropriate check ============================//|
-
-	// Set parameters (defaults and model specific) =====\\|
-	// Set default parameters (constants etc); can be overwritten by model-specific later
-	set_default_parameters(&Params);				// lib/Initialisation.c
-	printf(">Default parameters set\n");
-
-	// Set model specific full parameters
-	Params.dt = Sim.dt; 	// Set before "set_params" called, which may explicitly set dt, for checking if dt has changed
-	set_parameters_native(&Params, Params.Model);	// lib/Model.c and dependants (may set dt for model-specific)
-
-	// Set model condition params from arguments where passed; only for those which are set in set_parameters_native() to overwrite with argument value
-	if (Argin.Celltype_arg 	== true)	Params.Celltype 	= Argin.Celltype; 
-	if (Argin.ISO_model_arg == true)	Params.ISO_model 	= Argin.ISO_model; 
-	if (Argin.ACh_model_arg == true)    Params.ACh_model    = Argin.ACh_model; 
-	if (Argin.Ihyp_arg      == true)   	Params.AIhyp        = Argin.AIhyp;
-
-	// Update Sim.dt if Params.dt has been explicitly set in "set_parameters" (thus Sim.dt != Params.dt), and dt has NOT been passed as a command-line argument.
-	if (Argin.dt_arg    	== false && Params.dt != Sim.dt) 	Sim.dt = Params.dt;
-	printf(">Model and version specific parameters set\n");
-	// End set parameters (defaults and model specific) =//|
-
-	// Set current modification =========================\\|
-	// Default modifiers || sets all scale factors to 1 and shifts to 0 so they can be multiplicatively applied by various modifications
-	set_modification_defaults_native(&Params);		// lib/Initialisation.c
-
-	// lib/Initialisation.c || sets the mod variables (Gx, x_shift/tau_scale etc) from arguments 
-	assign_modification_from_arguments(&Params, Argin);
-	
-	// lib/Model.c  -> lib/Model_X.cp; calls functions which set modification variables for het and modulation
-	// Updates the modifier variables (scales, shifts etc) using the defined settings for any/all het and modulation
-	set_heterogeneity_and_modulation_native(&Params);
-
-	// set expression scale by open rate scale, as both are equivilent in native models
-	Params.GCaL *= Params.GLTCC_kva1_va2;
-	Params.Grel	*= Params.GRyR_kCO;
-	printf(">Heterogeneity and modulation parameters set\n");
-	// end set current modification =====================\\| 
-
 	// Initialise stimulus ==============================\\|
 	stimulus_setup(Params, &Variables, Sim.dt, Sim.BCL, Sim.S2_CL, Sim.Paced_time); // lib/Model.c
 	printf(">Stimulus settings set\n");
@@ -282,52 +234,39 @@ int main(int argc, char *argv[])
 	// Read state from file  || this must be after Vclamp as that resets ICs for each step
 	if (strcmp(Sim.Read_state, "On") == 0)
 	{
-		Read_state_single_cell_native(&State, Params, Sim.BCL, PATH, Params.Model, Sim.state_reference_read); //lib/Read_write_state.c
+		if (strcmp(Sim.State_library, "On") == 0) Read_state_library(&State, Params, Sim.BCL, PATH, Params.Model, "single_cell", 0, Sim.state_reference_read, strcmp(Sim.State_library_BCL, "nearest") == 0); //lib/Read_write_state.c
+		else Read_state_single_cell_native(&State, Params, Sim.BCL, PATH, Params.Model, Sim.state_reference_read); //lib/Read_write_state.c
 		printf("Initial conditions / state read in from file\n");
 		Vm = State.Vm; // set global voltage to state again
 	}
 	// End Initial conditions and model function outs ===========================================//|
 
-	// Time loop ================================================================================\\|
-	printf("Time loop started:\nTime = %.0fms\n",sim_time);
-	for (sim_time = 0.0; sim_time <= (float)Sim.Total_time; sim_time += Sim.dt)
-	{
-		// Compute stimulus current || lib/Model.c || sets Istims to 0 or stimmag dependant on time
-		compute_Istim(Params, &Variables, Sim.Paced_time, Sim.S2_time, sim_time, iteration_counter);
-
-		// Solve the model || lib/Model.c -> lib/Model_X.cpp
-		// This sets and updates all gates, and calculates Itot
-		compute_model_native(Params, &Variables, &State, Vm, Sim.dt);
-
-		// Update Voltage
-		State.Vm	= State.Vm + Sim.dt*(-(Variables.Itot + Variables.Istim + Variables.Istim_S2));
-
-		// Excitation state and measurements | lib/Model.c  | "State.Vm" is voltage at t, "Vm" is voltage at t-dt
-		determine_excitation_state(&Variables, Vm, sim_time);							
-		calculate_measurement_properties(&Variables, Vm, State.Vm, sim_time, Sim.dt, -70, State.Cai, State.CanSR); // -70 is APD V threshold	
-
-		// Assign global voltage to state voltage (now both = V at t)
-		Vm			= State.Vm;
+	// Steady-state monitor || pacing stops at the end of the beat in which convergence is detected
+	Steady_state_monitor Steady;
+	bool steady_state_on	= (strcmp(Sim.Steady_state, "On") == 0);
+	int  BCL_int			= Sim.BCL * (int)(1/Sim.dt);
 
-		// Output data to files
-		if (iteration_counter%(int)(1/Sim.dt) == 0) // if sim_time is an integer (i.e. per ms)
-		{
-			output_currents(out_cu, sim_time, Variables, State, Vm);		// lib/Outputs.cpp || V, currents, gating variables, concs etc
-			output_excitation_properties(out_ex, sim_time, Variables, Vm);	// lib/Outputs.cpp || APD, excitation state, dv/dt etc
-		}
-
-		iteration_counter ++; // number of steps in dt
-		if (iteration_counter%(2000*((int)(1/Sim.dt))) == 0) printf("Time = %.0fms\n",sim_time); // output every 2000 ms
-	}
-	// End Time loop ============================================================================//|
+	// Time loop || lib/Batch.cpp; stimulus, model, voltage update, measurements and per-ms outputs
+	printf("Time loop started:\nTime = %.0fms\n",sim_time);
+	iteration_counter = single_cell_time_loop(&Sim, &Params, &State, &Variables, &Vm, &Steady, &out_cu, &out_ex, &sim_time);
 
 	// Print final time in simulation land
 	printf("Final Time = %.0fms\n\n",sim_time);
 
+	// Record number of beats actually paced
+	if (steady_state_on == true)
+	{
+		char * ss_reference 	= (char*)malloc(500);
+		sprintf(ss_reference, "%s/Steady_state_log.dat", directory);
+		output_steady_state_log(ss_reference, Steady, Sim, (Steady.converged == true) ? iteration_counter/BCL_int : Sim.NBeats); 	// lib/Outputs.cpp
+		free(ss_reference);
+	}
+
 	// Write state 
 	if (strcmp(Sim.Write_state, "On") == 0)
 	{
-		Write_state_single_cell_native(State, Params, Sim.BCL, PATH, Params.Model, Sim.state_reference_write); //lib/Read_write_state.c
+		if (strcmp(Sim.State_library, "On") == 0) Write_state_library(State, Params, Sim.BCL, PATH, Params.Model, "single_cell", 0, Sim.state_reference_write); //lib/Read_write_state.c
+		else Write_state_single_cell_native(State, Params, Sim.BCL, PATH, Params.Model, Sim.state_reference_write); //lib/Read_write_state.c
 		printf("State written to file\n");
 	}
 	// End Write state
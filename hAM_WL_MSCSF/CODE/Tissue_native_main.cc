@@ -67,11 +67,14 @@
 
 #include <fstream>
 #include <sstream>
+#include <vector>
 #include <stdlib.h>
 #include <stdio.h>
 #include <cstring>
 #include <time.h>
 #include <omp.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "lib/Arguments.h"
 #include "lib/Initialisation.h"
@@ -81,6 +84,7 @@
 #include "lib/Outputs.h"
 #include "lib/Spatial_coupling.h"
 #include "lib/Tissue.h"
+#include "lib/Tissue_protocols.h"
 
 using namespace std;
 
@@ -146,36 +150,66 @@ int main(int argc, char *argv[])
 	sprintf(sr_dir, "Spatial_%s", results_dir);
 	sprintf(mkdirectory, "mkdir -p %s/%s", directory, sr_dir);
 	system(mkdirectory);
+
+	// Batched independent 1D strands || each with its own S2 and conditions from a line of the strand file
+	Strand_batch Strands;
+	Strands.N = 0;
+	if (Argin.Strand_file_arg == true) strand_batch_setup(&Strands, &Argin, &Sim, directory);	// lib/Tissue_protocols.cpp
 	
+	// Restart from checkpoint || text outputs are continued from their length at the checkpoint
+	Checkpoint_parameters Checkpoint;
+	char checkpoint_files[10][500];		// appended output files tracked by checkpoints
+	bool restart = (strcmp(Sim.Restart, "On") == 0);
+	if (restart == true && Read_checkpoint_tissue_header(res_dir_full, &Checkpoint) == false) // lib/Read_write_state.c
+	{
+		printf("ERROR: Restart is On but there is no checkpoint in %s\n", res_dir_full);
+		exit(1);
+	}
+	ios_base::openmode out_mode = (restart == true) ? ios::app : ios::out;
+
 	// Now create actual output files
 	printf(">Creating output files...\n");
 
 	sprintf(mkfile, "%s/%s/Currents_cell1.dat", directory, results_dir);
-	ofstream out_cu(mkfile);    // Contains all current related outputs
+	sprintf(checkpoint_files[0], "%s", mkfile);
+	if (restart == true) Truncate_checkpoint_output(mkfile, Checkpoint.file_length[0]); // lib/Read_write_state.c
+	ofstream out_cu(mkfile, out_mode);    // Contains all current related outputs
 	printf("\t %s\n", mkfile);
 
 	sprintf(mkfile, "%s/%s/Properties_cell1.dat", directory, results_dir);
-	ofstream out_ex(mkfile); 	 // Contains all AP properties related outputs
+	sprintf(checkpoint_files[1], "%s", mkfile);
+	if (restart == true) Truncate_checkpoint_output(mkfile, Checkpoint.file_length[1]); // lib/Read_write_state.c
+	ofstream out_ex(mkfile, out_mode); 	 // Contains all AP properties related outputs
 	printf("\t %s\n", mkfile);
 
 	sprintf(mkfile, "%s/%s/Currents_cell2.dat", directory, results_dir);
-	ofstream out_cu2(mkfile);    // Contains all current related outputs
+	sprintf(checkpoint_files[2], "%s", mkfile);
+	if (restart == true) Truncate_checkpoint_output(mkfile, Checkpoint.file_length[2]); // lib/Read_write_state.c
+	ofstream out_cu2(mkfile, out_mode);    // Contains all current related outputs
 	printf("\t %s\n", mkfile);
 
 	sprintf(mkfile, "%s/%s/Properties_cell2.dat", directory, results_dir);
-	ofstream out_ex2(mkfile);     // Contains all AP properties related outputs
+	sprintf(checkpoint_files[3], "%s", mkfile);
+	if (restart == true) Truncate_checkpoint_output(mkfile, Checkpoint.file_length[3]); // lib/Read_write_state.c
+	ofstream out_ex2(mkfile, out_mode);     // Contains all AP properties related outputs
 	printf("\t %s\n", mkfile);
 
 	sprintf(mkfile, "%s/%s/Currents_cell3.dat", directory, results_dir);
-	ofstream out_cu3(mkfile);    // Contains all current related outputs
+	sprintf(checkpoint_files[4], "%s", mkfile);
+	if (restart == true) Truncate_checkpoint_output(mkfile, Checkpoint.file_length[4]); // lib/Read_write_state.c
+	ofstream out_cu3(mkfile, out_mode);    // Contains all current related outputs
 	printf("\t %s\n", mkfile);
 
 	sprintf(mkfile, "%s/%s/Properties_cell3.dat", directory, results_dir);
-	ofstream out_ex3(mkfile);     // Contains all AP properties related outputs
+	sprintf(checkpoint_files[5], "%s", mkfile);
+	if (restart == true) Truncate_checkpoint_output(mkfile, Checkpoint.file_length[5]); // lib/Read_write_state.c
+	ofstream out_ex3(mkfile, out_mode);     // Contains all AP properties related outputs
 	printf("\t %s\n", mkfile);
 
 	sprintf(mkfile, "%s/%s/Vm_linescan_x.dat", directory, results_dir);
-	ofstream out_ls(mkfile);     // Contains linescan of Vm
+	sprintf(checkpoint_files[6], "%s", mkfile);
+	if (restart == true) Truncate_checkpoint_output(mkfile, Checkpoint.file_length[6]); // lib/Read_write_state.c
+	ofstream out_ls(mkfile, out_mode);     // Contains linescan of Vm
 	printf("\t %s\n", mkfile);
 
 	printf("\n");
@@ -196,6 +230,7 @@ int main(int argc, char *argv[])
 	Model_variables					*Variables;		// Calculated variables
 	SC_variables					SC;				// Spatial coupling (neighbour maps, D arrays, coupling functions)
 	Tissue_parameters				Tissue;			// Tissue settings (tissue model and dimension, array sizes, diffusion params, anisotropy etc)
+	Probe_parameters				Probes;			// Probe recorder (virtual electrodes; arbitrary nodes and variables)
 	double 							*Vm;			// Global copy of voltage
 	printf(">Variables and structs declared\n");
 	// End Initialise simulation structs and variables ==//|
@@ -248,6 +283,9 @@ int main(int argc, char *argv[])
 	// Set to arguments if expliticlty passed to overwite defaults (inc model specifc) || assuming you'd only pass an argument if you want it to be used!
 	overwrite_tissue_properties_from_args(Params_global, &Tissue, Argin); // lib/Tissue.cpp
 
+	// Strands are the rows of the domain
+	if (Strands.N > 0) strand_batch_tissue(&Strands, &Tissue);	// lib/Tissue_protocols.cpp
+
 	// set CV cell indexes -> location of cells for conduction velocity calculation, if CV tissue model is selected
 	if (strcmp(Tissue.Tissue_model, "conduction_velocity") == 0) set_CV_cells(Params_global, &Tissue);  // lib/Tissue.cpp
 
@@ -258,15 +296,33 @@ int main(int argc, char *argv[])
 	// Allocate arrays || lib/Spatial_coupling.cpp
 	// Tissue.NX set by tissue model; passed into Spatial Coupling now finalised
 	SC_set_array_sizes(&SC, Tissue.NX, Tissue.NY, Tissue.NZ); 	// Sets array sizes in SC struct from tissue settings
+	if (Argin.Input_binary_write_arg == true && strcmp(Argin.Input_binary_write, "On") == 0) SC.input_binary_write = true; // binary copies of input files
 	SC_array_allocation_N3(&SC, SC.NX, SC.NY, SC.NZ); 			// Allocates arrays of size NX*NY*NZ || geo and 3D->1D geo index
 	printf(">Spatial coupling NX*NY*NZ arrays allocated\n");
 
-	// Read/Create geometry and calculate Ncell
-	select_tissue_geometry_function(Tissue, &SC, PATH, directory); 	// lib/Tissue.cpp 
-	printf("\tGeometry size (X*Y*Z, %d * %d * %d) || Ncells = %d\n\n", SC.NX, SC.NY, SC.NZ, SC.N);
+	// Preprocessed tissue cache || geometry, neighbours, orientation, D and laplacian arrays from a previous run with identical settings/files
+	bool tissue_cache_read = false;
+	unsigned long long tissue_cache_hash = 0;
+	char tissue_cache_file[1000];
+	if (strcmp(Tissue.Tissue_cache, "On") == 0)
+	{
+		char tissue_cache_mkdir[1000];
+		sprintf(tissue_cache_mkdir, "mkdir -p %s", Tissue.Tissue_cache_dir);
+		system(tissue_cache_mkdir);
+		tissue_cache_hash = tissue_cache_key(Tissue, PATH);		// lib/Tissue.cpp
+		sprintf(tissue_cache_file, "%s/Tissue_cache_%016llx.bin", Tissue.Tissue_cache_dir, tissue_cache_hash);
+		tissue_cache_read = read_tissue_cache(&SC, tissue_cache_file, tissue_cache_hash); // lib/Tissue.cpp || allocates Ncell arrays if read
+	}
+
+	if (tissue_cache_read == false)
+	{
+		// Read/Create geometry and calculate Ncell
+		select_tissue_geometry_function(Tissue, &SC, PATH, directory); 	// lib/Tissue.cpp 
 
-	// Allocate arrays size Ncell
-	SC_array_allocation_Ncell(&SC, SC.N);		// lib/Spatial_coupling.cpp || geo_linear, D arrays, neighbour map, orientation, laplacian components
+		// Allocate arrays size Ncell
+		SC_array_allocation_Ncell(&SC, SC.N);		// lib/Spatial_coupling.cpp || geo_linear, D arrays, neighbour map, orientation, laplacian components
+	}
+	printf("\tGeometry size (X*Y*Z, %d * %d * %d) || Ncells = %d\n\n", SC.NX, SC.NY, SC.NZ, SC.N);
 	tissue_array_allocation(&Tissue, SC.N);		// lib/Tissue.cpp || stim/ISO/remodelling etc map arrays 
 	printf(">Spatial coupling Ncell arrays allocated\n");
 
@@ -278,9 +334,18 @@ int main(int argc, char *argv[])
 	printf(">Ncell struct arrays allocated\n");
 
 	// Cell index and neighbours (geo_index[3D_ref] returns 1D ref; geo_3D_index[1D_ref] returns 3D_ref; geo_linear[1D_ref] = geo[3D_ref]
-	SC_set_index_and_geo_linear(&SC);				// lib/Spatial_coupling.cpp
-	SC_set_neighbours(&SC);							// lib/Spatial_coupling.cpp
-	printf(">Linear index and neighbours set\n");
+	if (tissue_cache_read == false)
+	{
+		SC_set_index_and_geo_linear(&SC);				// lib/Spatial_coupling.cpp
+		SC_set_neighbours(&SC);							// lib/Spatial_coupling.cpp
+		printf(">Linear index and neighbours set\n");
+	}
+
+	// Resolve and check slice/ROI output sinks against the domain
+	set_output_sinks(&Sim, SC);						// lib/Outputs.cpp
+
+	// Compact geometry description for post-processing (bin_to_vtk_tissue)
+	output_geometry_sidecar(directory, sr_dir, SC);	// lib/Outputs.cpp
 
 	// Create stimulus area
 	// Check for multi site/timed stimulus setting; otherwise call regular function
@@ -295,24 +360,28 @@ int main(int argc, char *argv[])
 	cell2ref = int(float(SC.N/3)); // in idealised model, not likley to be x-edge (/2, 4 or 5 is)
 	cell3ref = SC.N - 5;
 
-	// setup diffusion coefficient arrays
-	set_D_dx_global(&SC, Tissue.dx, Tissue.dy, Tissue.dz, Tissue.D1, Tissue.D_AR);  // sets D and dx from tissue mdoel settings || lib/Spatial_coupling.cpp
+	// Diffusion setup (D, orientation and inspection vtks are skipped if read from the tissue cache)
+	if (tissue_cache_read == false)
+	{
+		// setup diffusion coefficient arrays
+		set_D_dx_global(&SC, Tissue.dx, Tissue.dy, Tissue.dz, Tissue.D1, Tissue.D_AR);  // sets D and dx from tissue mdoel settings || lib/Spatial_coupling.cpp
 
-	// Fibre orientation
-	set_orientation(&SC, Tissue, PATH, Tissue.Tissue_order);    // lib/Tissue.cpp || This sets orientation to 0, then sets/reads in IF set to anisotropic
-	if (strcmp(Tissue.Orientation_type, "anisotropic") == 0) output_fibre_orientation(SC, Tissue, directory); // lib/Tissue.cpp || outputs vtk file of orientation as used in sim
+		// Fibre orientation
+		set_orientation(&SC, Tissue, PATH, Tissue.Tissue_order);    // lib/Tissue.cpp || This sets orientation to 0, then sets/reads in IF set to anisotropic
+		if (strcmp(Tissue.Orientation_type, "anisotropic") == 0) output_fibre_orientation(SC, Tissue, directory); // lib/Tissue.cpp || outputs vtk file of orientation as used in sim
 
-	// Baseline, non-uniform Dscale (celltype or map; map for geo only)
-	// This is for regional or continuous/complex gradient in D1 and/or DAR (inherehent to tissue model)
-	if (strcmp(Tissue.D_uniformity, "uniform") != 0) update_D_arrays_Dscale_baseline(&SC, &Tissue,PATH, directory); // lib/Tissue.cpp
+		// Baseline, non-uniform Dscale (celltype or map; map for geo only)
+		// This is for regional or continuous/complex gradient in D1 and/or DAR (inherehent to tissue model)
+		if (strcmp(Tissue.D_uniformity, "uniform") != 0) update_D_arrays_Dscale_baseline(&SC, &Tissue,PATH, directory); // lib/Tissue.cpp
 
-	// Modification Dscale (homogeneous or map; ideal or geo) 
-	// This is for scaling D1 and/or DAR locally associated with modulation (e.g. remodelling)
-	update_D_arrays_Dscale_mod(&SC, &Tissue, PATH, directory); // lib/Tissue.cpp
+		// Modification Dscale (homogeneous or map; ideal or geo) 
+		// This is for scaling D1 and/or DAR locally associated with modulation (e.g. remodelling)
+		update_D_arrays_Dscale_mod(&SC, &Tissue, PATH, directory); // lib/Tissue.cpp
 
-    // now set the D components spatial array from D1 and D2 arrays and orientation
-    set_D_array_anisotropic(&SC);                       // lib/Spatial_coupling.cpp
-    output_D1_and_D2(SC, directory);                    // lib/Spatial_coupling.cpp || Outputs vtk for inspection
+		// now set the D components spatial array from D1 and D2 arrays and orientation
+		set_D_array_anisotropic(&SC);                       // lib/Spatial_coupling.cpp
+		output_D1_and_D2(SC, directory);                    // lib/Spatial_coupling.cpp || Outputs vtk for inspection
+	}
 
 	// Phase re-entry map
 	if (strcmp(Sim.Read_state, "phase") == 0) // needs to create phase map if reading phase ICs
@@ -327,13 +396,16 @@ int main(int argc, char *argv[])
     set_default_parameters(&Params_global);					// lib/Initialisation.c
 
 	// Set model condition parameters local defaults from global | lib/Initialisation.c
-	for (int n = 0; n < SC.N; n++) set_local_model_conditions(Params_global, &Params[n]); // Set Model, ISO, remodelling etc locally
+	if (Strands.N > 0) strand_batch_conditions(&Strands, Params_global);	// lib/Tissue_protocols.cpp || each strand's own conditions
+	#pragma omp parallel for
+	for (int n = 0; n < SC.N; n++) set_local_model_conditions((Strands.N > 0) ? Strands.conditions[SC.y_index[n]] : Params_global, &Params[n]); // Set Model, ISO, remodelling etc locally
 
 	// Update conditions locally for heterogeneous conditions (e.g. ISO/remodelling maps etc)
 	// ISO
 	if (strcmp(Tissue.ISO_map_on, "On") == 0)
 	{
 		create_or_read_map_double(&Tissue, SC, PATH, directory, Tissue.ISO_map, Tissue.ISO_map_file, "ISO"); // lib/Tissue.cpp
+		#pragma omp parallel for
 		for (int n = 0; n < SC.N; n++) Params[n].ISO *= Tissue.ISO_map[n]; // NOTE: multiplies global ISO value (which local is defaulted to) by local ISO SCALING
 		// i.e. if local map is 1, then Params.ISO = global ISO value; if local map is 0, then Params.ISO = 0
 		printf(">ISO map read and local ISO conc set\n");
@@ -342,6 +414,7 @@ int main(int argc, char *argv[])
 	if (strcmp(Tissue.remod_map_on, "On") == 0)
     {
         create_or_read_map_double(&Tissue, SC, PATH, directory, Tissue.remod_map, Tissue.remod_map_file, "remodelling"); // lib/Tissue.cpp
+        #pragma omp parallel for
         for (int n = 0; n < SC.N; n++) Params[n].Remodelling_prop *= Tissue.remod_map[n]; // Again, multiplies global value by local map value, thus scaling between 0 and global value
         printf(">Remodelling map read and local remodelling condition set\n");
     }
@@ -349,6 +422,7 @@ int main(int argc, char *argv[])
 	if (strcmp(Tissue.ACh_map_on, "On") == 0)
     {
         create_or_read_map_double(&Tissue, SC, PATH, directory, Tissue.ACh_map, Tissue.ACh_map_file, "ACh"); // lib/Tissue.cpp
+        #pragma omp parallel for
         for (int n = 0; n < SC.N; n++) Params[n].ACh *= Tissue.ACh_map[n]; // NOTE: multiplies global ACh value (which local is defaulted to) by local ACh SCALING
         printf(">ACh map read and local ACh conc set\n");
     }
@@ -381,78 +455,37 @@ int main(int argc, char *argv[])
     }
     // End Global and local settings from maps etc ======//|
 
-    // Loop of tissue for cell-by-cell setup ======================\\|
-    for (int n = 0; n < SC.N; n++)
+    // Parameter regions || nodes with identical local conditions share a parameter set, so full setup is once per region
+    int *region_node = new int[SC.N];
+    int *region_list = new int[SC.N];
+    int Nregions = set_parameter_regions(Tissue, SC, Params, region_node, region_list); // lib/Tissue.cpp
+    printf(">%d distinct parameter regions in %d cells\n", Nregions, SC.N);
+
+    if (strcmp(Tissue.Multiple_models, "On") == 0 && strcmp(Tissue.Tissue_type, "homogeneous") == 0)
     {
-        // Set parameters (defaults and model specific) =====\\|
-        // Default modifiers || sets all scale factors to 1 and shifts to 0 so they can be multiplicatively applied by various modifications
-        set_modification_defaults_native(&Params[n]);		// lib/Initialisation.c
+        printf("ERROR: Multiple Models cannot be run with homogeneous Tissue_type; heterogeneity must exist to assign regions to two Models!\n");
+        exit(1);
+    }
 
-		// Set default parameters (constants etc); can be overwritten by model-specific later
-        if (n == 0) printf(">Setting default parameters...\n");
-        set_default_parameters(&Params[n]);					// lib/Initialisation.c
-        if (n == SC.N -1) printf(">Default parameters set\n");
+    // Loop of tissue regions for cell-by-cell setup ==============\\|
+    printf(">Setting default parameters...\n");
+    double dt_set = Sim.dt;
+    #pragma omp parallel for schedule(dynamic) default(none) shared(SC, Params, Tissue, Argin, Strands, region_list, Nregions, dt_set)
+    for (int r = 0; r < Nregions; r++)
+    {
+        int n = region_list[r];
+        Argument_parameters &A = (Strands.N > 0) ? Strands.A[SC.y_index[n]] : Argin; // strand arguments, if batched
+        set_region_parameters_native(&Params[n], Tissue, SC, A, n, dt_set); // lib/Tissue.cpp || defaults, model, argument modification and heterogeneity
+    }
 
-        // Set model specific parameters
-        Params[n].dt = Sim.dt; 	// Set before "set_params" called, which may explicitly set dt, for checking if dt has changed
+    // Update Sim.dt if Params.dt has been explicitly set in "set_parameters" (thus Sim.dt != Params.dt), and dt has NOT been passed as a command-line argument.
+    for (int r = 0; r < Nregions; r++) if (Argin.dt_arg == false && Params[region_list[r]].dt != Sim.dt) Sim.dt = Params[region_list[r]].dt;
+    printf(">Model and version specific parameters set\n");
 
-		// Select local baseline model if multiple models is on
-        if (strcmp(Tissue.Multiple_models, "On") == 0) 
-        {
-            if (strcmp(Tissue.Tissue_type, "homogeneous") == 0)
-            {
-                printf("ERROR: Multiple Models cannot be run with homogeneous Tissue_type; heterogeneity must exist to assign regions to two Models!\n");
-                exit(1);
-            }
-			// For regions assigned "Model_2", set local Model to the entry held in "Tissue_model_2" (set in Tissue model settings or by argument)
-			// No need to do anything for regions assigned "Model_1" as this is what Params[n].Model already contains
-            if (strcmp(Tissue.Modeltype_number[SC.geo_linear[n]], "Model_2") == 0)  
-			{
-				Params[n].Model = Tissue.Tissue_model_2;
-			}
-        }
-		
-		set_model_group_variables(&Params[n], Argin); // Model dependent so needs to be called here (as Params[n].Model hmay have changed)
-
-        // Set default parameters (constants etc); can be overwritten by model-specific later
-        // Can be set now that local conditions (Model, ISO, Remodelling etc) have be set
-		set_parameters_native(&Params[n], Params[n].Model);							// lib/Model.c and dependants (may set dt for model-specific)
-
-		// Set model condition params from arguments where passed; only for those which are set in set_parameters_native() to overwrite with argument value
-        if (Argin.Celltype_arg 	== true)	Params[n].Celltype 	= Argin.Celltype; 	
-        if (Argin.ISO_model_arg == true)	Params[n].ISO_model	= Argin.ISO_model; 	
-        if (Argin.ACh_model_arg == true)    Params[n].ACh_model = Argin.ACh_model; 	
-
-        // Update Sim.dt if Params.dt has been explicitly set in "set_parameters" (thus Sim.dt != Params.dt), and dt has NOT been passed as a command-line argument.
-        if (Argin.dt_arg    	== false && Params[n].dt != Sim.dt) 	Sim.dt = Params[n].dt;
-        if (n == SC.N -1) printf(">Model and version specific parameters set\n");
-        // End set parameters (defaults and model specific) =//|
-
-        // Set current modification ==========================\\|
-        // lib/Initialisation.c || sets the mod variables (Gx, x_shift/tau_scale etc) from arguments
-        // These are the "DC" modulation variables, controlled by Tissue.Direct_modulation_map_on if set
-        // If map is off, then simply update modifiers with argument values for all tissue; if map is on, do it only within map region
-        if (strcmp(Tissue.Direct_modulation_map_on, "On") == 0) 
-        {
-            if (Tissue.Direct_modulation_map[n] > 0.0) assign_modification_from_arguments(&Params[n], Argin); // lib/Initialisation.c || assign only to map area
-        }
-        else assign_modification_from_arguments(&Params[n], Argin);	// lib/Initialisation.c || assign to all nodes
-
-		// Now set local celltype if heterogeneity is on (else all cells will be set to default or argument celltype)
-		// SC.geo_linear[n] = cellnumber at n; celltype_number[cellnumber] = string of celltype defined in Tissue model settings
-        if (strcmp(Tissue.Tissue_type, "heterogeneous") == 0) Params[n].Celltype = Tissue.celltype_number[SC.geo_linear[n]];
-
-		// Now call set heterogneiety and modulation (local celltype and modulation are already set by maps if relevant)
-		// lib/Model.c  -> lib/Model_X.cp; calls functions which set modification variables for het and modulation
-		// Updates the modifier variables (scales, shifts etc) using the defined settings for any/all het and modulation
-        set_heterogeneity_and_modulation_native(&Params[n]);	// lib/Model.c
-
-		// set expression scale by open rate scale, as both are equivilent in native models
-        Params[n].GCaL *= Params[n].GLTCC_kva1_va2; 			
-        Params[n].Grel *= Params[n].GRyR_kCO;   
-        if (n == SC.N -1) printf(">Heterogeneity and modulation parameters set\n");
-        // end set current modification ======================//| 
-    }
+    // Copy region parameters to all other nodes of the region
+    #pragma omp parallel for
+    for (int n = 0; n < SC.N; n++) if (region_node[n] != n) Params[n] = Params[region_node[n]];
+    printf(">Heterogeneity and modulation parameters set\n");
     // End loop of tissue for cell-by-cell setup ==================//|
 
     // Initialise stimulus ==============================\\|
@@ -465,6 +498,27 @@ int main(int argc, char *argv[])
 	// Again, the stimulus settings in Params[x] and Variables[x] do not correspond to those cells
     // Cells to apply stimulus is determined by stimulus map
     if (strcmp(Tissue.Multi_stim, "On") == 0) for (int n = 1; n < Tissue.Nstims; n++) stimulus_setup(Params[n], &Variables[n], Sim.dt, Sim.BCL, Sim.S2_CL, Sim.Paced_time); // lib/Model.c
+
+    // Strands: uncoupled rows, each with its own S2 area and timing
+    if (Strands.N > 0) strand_batch_stimulus(&Strands, &Tissue, &SC, Params[0], Sim); // lib/Tissue_protocols.cpp
+
+    // Stimulus sites || sparse node lists, so the stimulus is applied only to these nodes and only while on
+    // The S2 area is set for idealised tissue, and for anatomical (not multi-stim) with S1-S2 pacing
+    bool S2_area_set = (strcmp(Tissue.Multi_stim, "On") != 0 && (Sim.S2_CL != 0 || strcmp(Tissue.Tissue_order, "geo") != 0));
+    compile_stimulus_sites(&Tissue, SC.N, S2_area_set); // lib/Tissue.cpp
+
+    // Pacing protocol || timed stimulus trains on the sites replace S1/S2 pacing
+    Pacing_protocol Protocol;
+    Protocol.N = 0;
+    if (Argin.Protocol_file_arg == true)
+    {
+        if (Strands.N > 0 || Argin.Branch_file_arg == true || strcmp(Sim.Steady_state, "On") == 0 || (Argin.Vulnerability_window_arg == true && strcmp(Argin.Vulnerability_window, "On") == 0))
+        {
+            printf("ERROR: Protocol_file cannot be combined with Strand_file, Branch_file, Steady_state or Vulnerability_window\n");
+            exit(1);
+        }
+        pacing_protocol_setup(&Protocol, Argin.Protocol_file, Tissue, Params[0], &Sim, Argin.Total_time_arg, S2_area_set, directory); // lib/Tissue_protocols.cpp
+    }
     printf(">Stimulus settings set\n");
     // End initialise stimulus ==========================//|
 
@@ -474,6 +528,11 @@ int main(int argc, char *argv[])
     output_settings(Sim, res_dir_full, Argin.DC_current_mod_arg, Params_global, argc, argv);    // lib/Outputs.c
     output_settings_tissue(Sim, Tissue, res_dir_full);							                // lib/Outputs.c
 
+    // Probe recorder || nodes, variables and sample interval from arguments; binary output in results directory
+    sprintf(checkpoint_files[7], "%s/Probes.bin", res_dir_full);
+    probe_setup(&Probes, Argin, SC, Sim.dt, res_dir_full, (restart == true) ? Checkpoint.file_length[7] : -1);	// lib/Outputs.cpp
+    if (Probes.N > 0) printf(">Probe recorder set: %d probes x %d variables every %.3f ms\n\n", Probes.N, Probes.Nvar, Probes.interval);
+
     // Setup complete, simulation running ======\\|
     time_t rawtime;
     time (&rawtime);
@@ -484,11 +543,15 @@ int main(int argc, char *argv[])
     // End Setup complete, simulation running ==//|
 
     printf("Setting initial conditions....\n");	
+	// Set initial conditions of state variables (once per parameter region)
+	// Function in lib/Model.c calls specific functions in lib/Model_X.cpp
+    #pragma omp parallel for
+    for (int r = 0; r < Nregions; r++) initial_conditions_native(&State[region_list[r]], Params[region_list[r]], Params[region_list[r]].Model); 
+
+    #pragma omp parallel for
     for (int n = 0; n < SC.N; n++)
     {
-	 	// Set initial conditions of state variables
-	    // Function in lib/Model.c calls specific functions in lib/Model_X.cpp
-        initial_conditions_native(&State[n], Params[n], Params[n].Model); 
+        if (region_node[n] != n) State[n] = State[region_node[n]];
         Vm[n] = State[n].Vm;
 
 		// Initialise measurement variables and flags
@@ -496,29 +559,34 @@ int main(int argc, char *argv[])
     }
     printf("Initial conditions set\n");	
 
+    // Per-cell states (single_cell, ave, phase) from the indexed state library rather than individual text files
+    bool state_library          = (strcmp(Sim.State_library, "On") == 0);
+    bool state_library_nearest  = (strcmp(Sim.State_library_BCL, "nearest") == 0);
+
     // Read state from file, multiple different implementations
     // Reads whole tissue -> state file must have been written using same tissue model!!
     if (strcmp(Sim.Read_state, "On") == 0) 
     {
-        Read_state_tissue_native_whole_tissue(State, Params, Sim.BCL, PATH, Params_global.Model, SC.N, Tissue.Tissue_order, Tissue.Tissue_model, Tissue.Tissue_type, Tissue.Orientation_type, Sim.state_reference_read); //lib/Read_write_state.c
+        if (strcmp(Sim.State_format, "binary") == 0) Read_state_tissue_native_whole_tissue_binary(State, Params, Sim.BCL, PATH, Params_global.Model, SC.N, Tissue.Tissue_order, Tissue.Tissue_model, Tissue.Tissue_type, Tissue.Orientation_type, Sim.state_reference_read); //lib/Read_write_state.c
+        else Read_state_tissue_native_whole_tissue(State, Params, Sim.BCL, PATH, Params_global.Model, SC.N, Tissue.Tissue_order, Tissue.Tissue_model, Tissue.Tissue_type, Tissue.Orientation_type, Sim.state_reference_read); //lib/Read_write_state.c
         printf("Initial conditions / state read in from file - whole tissue\n");
     }
 	// Reads in file written by single cell model to all tissue (needs file for each celltype and condition present)
     else if (strcmp(Sim.Read_state, "single_cell") == 0)
     {
-        for (int n = 0; n < SC.N; n++) Read_state_single_cell_native(&State[n], Params[n], Sim.BCL, PATH, Params[n].Model, Sim.state_reference_read); //lib/Read_write_state.c
+        Read_state_tissue_native_cached(State, Params, SC.N, Sim.BCL, PATH, "single_cell", NULL, Sim.state_reference_read, state_library, state_library_nearest); //lib/Read_write_state.c || each distinct file read once
         printf("Initial conditions / state read in from file - single cell to whole tissue\n");
     }
 	// Reads state from just one coupled cell to whole tissue (same as single cell except written by coupled)
     else if (strcmp(Sim.Read_state, "ave") == 0) 
     {
-        for (int n = 0; n < SC.N; n++) Read_state_tissue_native_ave_tissue(&State[n], Params[n], Sim.BCL, PATH, Params[n].Model, Sim.state_reference_read);
+        Read_state_tissue_native_cached(State, Params, SC.N, Sim.BCL, PATH, "ave", NULL, Sim.state_reference_read, state_library, state_library_nearest); //lib/Read_write_state.c || each distinct file read once
         printf("Initial conditions / state read in from file - ave coupled cell to whole tissue\n");
     }
 	// Reads in single cell phase file into tissue for phase re-entry
     else if (strcmp(Sim.Read_state, "phase") == 0)
     {
-        for (int n = 0; n < SC.N; n++) Read_state_phase(&State[n], Params[n], Sim.BCL, PATH, Params[n].Model, Tissue.phasemap[n], Sim.state_reference_read); //lib/Read_write_state.c
+        Read_state_tissue_native_cached(State, Params, SC.N, Sim.BCL, PATH, "phase", Tissue.phasemap, Sim.state_reference_read, state_library, state_library_nearest); //lib/Read_write_state.c || each distinct file read once
         printf("Initial conditions / state read in from file - phase version\n");
         printf("NOTE:: As phase re-entry, have you set Beats = 0 (and Total_time = x) to ensure no applied stimuli??\n");
     }
@@ -533,25 +601,195 @@ int main(int argc, char *argv[])
     for (int n = 0; n < SC.N; n++) Vm[n] = State[n].Vm;
 
     // Calculate diffusion tensor differentials and laplacian =====\\|
-    printf("Calculating d differential and laplacian\n");
-    for (int n = 0; n < SC.N; n++)
+    if (tissue_cache_read == false)
     {
-        calc_dD_anisotropic_3D(&SC, n);	// lib/Spatial_coupling.cpp
-        calc_laplacian_and_BCs(&SC, n);	// lib/Spatial_coupling.cpp
+        printf("Calculating d differential and laplacian\n");
+        #pragma omp parallel for
+        for (int n = 0; n < SC.N; n++)
+        {
+            calc_dD_anisotropic_3D(&SC, n);	// lib/Spatial_coupling.cpp
+            calc_laplacian_and_BCs(&SC, n);	// lib/Spatial_coupling.cpp
+        }
+        if (strcmp(Tissue.Tissue_cache, "On") == 0) write_tissue_cache(&SC, tissue_cache_file, tissue_cache_hash); // lib/Tissue.cpp
     }
     // End Calculate diffusion tensor differentials and laplacian =//|
 
+    // Continue from checkpoint || state, variables (measurement and stimulus), Vm and loop counters
+    double sim_time_start = 0.0;
+    if (restart == true)
+    {
+        Read_checkpoint_tissue(res_dir_full, &Checkpoint, State, Variables, Vm, SC.N, Sim.dt); // lib/Read_write_state.c
+        sim_time_start      = Checkpoint.sim_time;
+        iteration_counter   = Checkpoint.iteration_counter;
+        outcount            = Checkpoint.outcount;
+        phase_counter       = Checkpoint.phase_counter;
+        printf("Restarted from checkpoint at time = %.0fms\n", sim_time_start);
+    }
+    if (Protocol.N > 0) pacing_protocol_seek(&Protocol, iteration_counter); // lib/Tissue_protocols.cpp
+    int checkpoint_interval_int = Sim.Checkpoint_interval * (int)(1/Sim.dt);
+
+    // Vulnerability window search || replaces the time loop: paced once to the earliest S2, then S2 branches from a snapshot
+    if (Argin.Vulnerability_window_arg == true && strcmp(Argin.Vulnerability_window, "On") == 0)
+    {
+        if (Strands.N > 0)
+        {
+            printf("ERROR: Vulnerability_window and Strand_file cannot be combined\n");
+            exit(1);
+        }
+        run_vulnerability_window_search(Argin, Sim, Tissue, SC, Params, State, Variables, Vm, directory); // lib/Tissue_protocols.cpp
+
+        free(directory);
+        free(results_dir);
+        free(res_dir_full);
+        free(sr_dir);
+        SC_array_deallocation(&SC);			// lib/Spatial_coupling.cpp
+        tissue_array_deallocation(&Tissue);	// lib/Tissue.cpp
+        delete [] Params;
+        delete [] State;
+        delete [] Variables;
+        delete [] Vm;
+        delete [] region_node;
+        delete [] region_list;
+        return 0;
+    }
+
+    // What-if branches || the run continues as normal; the tissue is snapshot at Branch_time and each branch advanced from it after
+    Branch_scenarios Branches;
+    Branches.N = 0;
+    if (Argin.Branch_file_arg == true) branch_scenarios_setup(&Branches, &Argin, Sim, Tissue, Strands.N, sim_time_start, directory, res_dir_full); // lib/Tissue_protocols.cpp
+
+    // Modulation events || changes of conditions and modulation during the run, applied to the parameter regions
+    // (Params are not checkpointed; on restart the events due before the checkpoint are re-applied at the first step)
+    Modulation_events Events;
+    Events.N = 0;
+    if (Argin.Event_file_arg == true) modulation_events_setup(&Events, &Argin, Strands.N, directory); // lib/Tissue_protocols.cpp
+
+    // Event-driven measurement || activation time and requested APDs per node; the reference cells keep the full measurements
+    // for their outputs, and the probe nodes for the recorded dvdt
+    Measurement_engine Measure;
+    Measure.N = 0;
+    std::vector<int> measure_full;
+    measure_full.push_back(cell1ref); measure_full.push_back(cell2ref); measure_full.push_back(cell3ref);
+    for (int p = 0; p < Probes.N; p++) measure_full.push_back(Probes.node[p]);
+    if (Argin.Measurement_arg == true && strcmp(Argin.Measurement, "Events") == 0) measurement_engine_setup(&Measure, (Argin.Measurement_APD_arg == true) ? Argin.Measurement_APD : "90", Variables, SC.N, measure_full.data(), (int)measure_full.size()); // lib/Tissue.cpp
+
+    // Steady-state monitors on the three reference cells || pacing stops at the end of the beat in which all have converged
+    Steady_state_monitor Steady[3];
+    int  steady_ref[3]      = {cell1ref, cell2ref, cell3ref};
+    for (int r = 0; r < 3; r++) steady_state_setup(&Steady[r], Sim);  // lib/Model.c
+    bool steady_state_on    = (strcmp(Sim.Steady_state, "On") == 0);
+    bool steady_state       = false;
+    if (restart == true)
+    {
+        for (int r = 0; r < 3; r++) Steady[r] = Checkpoint.steady[r];
+        steady_state = Checkpoint.steady_state;
+    }
+    int  BCL_int            = Sim.BCL * (int)(1/Sim.dt);
+
+    // Beats of the maps || from one stimulus onset (S1, S2 or protocol pulse) to the next; multi-stim sites are part of the S1 beat
+    int    map_beat             = (restart == true) ? Checkpoint.map_beat : 0;
+    double map_beat_start       = (restart == true) ? Checkpoint.map_beat_start : 0;
+
+    // Conduction velocity maps || from the activation times at the end of each beat and of the run
+    CV_maps CVmap;
+    CVmap.N = 0;
+    sprintf(checkpoint_files[8], "%s/CV_map_summary.dat", directory);
+    if (Argin.CV_map_arg == true && strcmp(Argin.CV_map, "On") == 0)
+    {
+        if (Strands.N > 0)
+        {
+            printf("ERROR: CV_map and Strand_file cannot be combined\n");
+            exit(1);
+        }
+        if (restart == true && Checkpoint.file_length[8] >= 0) Truncate_checkpoint_output(checkpoint_files[8], Checkpoint.file_length[8]); // lib/Read_write_state.c
+        cv_map_setup(&CVmap, Tissue, SC, map_beat_start, directory, restart); // lib/Tissue.cpp
+    }
+
+    // APD, repolarisation time and dispersion maps || of every APD_map_interval-th beat and the final one, once its nodes have repolarised
+    APD_maps APDmap;
+    APDmap.N = 0;
+    sprintf(checkpoint_files[9], "%s/APD_map_summary.dat", directory);
+    if (Argin.APD_map_arg == true && strcmp(Argin.APD_map, "On") == 0 && restart == true && Checkpoint.file_length[9] >= 0) Truncate_checkpoint_output(checkpoint_files[9], Checkpoint.file_length[9]); // lib/Read_write_state.c
+    if (Argin.APD_map_arg == true && strcmp(Argin.APD_map, "On") == 0)
+    {
+        apd_map_setup(&APDmap, &Measure, SC.N, (Argin.APD_map_interval_arg == true) ? Argin.APD_map_interval : 1, directory, restart); // lib/Tissue.cpp
+        if (restart == true)
+        {
+            APDmap.pending_beat     = Checkpoint.APD_map_pending_beat;
+            APDmap.pending_start    = Checkpoint.APD_map_pending_start;
+            APDmap.pending_end      = Checkpoint.APD_map_pending_end;
+            Read_checkpoint_tissue_extra(res_dir_full, APDmap.APD, (APDmap.Nlevels+2)*(long)SC.N, SC.N); // lib/Read_write_state.c
+        }
+    }
+
+    // Outcome monitor || checked per ms once the last stimulus (S1, multi-stim, S2 or protocol pulse) has been applied
+    bool   early_stop_on        = (strcmp(Sim.Early_stop, "On") == 0);
+    double early_stop_start     = ((Sim.S2_CL != 0 && Sim.S2_time > Sim.Paced_time) ? Sim.S2_time : Sim.Paced_time) + Params[0].stimduration;
+    if (Protocol.N == 0 && strcmp(Tissue.Multi_stim, "On") == 0) for (int m = 1; m < Tissue.Nstims; m++) early_stop_start = fmax(early_stop_start, Sim.Paced_time + Tissue.stim_delay[m] + Params[m].stimduration);
+    if (Protocol.N > 0)
+    {
+        early_stop_start = 0;
+        for (int p = 0; p < Protocol.N; p++) early_stop_start = fmax(early_stop_start, Protocol.stop[p]*Sim.dt);
+    }
+    int    quiescent_time       = (restart == true) ? Checkpoint.quiescent_time : 0;    // ms
+
     // Time loop ================================================================================\\|
-    printf("Time loop started:\nTime = %.0fms\n",sim_time);
-    for (sim_time = 0.0; sim_time <= (float)Sim.Total_time; sim_time += Sim.dt)
+    printf("Time loop started:\nTime = %.0fms\n",sim_time_start);
+    for (sim_time = sim_time_start; sim_time <= (float)Sim.Total_time; sim_time += Sim.dt)
     {
+        // Modulation events due before this step || lib/Tissue_protocols.cpp
+        while (Events.next < Events.N && sim_time >= Events.time[Events.next])
+        {
+            apply_modulation_event(&Events, Events.next, Tissue, SC, Params, Params_global, region_node, region_list, Nregions, Sim.dt);
+            Events.next++;
+        }
+
+        // Branch point || snapshot of the tissue before this step
+        if (Branches.N > 0 && Branches.taken == false && sim_time >= Branches.time)
+        {
+            if (Measure.N > 0) measurement_engine_sync(&Measure, Variables); // lib/Tissue.cpp
+            tissue_snapshot_take(&Branches.snap, State, Variables, Vm, SC.N, sim_time, iteration_counter); // lib/Tissue_protocols.cpp
+            Branches.taken = true;
+            printf("Branch point at time = %.0fms\n", sim_time);
+        }
+
         // Compute stimulus current || lib/Model.c || sets Istims to 0 or stimmag dependant on time
         // Note: outside of tissue loop as indexes do not correspond with cell indexes 
-        compute_Istim(Params[0], &Variables[0], Sim.Paced_time, Sim.S2_time, sim_time, iteration_counter);  	// lib/Model.c
-        if (strcmp(Tissue.Multi_stim, "On") == 0) for (int m = 1; m < Tissue.Nstims; m++) compute_Istim(Params[m], &Variables[m], Sim.Paced_time, Sim.S2_time, sim_time, iteration_counter - Tissue.stim_delay[m]*(int)(1.0/Sim.dt));
+        // With a pacing protocol, site currents are from its pulse queue instead || lib/Tissue_protocols.cpp
+        double Istim_prev       = Variables[0].Istim;
+        double Istim_S2_prev    = Variables[0].Istim_S2;
+        int    protocol_next    = (Protocol.N > 0) ? Protocol.next : 0;
+        if (Protocol.N > 0) pacing_protocol_step(&Protocol, &Variables[0], iteration_counter);
+        else compute_Istim(Params[0], &Variables[0], Sim.Paced_time, Sim.S2_time, sim_time, iteration_counter);  	// lib/Model.c
+        if (Protocol.N == 0 && strcmp(Tissue.Multi_stim, "On") == 0) for (int m = 1; m < Tissue.Nstims; m++) compute_Istim(Params[m], &Variables[m], Sim.Paced_time, Sim.S2_time, sim_time, iteration_counter - Tissue.stim_delay[m]*(int)(1.0/Sim.dt));
+        if (Strands.N > 0) strand_batch_compute_Istim(&Strands, Params[0], Sim, sim_time, iteration_counter); // lib/Tissue_protocols.cpp
+
+        // Maps of the beat ending at this stimulus onset || lib/Tissue.cpp
+        bool stimulus_onset = (Protocol.N > 0) ? (Protocol.next != protocol_next) : ((Variables[0].Istim != 0 && Istim_prev == 0) || (Variables[0].Istim_S2 != 0 && Istim_S2_prev == 0));
+        if (stimulus_onset == true && sim_time > map_beat_start)
+        {
+            map_beat++;
+            if (CVmap.N > 0) cv_map_beat(&CVmap, SC, Variables, sim_time, map_beat, directory, sr_dir);
+            if (APDmap.N > 0) apd_map_beat(&APDmap, SC, Variables, map_beat_start, sim_time, map_beat, false, directory, sr_dir);
+            map_beat_start = sim_time;
+        }
+
+        // Per-node stimulus currents, written on the stimulus site nodes only || lib/Tissue.cpp
+        // Note [0].Istim is correct, as only calculated once; Istim[m] corresponds to multi-stim site m; S2 current is per strand if batched
+        clear_stimulus_sites(&Tissue);
+        if (Protocol.N > 0) for (int s = 0; s < Tissue.Nstim_sites; s++) apply_stimulus_site(&Tissue, s, Protocol.Istim[s], Sim.dt);
+        else
+        {
+            apply_stimulus_site(&Tissue, 0, Variables[0].Istim, Sim.dt);
+            if (Strands.N > 0) strand_batch_apply_S2(&Strands, &Tissue, SC); // lib/Tissue_protocols.cpp
+            else apply_stimulus_site(&Tissue, 1, Variables[0].Istim_S2, Sim.dt);
+            for (int m = 1; m < Tissue.Nstim_sites-1; m++) apply_stimulus_site(&Tissue, m+1, Variables[m].Istim, Sim.dt);
+        }
+        double *stim_current        = Tissue.stim_current;
+        double *multi_stim_current  = Tissue.multi_stim_current;
 
 		// Loop over all tissue - 1 ===============================\\|
-#pragma omp parallel for default(none) shared(SC, Vm, Params, Variables, State, Sim, Tissue, sim_time)
+#pragma omp parallel for default(none) shared(SC, Vm, Params, Variables, State, Sim, sim_time, Measure, stim_current, multi_stim_current)
 		for (int n = 0; n < SC.N; n++)
 		{
 			// Compute spatial differential || lib/Spatial_coupling.cpp
@@ -562,20 +800,23 @@ int main(int argc, char *argv[])
 			// This sets and updates all gates, and calculates Itot
 			compute_model_native(Params[n], &Variables[n], &State[n], Vm[n], Sim.dt);						// lib/Model.c
 
-			// Update local Voltage from Itot and stimulus current
-			// Note [0].Istim is correct, as only calculated once; stim_area determines whether to actually apply stimulus to cell n
-			State[n].Vm	= State[n].Vm + Sim.dt*(-(Variables[n].Itot + Variables[0].Istim*Tissue.stim_area[n] + Variables[0].Istim_S2*Tissue.S2_stim_area[n])); 
+			// Update local Voltage from Itot and stimulus current (non-zero only on the stimulus sites, scaled by the stimulus area)
+			State[n].Vm	= State[n].Vm + Sim.dt*(-(Variables[n].Itot + stim_current[n]));
 
-			// Add multi_stim if set
-			// If stim map is on, then now Istim[x] corresponds to stim_map = x, so region x will be stimulated when Istim[x] is non-zero
-			if (strcmp(Tissue.Multi_stim, "On") == 0) for (int m = 1; m < Tissue.Nstims; m++) State[n].Vm += -(Sim.dt * Variables[m].Istim * Tissue.multi_stim_area[m][n]);
+			// Add multi_stim if set || dt*Istim[x]*area for nodes of stim map value x
+			if (multi_stim_current != NULL) State[n].Vm += -multi_stim_current[n];
 
 			// Update local voltage due to spatial coupling
 			State[n].Vm = State[n].Vm + Sim.dt*SC.diff[n];
 
 			// Excitation state and measurements | lib/Model.c | "State.Vm" is voltage at t, "Vm" is voltage at t-dt
-			determine_excitation_state(&Variables[n], Vm[n], sim_time);							
-			calculate_measurement_properties(&Variables[n], Vm[n], State[n].Vm, sim_time, Sim.dt, -70, State[n].Cai, State[n].CanSR);		// -70 is APD V threshold	
+			// With event-driven measurement, only the reference cells are fully measured || lib/Tissue.cpp
+			if (Measure.N == 0 || Measure.full[n] == true)
+			{
+				determine_excitation_state(&Variables[n], Vm[n], sim_time);							
+				calculate_measurement_properties(&Variables[n], Vm[n], State[n].Vm, sim_time, Sim.dt, -70, State[n].Cai, State[n].CanSR);		// -70 is APD V threshold	
+			}
+			else measurement_engine_step(&Measure, &Variables[n], n, Vm[n], State[n].Vm, sim_time);
 		} 
 		// End tissue loop - 1 ====================================//|
 
@@ -589,6 +830,16 @@ int main(int argc, char *argv[])
 		}
 		// End tissue loop - 2 ====================================//|
 
+		// Beat-to-beat convergence of the reference cells, checked at each of their excitations while paced
+		if (steady_state_on == true && sim_time < Sim.Paced_time)
+		{
+			for (int r = 0; r < 3; r++) if (Variables[steady_ref[r]].t_ex == sim_time) steady_state_check(&Steady[r], Variables[steady_ref[r]], State[steady_ref[r]].Nai); // lib/Model.c
+			steady_state = Steady[0].converged && Steady[1].converged && Steady[2].converged;
+		}
+
+		// Probe recorder || buffered; written in binary blocks
+		if (Probes.N > 0 && iteration_counter%Probes.interval_int == 0) probe_record(&Probes, sim_time, State, Variables, Vm, Tissue.stim_current, Tissue.multi_stim_current, Sim.dt); // lib/Outputs.cpp
+
 		// Output data to files - average and linescan ============\\|
 		if (iteration_counter%(int)(1/Sim.dt) == 0) // if sim_time is an integer (i.e. per ms)
 		{
@@ -616,6 +867,9 @@ int main(int argc, char *argv[])
                     if (outcount %Sim.Spatial_output_interval_data == 0) array_1D_output("Vm", directory, sr_dir, Vm, SC, outcount); // every x ms, output bin data array
                 }
             }
+
+            // Slices, ROIs and decimated volumes; each sink has its own interval and time range
+            if (Sim.N_output_sinks > 0) output_sinks("Vm", directory, sr_dir, Vm, SC, outcount, &Sim); // lib/Outputs.cpp
             // End Spatial data out ===========//|
 
             // If phase output is set, and times are appropriate, output state to phase files || numbered 0-200
@@ -623,7 +877,11 @@ int main(int argc, char *argv[])
             {
                 if (sim_time > (Sim.NBeats-1)*Sim.BCL && sim_time < (Sim.NBeats -1)*Sim.BCL + 402)
                 {
-                    if (phase_counter%2 == 0) Write_state_phase(State[5], Params[5], Sim.BCL, PATH, Params[5].Model, 200-(phase_counter/2), Sim.state_reference_write); //lib/Read_write_state.c
+                    if (phase_counter%2 == 0)
+                    {
+                        if (state_library == true) Write_state_library(State[5], Params[5], Sim.BCL, PATH, Params[5].Model, "phase", 200-(phase_counter/2), Sim.state_reference_write); //lib/Read_write_state.c
+                        else Write_state_phase(State[5], Params[5], Sim.BCL, PATH, Params[5].Model, 200-(phase_counter/2), Sim.state_reference_write); //lib/Read_write_state.c
+                    }
                     printf("Written phase file %d\n", 200-(phase_counter/2));
                     phase_counter++;		
                 }
@@ -635,16 +893,92 @@ int main(int argc, char *argv[])
 
         iteration_counter ++;  // number of steps in dt
         if (iteration_counter%(500 *((int)(1/Sim.dt))) == 0) printf("Time = %.0fms\n",sim_time); // output every 500 ms
+
+        // APD map waiting for its nodes to repolarise || lib/Tissue.cpp
+        if (APDmap.N > 0 && iteration_counter%(int)(1/Sim.dt) == 0) apd_map_update(&APDmap, SC, Variables, directory, sr_dir);
+
+        // Stop at the end of the beat (same phase as a full-length run) once steady state is detected
+        if (steady_state == true && iteration_counter%BCL_int == 0) break;
+
+        // Stop once the outcome is determined: tissue quiescent, or both strand ends excited after S2 (as compute_conduction_success)
+        if (early_stop_on == true && sim_time > early_stop_start && iteration_counter%(int)(1/Sim.dt) == 0)
+        {
+            int Nactive = 0;
+            #pragma omp parallel for reduction(+:Nactive)
+            for (int n = 0; n < SC.N; n++) if (Vm[n] > Sim.Early_stop_Vm) Nactive++;
+            if (Nactive <= Sim.Early_stop_active*SC.N) quiescent_time++;
+            else quiescent_time = 0;
+
+            int left_ex, right_ex;
+            const char *early_stop_reason = NULL;
+            if (quiescent_time >= Sim.Early_stop_quiescent) early_stop_reason = "tissue quiescent";
+            else if (Strands.N > 0 && Sim.S2_CL != 0 && strand_batch_full_conduction(&Strands, Variables, SC.NX) == true) early_stop_reason = "full conduction after S2 in all strands";
+            else if (Strands.N == 0 && strcmp(Tissue.Tissue_order, "1D") == 0 && Sim.S2_CL != 0 && conduction_success_type(Variables, SC.N, Sim.S2_time-5, &left_ex, &right_ex) == 2) early_stop_reason = "full conduction after S2";
+            if (early_stop_reason != NULL)
+            {
+                printf("Early stop at time = %.0fms: %s\n", sim_time, early_stop_reason);
+                break;
+            }
+        }
+
+        // Checkpoint || atomic; text and probe outputs are flushed so their lengths match the saved state
+        // (after the per-step checks, so the saved monitors include this step)
+        if (checkpoint_interval_int > 0 && iteration_counter%checkpoint_interval_int == 0)
+        {
+            out_cu.flush(); out_ex.flush(); out_cu2.flush(); out_ex2.flush(); out_cu3.flush(); out_ex3.flush(); out_ls.flush();
+            if (Probes.N > 0) { probe_flush(&Probes); fflush(Probes.out); }
+            Checkpoint.sim_time             = sim_time + Sim.dt;    // as the loop increment, so a restart continues bit-identically
+            Checkpoint.iteration_counter    = iteration_counter;
+            Checkpoint.outcount             = outcount;
+            Checkpoint.phase_counter        = phase_counter;
+            Checkpoint.quiescent_time       = quiescent_time;
+            Checkpoint.steady_state         = steady_state;
+            for (int r = 0; r < 3; r++) Checkpoint.steady[r] = Steady[r];
+            Checkpoint.map_beat             = map_beat;
+            Checkpoint.map_beat_start       = map_beat_start;
+            Checkpoint.APD_map_pending_beat = (APDmap.N > 0) ? APDmap.pending_beat : 0;
+            Checkpoint.APD_map_pending_start= (APDmap.N > 0) ? APDmap.pending_start : 0;
+            Checkpoint.APD_map_pending_end  = (APDmap.N > 0) ? APDmap.pending_end : 0;
+            if (Measure.N > 0) measurement_engine_sync(&Measure, Variables); // lib/Tissue.cpp
+            Checkpoint.Nfiles               = 10;
+            for (int f = 0; f < Checkpoint.Nfiles; f++) // -1 if the file is not written by this run
+            {
+                struct stat st;
+                Checkpoint.file_length[f] = (stat(checkpoint_files[f], &st) == 0) ? (long)st.st_size : -1;
+            }
+            Write_checkpoint_tissue(res_dir_full, Checkpoint, State, Variables, Vm, SC.N, Sim.dt, (APDmap.N > 0) ? APDmap.APD : NULL, (APDmap.N > 0) ? (APDmap.Nlevels+2)*(long)SC.N : 0); // lib/Read_write_state.c
+        }
     }
     // End Time loop ============================================================================//|
 
     // Print final time in simulation land
     printf("Final Time = %.0fms\n\n",sim_time);
 
+    // Event-driven measurements to the Model_variables read below || lib/Tissue.cpp
+    if (Measure.N > 0) measurement_engine_sync(&Measure, Variables);
+
+    // Conduction velocity map of the final (part) beat; nothing is written if none was activated since the last map || lib/Tissue.cpp
+    if (CVmap.N > 0) cv_map_beat(&CVmap, SC, Variables, sim_time, map_beat + 1, directory, sr_dir);
+    if (APDmap.N > 0) apd_map_beat(&APDmap, SC, Variables, map_beat_start, sim_time, map_beat + 1, true, directory, sr_dir);
+
+    // Write remaining probe samples and close probe file
+    probe_close(&Probes);	// lib/Outputs.cpp
+
+    // Record number of beats actually paced || reported for the middle reference cell
+    if (steady_state_on == true)
+    {
+        Steady[1].converged = steady_state;
+        char * ss_reference     = (char*)malloc(500);
+        sprintf(ss_reference, "%s/Steady_state_log.dat", directory);
+        output_steady_state_log(ss_reference, Steady[1], Sim, (steady_state == true) ? iteration_counter/BCL_int : Sim.NBeats);    // lib/Outputs.cpp
+        free(ss_reference);
+    }
+
     // Write state 
     if (strcmp(Sim.Write_state, "On") == 0) // whole tissue dump
     {
-        Write_state_tissue_native_whole_tissue(State, Params, Sim.BCL, PATH, Params_global.Model, SC.N, Tissue.Tissue_order, Tissue.Tissue_model, Tissue.Tissue_type, Tissue.Orientation_type, Sim.state_reference_write); //lib/Read_write_state.c
+        if (strcmp(Sim.State_format, "binary") == 0) Write_state_tissue_native_whole_tissue_binary(State, Params, Sim.BCL, PATH, Params_global.Model, SC.N, Tissue.Tissue_order, Tissue.Tissue_model, Tissue.Tissue_type, Tissue.Orientation_type, Sim.state_reference_write); //lib/Read_write_state.c
+        else Write_state_tissue_native_whole_tissue(State, Params, Sim.BCL, PATH, Params_global.Model, SC.N, Tissue.Tissue_order, Tissue.Tissue_model, Tissue.Tissue_type, Tissue.Orientation_type, Sim.state_reference_write); //lib/Read_write_state.c
         printf("State written to file\n");
     }
     else if (strcmp(Sim.Write_state, "ave") == 0) // writes state for just one cell in the tissue (for region x)
@@ -654,6 +988,7 @@ int main(int argc, char *argv[])
             printf("ERROR: average tissue state write must be performed on homogeneous tissue - if wanting to apply to heterogeneous, run 1D homogeneous model for each celltype\n");
             exit(1);
         }
+        else if (state_library == true) Write_state_library(State[10], Params[10], Sim.BCL, PATH, Params[10].Model, "ave", 0, Sim.state_reference_write); //lib/Read_write_state.c
         else Write_state_tissue_native_ave_tissue(State[10], Params[10], Sim.BCL, PATH, Params[10].Model, Sim.state_reference_write);	 //lib/Read_write_state.c
         printf("State written to file - one coupled cell\n");
     }
@@ -667,12 +1002,17 @@ int main(int argc, char *argv[])
 
     // Output ativation map, final beat, vtk and datafile || lib/Outputs.cpp
     Output_activation(directory, sr_dir, Variables, SC);
+    if (Measure.N > 0) Output_APD_maps(directory, sr_dir, &Measure, Variables, SC);
 
     // Calculate and output conduction velocity || lib/Tissue.cpp
     if (strcmp(Tissue.Tissue_model, "conduction_velocity") == 0) calculate_CV(Tissue, Variables, directory);
 
     // Calculate and output conduction success for VW (1D only - any tissue model - only makes sense for S1-S2 pacing, and so only calculates after S2)
-    if (strcmp(Tissue.Tissue_order, "1D") == 0 && Sim.S2_CL != 0) compute_conduction_success(Tissue, Variables , SC.N, Sim.S2_time, Sim.S2_CL, directory); // lib/Tissue.cpp
+    if (Strands.N > 0) strand_batch_results(&Strands, Variables, SC.NX, directory, res_dir_full); // lib/Tissue_protocols.cpp || per strand
+    else if (strcmp(Tissue.Tissue_order, "1D") == 0 && Sim.S2_CL != 0) compute_conduction_success(Tissue, Variables , SC.N, Sim.S2_time, Sim.S2_CL, directory); // lib/Tissue.cpp
+
+    // What-if branches from the snapshot || lib/Tissue_protocols.cpp
+    if (Branches.N > 0) run_branch_scenarios(&Branches, Sim, Tissue, SC, Params, Params_global, res_dir_full);
 
     time (&rawtime);
     printf("|============================================================|\n");
@@ -692,10 +1032,19 @@ int main(int argc, char *argv[])
     free(sr_dir);
     SC_array_deallocation(&SC);			// lib/Spatial_coupling.cpp
     tissue_array_deallocation(&Tissue);	// lib/Tissue.cpp
+    if (Strands.N > 0) strand_batch_free(&Strands);	// lib/Tissue_protocols.cpp
+    if (Branches.N > 0) branch_scenarios_free(&Branches);	// lib/Tissue_protocols.cpp
+    if (Events.N > 0) modulation_events_free(&Events);		// lib/Tissue_protocols.cpp
+    if (Protocol.N > 0) pacing_protocol_free(&Protocol);	// lib/Tissue_protocols.cpp
+    if (Measure.N > 0) measurement_engine_free(&Measure);		// lib/Tissue.cpp
+    if (CVmap.N > 0) cv_map_free(&CVmap);						// lib/Tissue.cpp
+    if (APDmap.N > 0) apd_map_free(&APDmap);					// lib/Tissue.cpp
     delete [] Params;
     delete [] State;
     delete [] Variables;
     delete [] Vm;
+    delete [] region_node;
+    delete [] region_list;
 } 
 // End Main *************************************************************************************//|
 
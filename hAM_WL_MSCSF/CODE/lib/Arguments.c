@@ -72,11 +72,15 @@
 #include <string.h>
 #include <time.h>
 #include <stdbool.h> 
+#include <string>
+#include <vector>
 
 // Functions  =========================================================================\\|
 //	set_argument_defaults()
 //	call_argument_functions()
 //	set_arguments()
+//	read_batch_file()
+//	set_batch_job_arguments()
 // End Functions  =====================================================================//|
 
 // Set Argument flag defaults =========================================================\\|
@@ -98,6 +102,32 @@ void set_argument_defaults(Argument_parameters *A)
 	A->SOId_arg			        	= false;
     A->SORs_arg                     = false;
     A->SORe_arg                     = false;
+    A->State_format_arg             = false;
+    A->Checkpoint_interval_arg      = false;
+    A->Restart_arg                  = false;
+    A->State_library_arg            = false;
+    A->State_library_BCL_arg        = false;
+    A->Batch_file_arg               = false;
+    A->Batch_format_arg             = false;
+    A->S2_range_arg                 = false;
+    A->Dynamic_BCLs_arg             = false;
+    A->Population_arg               = false;
+    A->Population_sampling_arg      = false;
+    A->Population_currents_arg      = false;
+    A->Population_range_arg         = false;
+    A->Population_sigma_arg         = false;
+    A->Population_seed_arg          = false;
+    A->Calibration_file_arg         = false;
+    A->Steady_state_arg             = false;
+    A->SS_tol_APD_arg               = false;
+    A->SS_tol_Ca_arg                = false;
+    A->SS_tol_Nai_arg               = false;
+    A->SS_beats_arg                 = false;
+    A->Early_stop_arg               = false;
+    A->Early_stop_Vm_arg            = false;
+    A->Early_stop_active_arg        = false;
+    A->Early_stop_quiescent_arg     = false;
+	A->N_output_sinks				= 0;
 	A->Multi_stim_arg	        	= false;
 	A->settings_file            	= false;
 	// End sim settings =============//|
@@ -190,6 +220,29 @@ void set_argument_defaults(Argument_parameters *A)
 	A->SRF_map_file_arg					= false;
 	A->Direct_modulation_map_file_arg	= false;
 	A->spatial_gradient_map_file_arg	= false;
+	A->Probe_file_arg					= false;
+	A->Probe_nodes_arg					= false;
+	A->Probe_variables_arg				= false;
+	A->Probe_interval_arg				= false;
+	A->Probe_buffer_arg					= false;
+	A->Input_binary_write_arg			= false;
+	A->Tissue_cache_arg					= false;
+	A->Tissue_cache_dir_arg				= false;
+	A->Strand_file_arg					= false;
+	A->Vulnerability_window_arg			= false;
+	A->VW_S2_range_arg					= false;
+	A->VW_S2_step_arg					= false;
+	A->VW_precision_arg					= false;
+	A->VW_S2_x_locs_arg					= false;
+	A->Branch_file_arg					= false;
+	A->Branch_time_arg					= false;
+	A->Event_file_arg					= false;
+	A->Protocol_file_arg				= false;
+	A->Measurement_arg					= false;
+	A->Measurement_APD_arg				= false;
+	A->CV_map_arg						= false;
+	A->APD_map_arg						= false;
+	A->APD_map_interval_arg				= false;
 	A->Tissue_model_2_arg   			= false;
 	A->Multiple_models_arg  			= false;
 	// End Tissue settings ==========//|
@@ -498,6 +551,254 @@ void set_arguments(int Narg, char *argin[], Argument_parameters *A, char const *
 			}
 			counter++; isFound = true;
 		}
+		if (strcmp(argin[counter], "State_format") == 0)
+		{
+			A->State_format      	    = argin[counter+1];
+			A->State_format_arg			= true;
+			fprintf(out, "State_format   %s ", argin[counter+1]);
+			if (strcmp(A->State_format, "text") != 0 && strcmp(A->State_format, "binary") != 0)
+			{
+				printf("ERROR: \"%s\" is not a valid State_format argument. Please pass only \"text\" or \"binary\"\n\n", A->State_format);
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Checkpoint_interval") == 0)
+		{
+			A->Checkpoint_interval      = atoi(argin[counter+1]);
+			A->Checkpoint_interval_arg	= true;
+			fprintf(out, "Checkpoint_interval   %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Restart") == 0)
+		{
+			A->Restart      	    = argin[counter+1];
+			A->Restart_arg			= true;
+			fprintf(out, "Restart   %s ", argin[counter+1]);
+			if (strcmp(A->Restart, "On") != 0 && strcmp(A->Restart, "Off") != 0)
+			{
+				printf("ERROR: \"%s\" is not a valid Restart argument. Please pass only \"Off\" or \"On\"\n\n", A->Restart);
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "State_library") == 0)
+		{
+			A->State_library      	    = argin[counter+1];
+			A->State_library_arg		= true;
+			fprintf(out, "State_library   %s ", argin[counter+1]);
+			if (strcmp(A->State_library, "On") != 0 && strcmp(A->State_library, "Off") != 0)
+			{
+				printf("ERROR: \"%s\" is not a valid State_library argument. Please pass only \"Off\" or \"On\"\n\n", A->State_library);
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "State_library_BCL") == 0)
+		{
+			A->State_library_BCL      	= argin[counter+1];
+			A->State_library_BCL_arg	= true;
+			fprintf(out, "State_library_BCL   %s ", argin[counter+1]);
+			if (strcmp(A->State_library_BCL, "exact") != 0 && strcmp(A->State_library_BCL, "nearest") != 0)
+			{
+				printf("ERROR: \"%s\" is not a valid State_library_BCL argument. Please pass only \"exact\" or \"nearest\"\n\n", A->State_library_BCL);
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Batch_file") == 0)
+		{
+			A->Batch_file      	    	= argin[counter+1];
+			A->Batch_file_arg			= true;
+			fprintf(out, "Batch_file   %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Batch_format") == 0)
+		{
+			A->Batch_format      	    = argin[counter+1];
+			A->Batch_format_arg			= true;
+			fprintf(out, "Batch_format   %s ", argin[counter+1]);
+			if (strcmp(A->Batch_format, "csv") != 0 && strcmp(A->Batch_format, "binary") != 0)
+			{
+				printf("ERROR: \"%s\" is not a valid Batch_format argument. Please pass only \"csv\" or \"binary\"\n\n", A->Batch_format);
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "S2_range") == 0)
+		{
+			A->S2_range_start      	    = atoi(argin[counter+1]);
+			A->S2_range_end      	    = atoi(argin[counter+2]);
+			A->S2_range_step      	    = atoi(argin[counter+3]);
+			A->S2_range_arg				= true;
+			fprintf(out, "S2_range   %s %s %s ", argin[counter+1], argin[counter+2], argin[counter+3]);
+			if (A->S2_range_step == 0 || A->S2_range_start <= 0 || A->S2_range_end <= 0)
+			{
+				printf("ERROR: S2_range must be passed as [start ms] [end ms] [step ms], all non-zero\n\n");
+				exit(1);
+			}
+			counter += 3; isFound = true;
+		}
+		if (strcmp(argin[counter], "Dynamic_BCLs") == 0)
+		{
+			A->Dynamic_BCLs      	    = argin[counter+1];
+			A->Dynamic_BCLs_arg			= true;
+			fprintf(out, "Dynamic_BCLs   %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Population") == 0)
+		{
+			A->Population      	    	= atoi(argin[counter+1]);
+			A->Population_arg			= true;
+			fprintf(out, "Population   %s ", argin[counter+1]);
+			if (A->Population < 1)
+			{
+				printf("ERROR: Population must be at least 1\n\n");
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Population_sampling") == 0)
+		{
+			A->Population_sampling      = argin[counter+1];
+			A->Population_sampling_arg	= true;
+			fprintf(out, "Population_sampling   %s ", argin[counter+1]);
+			if (strcmp(A->Population_sampling, "uniform") != 0 && strcmp(A->Population_sampling, "lognormal") != 0 && strcmp(A->Population_sampling, "LHS") != 0)
+			{
+				printf("ERROR: \"%s\" is not a valid Population_sampling argument. Please pass only \"uniform\", \"lognormal\" or \"LHS\"\n\n", A->Population_sampling);
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Population_currents") == 0)
+		{
+			A->Population_currents      = argin[counter+1];
+			A->Population_currents_arg	= true;
+			fprintf(out, "Population_currents   %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Population_range") == 0)
+		{
+			A->Population_min      		= atof(argin[counter+1]);
+			A->Population_max      		= atof(argin[counter+2]);
+			A->Population_range_arg		= true;
+			fprintf(out, "Population_range   %s %s ", argin[counter+1], argin[counter+2]);
+			if (A->Population_min < 0 || A->Population_max < A->Population_min)
+			{
+				printf("ERROR: Population_range must be 0 <= min <= max\n\n");
+				exit(1);
+			}
+			counter += 2; isFound = true;
+		}
+		if (strcmp(argin[counter], "Population_sigma") == 0)
+		{
+			A->Population_sigma      	= atof(argin[counter+1]);
+			A->Population_sigma_arg		= true;
+			fprintf(out, "Population_sigma   %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Population_seed") == 0)
+		{
+			A->Population_seed      	= atoi(argin[counter+1]);
+			A->Population_seed_arg		= true;
+			fprintf(out, "Population_seed   %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Calibration_file") == 0)
+		{
+			A->Calibration_file      	= argin[counter+1];
+			A->Calibration_file_arg		= true;
+			fprintf(out, "Calibration_file   %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Steady_state") == 0)
+		{
+			A->Steady_state      	    = argin[counter+1];
+			A->Steady_state_arg			= true;
+			fprintf(out, "Steady_state   %s ", argin[counter+1]);
+			if (strcmp(A->Steady_state, "On") != 0 && strcmp(A->Steady_state, "Off") != 0)
+			{
+				printf("ERROR: \"%s\" is not a valid Steady_state argument. Please pass only \"Off\" or \"On\"\n\n", A->Steady_state);
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "SS_tol_APD") == 0)
+		{
+			A->SS_tol_APD      			= atof(argin[counter+1]);
+			A->SS_tol_APD_arg			= true;
+			fprintf(out, "SS_tol_APD   %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "SS_tol_Ca") == 0)
+		{
+			A->SS_tol_Ca      			= atof(argin[counter+1]);
+			A->SS_tol_Ca_arg			= true;
+			fprintf(out, "SS_tol_Ca   %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "SS_tol_Nai") == 0)
+		{
+			A->SS_tol_Nai      			= atof(argin[counter+1]);
+			A->SS_tol_Nai_arg			= true;
+			fprintf(out, "SS_tol_Nai   %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "SS_beats") == 0)
+		{
+			A->SS_beats      			= atoi(argin[counter+1]);
+			A->SS_beats_arg				= true;
+			fprintf(out, "SS_beats   %s ", argin[counter+1]);
+			if (A->SS_beats < 1)
+			{
+				printf("ERROR: SS_beats must be at least 1\n\n");
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Early_stop") == 0)
+		{
+			A->Early_stop      	    	= argin[counter+1];
+			A->Early_stop_arg			= true;
+			fprintf(out, "Early_stop   %s ", argin[counter+1]);
+			if (strcmp(A->Early_stop, "On") != 0 && strcmp(A->Early_stop, "Off") != 0)
+			{
+				printf("ERROR: \"%s\" is not a valid Early_stop argument. Please pass only \"Off\" or \"On\"\n\n", A->Early_stop);
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Early_stop_Vm") == 0)
+		{
+			A->Early_stop_Vm      		= atof(argin[counter+1]);
+			A->Early_stop_Vm_arg		= true;
+			fprintf(out, "Early_stop_Vm   %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Early_stop_active") == 0)
+		{
+			A->Early_stop_active      	= atof(argin[counter+1]);
+			A->Early_stop_active_arg	= true;
+			fprintf(out, "Early_stop_active   %s ", argin[counter+1]);
+			if (A->Early_stop_active < 0 || A->Early_stop_active >= 1)
+			{
+				printf("ERROR: Early_stop_active is a fraction of nodes; pass 0 <= x < 1\n\n");
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Early_stop_quiescent") == 0)
+		{
+			A->Early_stop_quiescent     = atoi(argin[counter+1]);
+			A->Early_stop_quiescent_arg	= true;
+			fprintf(out, "Early_stop_quiescent   %s ", argin[counter+1]);
+			if (A->Early_stop_quiescent < 1)
+			{
+				printf("ERROR: Early_stop_quiescent must be at least 1 ms\n\n");
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
 		if (strcmp(argin[counter], "Spatial_output_interval_vtk") == 0)
 		{
 			A->SOI            = atoi(argin[counter+1]);
@@ -526,6 +827,86 @@ void set_arguments(int Narg, char *argin[], Argument_parameters *A, char const *
             fprintf(out, "Spatial_output_range_end   %s ", argin[counter+1]);
             counter++; isFound = true;
         }
+		// Output sinks || each call adds one sink; Output_sink_range applies to the most recently added sink
+		if (strcmp(argin[counter], "Output_slice") == 0 || strcmp(argin[counter], "Output_ROI") == 0 || strcmp(argin[counter], "Output_decimated") == 0)
+		{
+			if (A->N_output_sinks >= 20)
+			{
+				printf("ERROR: a maximum of 20 output sinks (Output_slice/ROI/decimated) can be set\n\n");
+				exit(1);
+			}
+			Output_sink *os = &A->output_sink[A->N_output_sinks];
+			os->x0 = -1; os->x1 = -1; os->y0 = -1; os->y1 = -1; os->z0 = -1; os->z1 = -1;
+			os->k = 1; os->start_time = -1; os->end_time = -1;
+			int Nvals;
+			if (strcmp(argin[counter], "Output_slice") == 0) 	Nvals = 4; 	// plane, position, k, interval
+			else if (strcmp(argin[counter], "Output_ROI") == 0) Nvals = 8; 	// x0 x1 y0 y1 z0 z1 k interval
+			else 												Nvals = 2; 	// k interval
+			if (counter + Nvals >= Narg)
+			{
+				printf("ERROR: \"%s\" requires %d values\n\n", argin[counter], Nvals);
+				exit(1);
+			}
+			fprintf(out, "%s ", argin[counter]);
+			for (int i = 1; i <= Nvals; i++) fprintf(out, "%s ", argin[counter+i]);
+
+			if (strcmp(argin[counter], "Output_slice") == 0)
+			{
+				int pos 		= atoi(argin[counter+2]);
+				os->k 			= atoi(argin[counter+3]);
+				os->interval 	= atoi(argin[counter+4]);
+				if (pos < 0)
+				{
+					printf("ERROR: Output_slice position must be >= 0 (passed %d)\n\n", pos);
+					exit(1);
+				}
+				if 		(strcmp(argin[counter+1], "XY") == 0) { os->type = "slice_XY"; os->z0 = pos; os->z1 = pos; }
+				else if (strcmp(argin[counter+1], "XZ") == 0) { os->type = "slice_XZ"; os->y0 = pos; os->y1 = pos; }
+				else if (strcmp(argin[counter+1], "YZ") == 0) { os->type = "slice_YZ"; os->x0 = pos; os->x1 = pos; }
+				else
+				{
+					printf("ERROR: \"%s\" is not a valid Output_slice plane. Please pass only \"XY\", \"XZ\" or \"YZ\"\n\n", argin[counter+1]);
+					exit(1);
+				}
+			}
+			else if (strcmp(argin[counter], "Output_ROI") == 0)
+			{
+				os->type 		= "ROI";
+				os->x0 			= atoi(argin[counter+1]);
+				os->x1 			= atoi(argin[counter+2]);
+				os->y0 			= atoi(argin[counter+3]);
+				os->y1 			= atoi(argin[counter+4]);
+				os->z0 			= atoi(argin[counter+5]);
+				os->z1 			= atoi(argin[counter+6]);
+				os->k 			= atoi(argin[counter+7]);
+				os->interval 	= atoi(argin[counter+8]);
+			}
+			else // decimated full volume is an ROI over the whole domain
+			{
+				os->type 		= "ROI";
+				os->k 			= atoi(argin[counter+1]);
+				os->interval 	= atoi(argin[counter+2]);
+			}
+			if (os->k < 1 || os->interval < 1)
+			{
+				printf("ERROR: output sink decimation (k) and interval must be >= 1\n\n");
+				exit(1);
+			}
+			A->N_output_sinks++;
+			counter += Nvals; isFound = true;
+		}
+		if (strcmp(argin[counter], "Output_sink_range") == 0)
+		{
+			if (A->N_output_sinks == 0)
+			{
+				printf("ERROR: \"Output_sink_range\" must be passed after the Output_slice/ROI/decimated sink it applies to\n\n");
+				exit(1);
+			}
+			A->output_sink[A->N_output_sinks-1].start_time 	= atoi(argin[counter+1]);
+			A->output_sink[A->N_output_sinks-1].end_time 	= atoi(argin[counter+2]);
+			fprintf(out, "Output_sink_range   %s %s ", argin[counter+1], argin[counter+2]);
+			counter += 2; isFound = true;
+		}
 		if (strcmp(argin[counter], "Multi_stim") == 0)
 		{
 			A->Multi_stim               = argin[counter+1];
@@ -1126,6 +1507,223 @@ void set_arguments(int Narg, char *argin[], Argument_parameters *A, char const *
             fprintf(out, "Spatial_gradient_map_file %s ", argin[counter+1]);
             counter++; isFound = true;
         }
+		if (strcmp(argin[counter], "Probe_file") == 0)
+		{
+			A->Probe_file      		= argin[counter+1];
+			A->Probe_file_arg  		= true;
+			fprintf(out, "Probe_file %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Probe_nodes") == 0)
+		{
+			A->Probe_nodes      	= argin[counter+1];
+			A->Probe_nodes_arg  	= true;
+			fprintf(out, "Probe_nodes %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Probe_variables") == 0)
+		{
+			A->Probe_variables      = argin[counter+1];
+			A->Probe_variables_arg  = true;
+			fprintf(out, "Probe_variables %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Probe_interval") == 0)
+		{
+			A->Probe_interval      	= atof(argin[counter+1]);
+			A->Probe_interval_arg  	= true;
+			fprintf(out, "Probe_interval %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Probe_buffer") == 0)
+		{
+			A->Probe_buffer      	= atoi(argin[counter+1]);
+			A->Probe_buffer_arg  	= true;
+			fprintf(out, "Probe_buffer %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Input_binary_write") == 0)
+		{
+			A->Input_binary_write      	= argin[counter+1];
+			A->Input_binary_write_arg  	= true;
+			fprintf(out, "Input_binary_write %s ", argin[counter+1]);
+			if (strcmp(A->Input_binary_write, "On") != 0 && strcmp(A->Input_binary_write, "Off") != 0)
+			{
+				printf("ERROR: \"%s\" is not a valid Input_binary_write argument. Please pass only \"Off\" or \"On\"\n\n", A->Input_binary_write);
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Tissue_cache") == 0)
+		{
+			A->Tissue_cache      	= argin[counter+1];
+			A->Tissue_cache_arg  	= true;
+			fprintf(out, "Tissue_cache %s ", argin[counter+1]);
+			if (strcmp(A->Tissue_cache, "On") != 0 && strcmp(A->Tissue_cache, "Off") != 0)
+			{
+				printf("ERROR: \"%s\" is not a valid Tissue_cache argument. Please pass only \"Off\" or \"On\"\n\n", A->Tissue_cache);
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Tissue_cache_dir") == 0)
+		{
+			A->Tissue_cache_dir      	= argin[counter+1];
+			A->Tissue_cache_dir_arg  	= true;
+			fprintf(out, "Tissue_cache_dir %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Strand_file") == 0)
+		{
+			A->Strand_file      		= argin[counter+1];
+			A->Strand_file_arg  		= true;
+			fprintf(out, "Strand_file %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Vulnerability_window") == 0)
+		{
+			A->Vulnerability_window      	= argin[counter+1];
+			A->Vulnerability_window_arg  	= true;
+			fprintf(out, "Vulnerability_window %s ", argin[counter+1]);
+			if (strcmp(A->Vulnerability_window, "On") != 0 && strcmp(A->Vulnerability_window, "Off") != 0)
+			{
+				printf("ERROR: \"%s\" is not a valid Vulnerability_window argument. Please pass only \"Off\" or \"On\"\n\n", A->Vulnerability_window);
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "VW_S2_range") == 0)
+		{
+			A->VW_S2_min      			= atof(argin[counter+1]);
+			A->VW_S2_max      			= atof(argin[counter+2]);
+			A->VW_S2_range_arg  		= true;
+			fprintf(out, "VW_S2_range %s %s ", argin[counter+1], argin[counter+2]);
+			if (A->VW_S2_min <= 0 || A->VW_S2_max < A->VW_S2_min)
+			{
+				printf("ERROR: VW_S2_range must be 0 < min <= max\n\n");
+				exit(1);
+			}
+			counter += 2; isFound = true;
+		}
+		if (strcmp(argin[counter], "VW_S2_step") == 0)
+		{
+			A->VW_S2_step      			= atof(argin[counter+1]);
+			A->VW_S2_step_arg  			= true;
+			fprintf(out, "VW_S2_step %s ", argin[counter+1]);
+			if (A->VW_S2_step <= 0)
+			{
+				printf("ERROR: VW_S2_step must be > 0\n\n");
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "VW_precision") == 0)
+		{
+			A->VW_precision      		= atof(argin[counter+1]);
+			A->VW_precision_arg  		= true;
+			fprintf(out, "VW_precision %s ", argin[counter+1]);
+			if (A->VW_precision <= 0)
+			{
+				printf("ERROR: VW_precision must be > 0\n\n");
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "VW_S2_x_locs") == 0)
+		{
+			A->VW_S2_x_locs      		= argin[counter+1];
+			A->VW_S2_x_locs_arg  		= true;
+			fprintf(out, "VW_S2_x_locs %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Branch_file") == 0)
+		{
+			A->Branch_file      		= argin[counter+1];
+			A->Branch_file_arg  		= true;
+			fprintf(out, "Branch_file %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Branch_time") == 0)
+		{
+			A->Branch_time      		= atof(argin[counter+1]);
+			A->Branch_time_arg  		= true;
+			fprintf(out, "Branch_time %s ", argin[counter+1]);
+			if (A->Branch_time < 0)
+			{
+				printf("ERROR: Branch_time must be >= 0\n\n");
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Event_file") == 0)
+		{
+			A->Event_file      			= argin[counter+1];
+			A->Event_file_arg  			= true;
+			fprintf(out, "Event_file %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Protocol_file") == 0)
+		{
+			A->Protocol_file      		= argin[counter+1];
+			A->Protocol_file_arg  		= true;
+			fprintf(out, "Protocol_file %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Measurement") == 0)
+		{
+			A->Measurement      		= argin[counter+1];
+			A->Measurement_arg  		= true;
+			fprintf(out, "Measurement %s ", argin[counter+1]);
+			if (strcmp(A->Measurement, "Full") != 0 && strcmp(A->Measurement, "Events") != 0)
+			{
+				printf("ERROR: \"%s\" is not a valid Measurement argument. Please pass only \"Full\" or \"Events\"\n\n", A->Measurement);
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "Measurement_APD") == 0)
+		{
+			A->Measurement_APD      	= argin[counter+1];
+			A->Measurement_APD_arg  	= true;
+			fprintf(out, "Measurement_APD %s ", argin[counter+1]);
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "CV_map") == 0)
+		{
+			A->CV_map      				= argin[counter+1];
+			A->CV_map_arg  				= true;
+			fprintf(out, "CV_map %s ", argin[counter+1]);
+			if (strcmp(A->CV_map, "On") != 0 && strcmp(A->CV_map, "Off") != 0)
+			{
+				printf("ERROR: \"%s\" is not a valid CV_map argument. Please pass only \"Off\" or \"On\"\n\n", A->CV_map);
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "APD_map") == 0)
+		{
+			A->APD_map      			= argin[counter+1];
+			A->APD_map_arg  			= true;
+			fprintf(out, "APD_map %s ", argin[counter+1]);
+			if (strcmp(A->APD_map, "On") != 0 && strcmp(A->APD_map, "Off") != 0)
+			{
+				printf("ERROR: \"%s\" is not a valid APD_map argument. Please pass only \"Off\" or \"On\"\n\n", A->APD_map);
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
+		if (strcmp(argin[counter], "APD_map_interval") == 0)
+		{
+			A->APD_map_interval      	= atoi(argin[counter+1]);
+			A->APD_map_interval_arg  	= true;
+			fprintf(out, "APD_map_interval %s ", argin[counter+1]);
+			if (A->APD_map_interval < 1)
+			{
+				printf("ERROR: APD_map_interval must be at least 1 beat\n\n");
+				exit(1);
+			}
+			counter++; isFound = true;
+		}
 		// End Tissue model arguments =======================================//|
 
 		// Spatial cell models ==============================================\\|
@@ -2108,7 +2706,15 @@ void set_arguments(int Narg, char *argin[], Argument_parameters *A, char const *
 			printf("\tReference [text]\tResults_Reference [text]\tState_Reference_read [text]\tState_Reference_write [text]\tVclamp [On/Off]\t{Read/Write}_state [On/Off/phase/single_cell/ave] (phase for tissue 2D+ only; single_cell/ave for tissue models only)\n\n");
 			printf("[Simulation settings]:\n");
 			printf("\tBCL [x (ms)]\tTotal_time [x (ms)]\tPaced_time [x (ms)]\tNBeats [n]\tdt [x (ms)]\n");
-			printf("\tS2  [x (ms)]\tNS2 [n]\n\n");
+			printf("\tS2  [x (ms)]\tNS2 [n]\n");
+			printf("\tState_library [On/Off] (per-cell states in one indexed file; text state files are added on first read)\tState_library_BCL [exact/nearest]\n");
+			printf("\tS2_range [start ms] [end ms] [step ms] (single cell only; S1-S2 restitution and ERP, all S2 from one paced snapshot)\n");
+			printf("\tDynamic_BCLs [BCL1,BCL2,...] (single cell only; dynamic restitution in one run, each BCL paced to steady state or NBeats)\n");
+			printf("\tBatch_file [filename] (single cell only; one job's arguments per line, run concurrently)\tBatch_format [csv/binary]\n");
+			printf("\tPopulation [N] (single cell only; population of models)\tPopulation_sampling [uniform/lognormal/LHS]\tPopulation_currents [INa,ICaL,IKr,...]\n");
+			printf("\tPopulation_range [min] [max] (uniform/LHS)\tPopulation_sigma [x] (lognormal)\tPopulation_seed [n]\tCalibration_file [filename] (\"biomarker min max\" per line)\n");
+			printf("\tSteady_state [On/Off] (stop pacing at steady state)\tSS_tol_APD [x (ms)]\tSS_tol_{Ca/Nai} [x (relative)]\tSS_beats [n]\n");
+			printf("\tEarly_stop [On/Off] (tissue; stop after the last stimulus once quiescent or, 1D S1-S2, full conduction)\tEarly_stop_Vm [x (mV)]\tEarly_stop_active [x (fraction)]\tEarly_stop_quiescent [n (ms)]\n\n");
 			printf("[Model and cell conditions]:\n");
 			printf("\tModel [text]\tCelltype [text]\tAgent [text]\tRemodelling [text]\tISO [x (0-1uM)]\tISO_model [text]\n");
 			printf("\tACh [0-1]\tACh_model [text]\n");
@@ -2130,6 +2736,8 @@ void set_arguments(int Narg, char *argin[], Argument_parameters *A, char const *
 			{
 				printf("Additional tissue model options:\n");
 				printf("\tSpatial_output_interval_{vtk/data} [int ms]\t Spatial_output_range_{start/end} [int ms]\n");
+				printf("\tOutput_slice [XY/XZ/YZ] [position] [k] [interval ms]\tOutput_ROI [x0 x1 y0 y1 z0 z1] [k] [interval ms]\tOutput_decimated [k] [interval ms]\n");
+				printf("\tOutput_sink_range [start ms] [end ms] (applies to previous sink)\n");
 				printf("\tTissue_order	[1D/2D/3D/geo]\t Tissue_model [basic, ...]\t Tissue_type [homogeneous/heterogeneous]\n");
 				printf("\tOrientation_type [isotropic/anisotropic]\t D_uniformity [uniform/regional/map]\n");
                 printf("\tSpatial_output_interval_{vtk/data} [int ms]\n");
@@ -2143,6 +2751,19 @@ void set_arguments(int Narg, char *argin[], Argument_parameters *A, char const *
 				printf("\t{OX/OY/OZ} [double; 0-1]\tGlobal_orientation_direction [string: X/Y/Z/{XY/XZ/YZ}_plus/{XY/XZ/YZ}_minus/XYZ_{ppp/ppm/pmp/mpp}]\n");
 				printf("\t{ISO/ACh/Remodelling/Dscale_mod/D_AR_scale_mod/Direct_modulation}_map [On/Off]\n");
                 printf("\tmap_{x/y/z}_shape [cuboid/sphere] map_in_type [file/coords] map_{x/y/z}_loc [n] map_{x/y/z}_size [n]\n");
+				printf("\tInput_binary_write [On/Off] (reads/writes <file>.bin copies of geometry/map/fibre files; a copy is used only while it matches its text file)\n");
+				printf("\tState_format [text/binary] (whole tissue state files; Read_state/Write_state On)\n");
+				printf("\tCheckpoint_interval [int ms] (0 = off)\tRestart [On/Off] (continue from the checkpoint in the results directory; pass the same arguments)\n");
+				printf("\tTissue_cache [On/Off]\tTissue_cache_dir [string] (reuses geometry, neighbour, D and laplacian setup between runs)\n");
+				printf("\tStrand_file [filename] (1D; one strand per line of S2/S2_x_loc/NS2/modulation arguments, solved side by side)\n");
+				printf("\tVulnerability_window [On/Off]\tVW_S2_range [min ms] [max ms]\tVW_S2_step [ms]\tVW_precision [ms]\tVW_S2_x_locs [x1,x2,...] (1D; coarse scan then bisection from one snapshot)\n");
+				printf("\tBranch_file [filename] (one what-if scenario per line of ISO/ACh/modulation arguments, run from the tissue at Branch_time)\tBranch_time [x (ms)]\n");
+				printf("\tEvent_file [filename] (one modulation event per line: time [ramp x (ms) [ramp_step x (ms)]] ISO/ACh/modulation arguments; cumulative)\n");
+				printf("\tProtocol_file [filename] (one stimulus train per line: site [S1/S2/n] start [ms] duration [ms] amplitude [x] repeats [n] interval [ms] decrement [ms] interval_min [ms]; replaces S1/S2 pacing)\n");
+				printf("\tMeasurement [Full/Events] (Events: activation time and requested APDs only, updated at upstroke and level crossings)\tMeasurement_APD [p1,p2,... (%% repolarisation; multiples of 10)]\n");
+				printf("\tCV_map [On/Off] (per-node CV from activation-time gradients at the end of each beat; CV_output_n.bin and CV_map_summary.dat)\n");
+				printf("\tAPD_map [On/Off] (per-node APD30/50/90 or Measurement_APD levels, repolarisation time and dispersion of each beat, from one stimulus onset to the next)\tAPD_map_interval [n beats]\n");
+				printf("\tProbe_file [string]\tProbe_nodes [n,n,x:y:z,...]\tProbe_variables [Vm,Cai,INa,...]\tProbe_interval [x (ms)]\tProbe_buffer [n samples]\n");
 				printf("\t{stim/S2_stim/phase/Dscale_base_map/D_AR_scale_base_map/Dscale_mod_map/D_AR_scale_mod_map/ISO_map/ACh_map/remod_map/Direct_modulation_map/Spatial_gradient_map}_file [string]\n\n");
 			}
 
@@ -2185,3 +2806,53 @@ void set_arguments(int Narg, char *argin[], Argument_parameters *A, char const *
 }
 // End set arguments ==================================================================//|
 
+// Argument lines from file =====================================================================\\|
+// Batch (single cell) and strand (tissue) files: one job per line; each line is "Argument value" pairs as on the
+// command line, applied on top of the command-line arguments. Empty lines and lines starting with # are ignored
+int read_batch_file(const char *filename, std::vector<std::string> *jobs)
+{
+	FILE *in = fopen(filename, "r");
+	if (in == NULL)
+	{
+		printf("ERROR: File \"%s\" could not be found. Is it in this directory?\n", filename);
+		exit(1);
+	}
+	char line[5000];
+	while (fgets(line, 5000, in) != NULL)
+	{
+		if (strlen(line) == 4999 && line[4998] != '\n')
+		{
+			printf("ERROR: a line of \"%s\" is longer than 4998 characters\n", filename);
+			exit(1);
+		}
+		line[strcspn(line, "\r\n")] = 0;
+		const char *c = line + strspn(line, " \t");
+		if (*c == 0 || *c == '#') continue;
+		jobs->push_back(c);
+	}
+	fclose(in);
+	return (int)jobs->size();
+}
+
+// Copies the base (command-line) arguments and sets the job's own on top || tokens point into buffer, so buffer must outlive A
+void set_batch_job_arguments(Argument_parameters *A, Argument_parameters *A_base, const char *job, char *buffer, FILE *out, char const *Version)
+{
+	char *tokens[500];
+	int Ntokens = 1; // count from 1 for consistency with command line
+	tokens[0] = (char*)"batch";
+	strcpy(buffer, job);
+	char *save;
+	for (char *t = strtok_r(buffer, " \t", &save); t != NULL; t = strtok_r(NULL, " \t", &save))
+	{
+		if (Ntokens == 500)
+		{
+			printf("ERROR: \"%s\" has more than 499 arguments and values\n", job);
+			exit(1);
+		}
+		tokens[Ntokens++] = t;
+	}
+
+	memcpy(A, A_base, sizeof(Argument_parameters));
+	set_arguments(Ntokens, tokens, A, Version, out);
+}
+// End Argument lines from file =================================================================//|
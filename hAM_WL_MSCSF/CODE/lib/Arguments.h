@@ -69,8 +69,13 @@
 #define ARGUMENTS_H
 
 #include "Structs.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
 
 void set_argument_defaults(Argument_parameters *A);		// Sets all flags to default
 void call_argument_functions(int argc, char *argin[], Argument_parameters *A, char const *Version); // determines if settings file should be read in; calls next function
 void set_arguments(int Narg, char *argin[], Argument_parameters *A, char const * Version, FILE *out); // populates Argument_parameters struct from settings file or command-line arguments
+int read_batch_file(const char *filename, std::vector<std::string> *jobs); // lines of "Argument value" pairs (batch jobs, tissue strands)
+void set_batch_job_arguments(Argument_parameters *A, Argument_parameters *A_base, const char *job, char *buffer, FILE *out, char const *Version); // base arguments with one line on top
 #endif
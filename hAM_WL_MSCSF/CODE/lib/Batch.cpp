@@ -0,0 +1,575 @@
+// Source code associated with  ===========================  //
+// "Multi-scale cardiac simulation framework" =============  //
+// For simulation of cardiac cellular and tissue dynamics =  //
+// from the spatial cellular to full organ scales. ========  //
+// With implementation of multiple, published cell models =  //
+// as well as novel models developed in my lab. ===========  //
+// ========================================================  //
+// This file: Batched single-cell runs: many ==============  //
+// parameter sets and protocols in one process, ===========  //
+// run concurrently over OpenMP threads. ==================  //
+// ========================================================  //
+// GNU 3 LICENSE TEXT =====================================  //
+// COPYRIGHT (C) 2016-2019 MICHAEL A. COLMAN ==============  //
+// THIS PROGRAM IS FREE SOFTWARE: YOU CAN REDISTRIBUTE IT =  //
+// AND/OR MODIFY IT UNDER THE TERMS OF THE GNU GENERAL ====  //
+// PUBLIC LICENSE AS PUBLISHED BY THE FREE SOFTWARE =======  //
+// FOUNDATION, EITHER VERSION 3 OF THE LICENSE, OR (AT YOUR  //
+// OPTION) ANY LATER VERSION. =============================  //
+// THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE=  //
+// USEFUL, BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE =====  //
+// IMPLIED WARRANTY OF MERCHANTABILITY OR FITNESS FOR A ===  //
+// PARTICULAR PURPOSE.  SEE THE GNU GENERAL PUBLIC LICENSE=  //
+// FOR MORE DETAILS. ======================================  //
+// YOU SHOULD HAVE RECEIVED A COPY OF THE GNU GENERAL =====  //
+// PUBLIC LICENSE ALONG WITH THIS PROGRAM.  IF NOT, SEE ===  //
+// <https://www.gnu.org/licenses/>. =======================  //
+// ========================================================  //
+// ADDITIONAL LICENSE TEXT ================================  //
+// THIS SOFTWARE IS PROVIDED OPEN SOURCE AND MAY BE FREELY=  //
+// USED, DISTRIBUTED AND UPDATED, PROVIDED: ===============  //
+//  (i) THE APPROPRIATE WORK(S) IS(ARE) CITED. THIS =======  //
+//      PERTAINS TO THE CITATION OF COLMAN 2019 PLOS COMP =  //
+//      BIOL (FOR THIS IMPLEMTATION) AND ALL WORKS ========  //
+//      ASSOCIATED WITH THE SPECIFIC MODELS AND COMPONENTS=  //
+//      USED IN PARTICULAR SIMULATIONS. IT IS THE USER'S ==  //
+//      RESPONSIBILITY TO ENSURE ALL RELEVANT WORKS ARE ===  //
+//      CITED. PLEASE SEE FULL DOCUMENTATION AND ON-SCREEN=  //
+//      DISCLAIMER OUTPUTS FOR A GUIDE. ===================  //
+//  (ii) ALL OF THIS TEXT IS RETAINED WITHIN OR ASSOCIATED=  //
+//      WITH THE SOURCE CODE AND/OR BINARY FORM OF THE ====  //
+//      SOFTWARE. =========================================  //
+// ========================================================  //
+// ANY INTENDED COMMERCIAL USE OF THIS SOFTWARE MUST BE BY   //
+// EXPRESS PERMISSION OF MICHAEL A COLMAN ONLY. IN NO EVENT  //
+// ARE THE COPYRIGHT HOLDERS LIABLE FOR ANY DIRECT, =======  //
+// INDIRECT INCIDENTAL, SPECIAL, EXEMPLARY OR CONSEQUENTIAL  //
+// DAMAGES ASSOCIATED WITH USE OF THIS SOFTWARE ===========  //
+// ========================================================  //
+// THIS SOFTWARE CONTAINS IMPLEMENTATIONS OF MODELS AND ===  //
+// COMPONENTS WHICH I (MICHAEL COLMAN) DID NOT DEVELOP.====  //
+// ALL OF THESE COMPONENTS HAVE BEEN CODED FROM PROVIDED ==  //
+// SOURCE CODE OR INFORMATION IN THE PUBLICATIONS. ========  //
+// I CLAIM NO RIGHTS OR INTELLECTUAL PROPERTY OWNERSHIP ===  //
+// FOR THESE MODELS AND COMPONENTS, OTHER THAN THEIR ======  //
+// SPECIFIC IMPLEMENTATION IN THIS CODE PACKAGE. FURTHER TO  //
+// THE ABOVE STATEMENT, ANY INDTENDED COMMERCIAL USE OF ===  //
+// THOSE COMPONENTS MUST BE BY EXPRESS PERMISSION OF THE ==  //
+// ORIGINAL COPYRIGHT HOLDERS. ============================  //
+// WHERE IMPLEMENTED FROM PROVIDED CODE, ANY DISCLAIMERS ==  //
+// PRESENT IN THE ORIGINAL CODE HAVE BEEN RETAINED IN THE =  //
+// RELEVANT FILE. =========================================  //
+// ========================================================  //
+// Contact: m.a.colman@leeds.ac.uk ========================  //
+// For updates, corrections etc, please check: ============  //
+// 1. http://physicsoftheheart.com/ =======================  //
+// 2. https://github.com/michaelcolman ====================  //
+// ========================================================  //
+
+#include "Batch.h"
+#include "Structs.h"
+#include "Arguments.h"
+#include "Initialisation.h"
+#include "Model.h"
+#include "Read_write_state.h"
+#include "Outputs.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <omp.h>
+
+// Function list ================================================================================\\|
+//	set_single_cell_native()
+//	initialise_single_cell_native()
+//	step_single_cell_native()
+//	single_cell_time_loop()
+//	run_single_cell_native()
+//	write_batch_results()
+//	run_single_cell_batch()
+//	
+//	Population of models
+//	    sample_population()
+//	    read_calibration_file()
+//	    run_population_of_models()
+// End Function list ============================================================================//|
+
+// Result table columns (one row per job) || Ca2+ in uM as Properties_log.dat
+static const char *batch_columns[] = {"job", "BCL", "S2_CL", "NBeats", "APD_t", "APD30", "APD50", "APD70", "APD90", "APD90_prev",
+									  "dvdt_max", "Vmin", "Vmax", "Vamp", "CaT_min", "CaT_max", "CaSR_min", "CaSR_max"};
+static const int Nbatch_columns = sizeof(batch_columns)/sizeof(char*);
+
+// Single cell setup and run ====================================================================\\|
+// Simulation settings and full parameter set from arguments || used by Single_cell_native_main.cc and all batch modes
+void set_single_cell_native(Argument_parameters *A, Simulation_parameters *Sim, Cell_parameters *Params)
+{
+	set_simulation_defaults(Sim, 0.02);						// lib/Initialisation.c
+	set_simulation_settings(Sim, *A, "native");				// lib/Initialisation.c
+
+	set_model_conditions(Params, *A);						// lib/Initialisation.c
+	set_model_group_variables(Params, *A);					// lib/Initialisation.c
+
+	// Check Model is appropriate for this code version || add your new model clause here so it doesn't return an error
+	if      (strcmp(Params->Model, "minimal") == 0);		// hybrid minimal model; Colman 2019
+	else if (strcmp(Params->Model, "hAM_GB") == 0);			// human atrial cell; Grandi et al 2011 Circ Res 2011; 109(9):1055-66
+	else if (strcmp(Params->Model, "hAM_CRN") == 0);		// human atrial cell; Courtemanche et al 1998 Am J Physiol 1998; 275(1 Pt 2):H301-21.
+	else if (strcmp(Params->Model, "hAM_NG") == 0);			// human atrial cell; Nygren et al 1998 Circ Res 1998;82(1):63-81
+	else if (strcmp(Params->Model, "hAM_MT") == 0);			// human atrial cell; Maleckar et al 2009  Am. J. Physiol Heart Circ Physiol 2009;297(4):H1398-410
+	else if (strcmp(Params->Model, "hAM_WL_CRN") == 0);		// human atrial cell; Colman et al 2018 Front Physiol 9:1211; CRN Ca2+ handling
+	else if (strcmp(Params->Model, "hAM_WL_GB") == 0);		// human atrial cell; Colman et al 2018 Front Physiol 9:1211; GB Ca2+ handling
+	else if (strcmp(Params->Model, "hAM_GB_mWL") == 0);		// human atrial cell; Colman et al 2018 Front Physiol 9:1211; GB modified
+	else if (strcmp(Params->Model, "hAM_CRN_mWL") == 0);	// human atrial cell; Colman et al 2018 Front Physiol 9:1211; CRN modified
+	else if (strcmp(Params->Model, "hAM_NG_mWL") == 0);		// human atrial cell; Colman et al 2018 Front Physiol 9:1211; NG modified
+	else if (strcmp(Params->Model, "dAM_VA") == 0);			// dog atrial cell; Varela et al 2016 PLOS Computational Biology 12(12): e1005245
+	else if (strcmp(Params->Model, "hAM_GB_modded") == 0);	// human atrial cell; Grandi et al 2011 Circ Res 2011; 109(9):1055-66 MODDED
+	else
+	{
+		printf("ERROR: \"%s\" is not a valid Model selection for this code version\n", Params->Model);
+		exit(1);
+	}
+
+	set_default_parameters(Params);							// lib/Initialisation.c
+	Params->dt = Sim->dt;
+	set_parameters_native(Params, Params->Model);			// lib/Model.c
+
+	if (A->Celltype_arg 	== true)	Params->Celltype 	= A->Celltype; 
+	if (A->ISO_model_arg 	== true)	Params->ISO_model 	= A->ISO_model; 
+	if (A->ACh_model_arg 	== true)	Params->ACh_model	= A->ACh_model; 
+	if (A->Ihyp_arg 		== true)	Params->AIhyp		= A->AIhyp;
+	if (A->dt_arg 			== false && Params->dt != Sim->dt) Sim->dt = Params->dt;
+
+	set_modification_defaults_native(Params);				// lib/Initialisation.c
+	assign_modification_from_arguments(Params, *A);			// lib/Initialisation.c
+	set_heterogeneity_and_modulation_native(Params);		// lib/Model.c
+	Params->GCaL *= Params->GLTCC_kva1_va2;
+	Params->Grel *= Params->GRyR_kCO;
+}
+
+// Stimulus, initial conditions, measurement variables and (if set) state read
+void initialise_single_cell_native(Simulation_parameters *Sim, Cell_parameters *Params, const char *PATH, State_variables *State, Model_variables *Variables, double *Vm)
+{
+	stimulus_setup(*Params, Variables, Sim->dt, Sim->BCL, Sim->S2_CL, Sim->Paced_time);	// lib/Model.c
+	initial_conditions_native(State, *Params, Params->Model);							// lib/Model.c
+	initialise_measurement_variables(Variables);										// lib/Initialisation.c
+	if (strcmp(Sim->Read_state, "On") == 0)
+	{
+		if (strcmp(Sim->State_library, "On") == 0) Read_state_library(State, *Params, Sim->BCL, PATH, Params->Model, "single_cell", 0, Sim->state_reference_read, strcmp(Sim->State_library_BCL, "nearest") == 0); // lib/Read_write_state.c
+		else Read_state_single_cell_native(State, *Params, Sim->BCL, PATH, Params->Model, Sim->state_reference_read); // lib/Read_write_state.c
+	}
+	*Vm = State->Vm;
+}
+
+// One time step || stimulus, model, voltage update and measurements
+void step_single_cell_native(Simulation_parameters *Sim, Cell_parameters *Params, Model_variables *Variables, State_variables *State, double *Vm, double sim_time, int iteration_counter)
+{
+	compute_Istim(*Params, Variables, Sim->Paced_time, Sim->S2_time, sim_time, iteration_counter);					// lib/Model.c
+	compute_model_native(*Params, Variables, State, *Vm, Sim->dt);													// lib/Model.c
+	State->Vm	= State->Vm + Sim->dt*(-(Variables->Itot + Variables->Istim + Variables->Istim_S2));
+	determine_excitation_state(Variables, *Vm, sim_time);															// lib/Model.c
+	calculate_measurement_properties(Variables, *Vm, State->Vm, sim_time, Sim->dt, -70, State->Cai, State->CanSR);	// lib/Model.c
+	*Vm			= State->Vm;
+}
+
+// Time loop || per-ms outputs and progress are written when out_cu and out_ex are passed (NULL in batch modes).
+// Pacing stops at the end of the beat in which steady state is detected; returns the number of steps completed
+int single_cell_time_loop(Simulation_parameters *Sim, Cell_parameters *Params, State_variables *State, Model_variables *Variables, double *Vm, Steady_state_monitor *Steady, std::ostream *out_cu, std::ostream *out_ex, double *sim_time_end)
+{
+	steady_state_setup(Steady, *Sim);						// lib/Model.c
+	bool steady_state_on	= (strcmp(Sim->Steady_state, "On") == 0);
+	int  BCL_int			= Sim->BCL * (int)(1/Sim->dt);
+
+	int iteration_counter = 0;
+	double sim_time;
+	for (sim_time = 0.0; sim_time <= (float)Sim->Total_time; sim_time += Sim->dt)
+	{
+		step_single_cell_native(Sim, Params, Variables, State, Vm, sim_time, iteration_counter);
+
+		// Beat-to-beat convergence, checked at each paced excitation
+		if (steady_state_on == true && Variables->t_ex == sim_time && sim_time < Sim->Paced_time) steady_state_check(Steady, *Variables, State->Nai); // lib/Model.c
+
+		// Output data to files
+		if (out_cu != NULL && iteration_counter%(int)(1/Sim->dt) == 0) // if sim_time is an integer (i.e. per ms)
+		{
+			output_currents(*out_cu, sim_time, *Variables, *State, *Vm);		// lib/Outputs.cpp || V, currents, gating variables, concs etc
+			output_excitation_properties(*out_ex, sim_time, *Variables, *Vm);	// lib/Outputs.cpp || APD, excitation state, dv/dt etc
+		}
+
+		iteration_counter++; // number of steps in dt
+		if (out_cu != NULL && iteration_counter%(2000*((int)(1/Sim->dt))) == 0) printf("Time = %.0fms\n",sim_time); // output every 2000 ms
+
+		if (Steady->converged == true && iteration_counter%BCL_int == 0) break;
+	}
+	if (sim_time_end != NULL) *sim_time_end = sim_time;
+	return iteration_counter;
+}
+
+// Runs one cell with no per-ms outputs; fills one result row
+void run_single_cell_native(Simulation_parameters Sim, Cell_parameters Params, const char *PATH, double *row)
+{
+	State_variables		State;
+	Model_variables		Variables;
+	double				Vm;
+	initialise_single_cell_native(&Sim, &Params, PATH, &State, &Variables, &Vm);
+
+	Steady_state_monitor Steady;
+	int BCL_int				= Sim.BCL * (int)(1/Sim.dt);
+	int iteration_counter	= single_cell_time_loop(&Sim, &Params, &State, &Variables, &Vm, &Steady, NULL, NULL, NULL);
+
+	if (strcmp(Sim.Write_state, "On") == 0)
+	{
+		if (strcmp(Sim.State_library, "On") == 0) Write_state_library(State, Params, Sim.BCL, PATH, Params.Model, "single_cell", 0, Sim.state_reference_write); // lib/Read_write_state.c
+		else Write_state_single_cell_native(State, Params, Sim.BCL, PATH, Params.Model, Sim.state_reference_write); // lib/Read_write_state.c
+	}
+
+	// Final beat properties || columns as batch_columns (from 1; 0 is the job index)
+	row[1]	= Sim.BCL;
+	row[2]	= Sim.S2_CL;
+	row[3]	= (Steady.converged == true) ? iteration_counter/BCL_int : Sim.NBeats;
+	row[4]	= Variables.APD_t;
+	row[5]	= Variables.APD_p[2];
+	row[6]	= Variables.APD_p[4];
+	row[7]	= Variables.APD_p[6];
+	row[8]	= Variables.APD_p[8];
+	row[9]	= Variables.APD_p_prev[8];
+	row[10]	= Variables.dvdt_max;
+	row[11]	= Variables.Vmin_prev;
+	row[12]	= Variables.Vmax;
+	row[13]	= Variables.Vamp;
+	row[14]	= 1e3*Variables.CaT_min;
+	row[15]	= 1e3*Variables.CaT_max;
+	row[16]	= Variables.CaSR_min;
+	row[17]	= Variables.CaSR_max;
+}
+// End Single cell setup and run ================================================================//|
+
+// Results table ================================================================================\\|
+// csv: header line then one row per job, with the job's arguments as the last column
+// binary: "MSCSFBR1", Njobs, Ncolumns, column names (32 chars each), then Njobs*Ncolumns doubles
+void write_batch_results(const char *directory, const char *format, double *results, int Njobs, std::vector<std::string> *jobs)
+{
+	char filename[500];
+	if (strcmp(format, "binary") == 0)
+	{
+		sprintf(filename, "%s/Batch_results.bin", directory);
+		FILE *out = fopen(filename, "wb");
+		if (out == NULL)
+		{
+			printf("ERROR: Cannot create %s\n", filename);
+			exit(1);
+		}
+		int sizes[2] = {Njobs, Nbatch_columns};
+		char name[32];
+		fwrite("MSCSFBR1", 1, 8, out);
+		fwrite(sizes, sizeof(int), 2, out);
+		for (int c = 0; c < Nbatch_columns; c++)
+		{
+			memset(name, 0, 32);
+			strncpy(name, batch_columns[c], 31);
+			fwrite(name, 1, 32, out);
+		}
+		fwrite(results, sizeof(double), (size_t)Njobs*Nbatch_columns, out);
+		fclose(out);
+	}
+	else
+	{
+		sprintf(filename, "%s/Batch_results.csv", directory);
+		FILE *out = fopen(filename, "w");
+		if (out == NULL)
+		{
+			printf("ERROR: Cannot create %s\n", filename);
+			exit(1);
+		}
+		for (int c = 0; c < Nbatch_columns; c++) fprintf(out, "%s,", batch_columns[c]);
+		fprintf(out, "arguments\n");
+		for (int j = 0; j < Njobs; j++)
+		{
+			fprintf(out, "%d", j);
+			for (int c = 1; c < Nbatch_columns; c++) fprintf(out, ",%g", results[(size_t)j*Nbatch_columns + c]);
+			fprintf(out, ",\"%s\"\n", (*jobs)[j].c_str());
+		}
+		fclose(out);
+	}
+	printf("Batch results written to %s\n", filename);
+}
+// End Results table ============================================================================//|
+
+// Batch run ====================================================================================\\|
+void run_single_cell_batch(Argument_parameters *Argin, const char *PATH, const char *directory)
+{
+	std::vector<std::string> jobs;
+	int Njobs = read_batch_file(Argin->Batch_file, &jobs); // lib/Arguments.c
+	printf("Batch file %s read in; %d jobs\n", Argin->Batch_file, Njobs);
+
+	// Check all job arguments and models before running any (errors exit) and log them
+	char filename[500];
+	sprintf(filename, "%s/Batch_arguments.dat", directory);
+	FILE *log = fopen(filename, "w");
+	if (log == NULL)
+	{
+		printf("ERROR: Cannot create %s\n", filename);
+		exit(1);
+	}
+	Argument_parameters *A	= new Argument_parameters;
+	char *buffer			= new char[5000];
+	Simulation_parameters	Sim_check;
+	Cell_parameters			Params_check;
+	std::map<std::string, int> state_targets;	// jobs run concurrently, so no two may write the same state
+	char target[1000];
+	for (int j = 0; j < Njobs; j++)
+	{
+		fprintf(log, "%d\t", j);
+		set_batch_job_arguments(A, Argin, jobs[j].c_str(), buffer, log, "Single_cell_native"); // lib/Arguments.c
+		set_single_cell_native(A, &Sim_check, &Params_check);
+		if (strcmp(Sim_check.Vclamp, "On") == 0)
+		{
+			printf("ERROR: batch job %d (\"%s\") sets Vclamp On, which is not run in batch mode\n", j, jobs[j].c_str());
+			exit(1);
+		}
+		if (strcmp(Sim_check.Write_state, "On") == 0)
+		{
+			State_write_target_single_cell(target, Params_check, Sim_check.BCL, PATH, Params_check.Model, Sim_check.state_reference_write, strcmp(Sim_check.State_library, "On") == 0); // lib/Read_write_state.c
+			if (state_targets.count(target) > 0)
+			{
+				printf("ERROR: batch jobs %d and %d would both write the state %s; set a different State_ref_write for each job or Write_state Off\n", state_targets[target], j, target);
+				exit(1);
+			}
+			state_targets[target] = j;
+		}
+		fprintf(log, "\n");
+	}
+	fclose(log);
+	delete A;
+	delete [] buffer;
+
+	// Run jobs || dynamic schedule as run times vary with protocol
+	double *results = new double[(size_t)Njobs*Nbatch_columns];
+	int Ndone = 0;
+	printf("Running %d jobs on %d threads\n", Njobs, omp_get_max_threads());
+	#pragma omp parallel
+	{
+		Argument_parameters *A_job	= new Argument_parameters;
+		char *job_buffer			= new char[5000];
+		FILE *sink					= fopen("/dev/null", "w"); // job arguments were logged above
+		#pragma omp for schedule(dynamic)
+		for (int j = 0; j < Njobs; j++)
+		{
+			Simulation_parameters	Sim;
+			Cell_parameters			Params;
+			set_batch_job_arguments(A_job, Argin, jobs[j].c_str(), job_buffer, sink, "Single_cell_native"); // lib/Arguments.c
+			set_single_cell_native(A_job, &Sim, &Params);
+			results[(size_t)j*Nbatch_columns] = j;
+			run_single_cell_native(Sim, Params, PATH, &results[(size_t)j*Nbatch_columns]);
+
+			#pragma omp critical(batch_progress)
+			{
+				Ndone++;
+				if (Ndone%(Njobs/10 > 0 ? Njobs/10 : 1) == 0) printf("\t%d/%d jobs complete\n", Ndone, Njobs);
+			}
+		}
+		fclose(sink);
+		delete A_job;
+		delete [] job_buffer;
+	}
+
+	write_batch_results(directory, Argin->Batch_format_arg == true ? Argin->Batch_format : "csv", results, Njobs, &jobs);
+	delete [] results;
+}
+// End Batch run ================================================================================//|
+
+// Population of models =========================================================================\\|
+// Scale factors sampled for N members, applied to the final (multiplicative) current and flux modifiers so that
+// a factor x is equivalent to passing {X}_scale x on top of any other modification
+typedef struct{
+	const char	*name;
+	size_t		offset;
+}Population_current;
+
+static const Population_current population_currents[] = {
+	{"INa", offsetof(Cell_parameters, GNa)},		{"INaL", offsetof(Cell_parameters, GNaL)},
+	{"Ito", offsetof(Cell_parameters, Gto)},		{"ICaL", offsetof(Cell_parameters, GCaL)},
+	{"IKur", offsetof(Cell_parameters, GKur)},		{"IKr", offsetof(Cell_parameters, GKr)},
+	{"IKs", offsetof(Cell_parameters, GKs)},		{"IK1", offsetof(Cell_parameters, GK1)},
+	{"INCX", offsetof(Cell_parameters, GNCX)},		{"ICaP", offsetof(Cell_parameters, GCaP)},
+	{"INab", offsetof(Cell_parameters, GNab)},		{"ICab", offsetof(Cell_parameters, GCab)},
+	{"IKb", offsetof(Cell_parameters, GKb)},		{"INaK", offsetof(Cell_parameters, GNaK)},
+	{"IClCa", offsetof(Cell_parameters, GClCa)},	{"IClb", offsetof(Cell_parameters, GClb)},
+	{"IKACh", offsetof(Cell_parameters, GKACh)},	{"Jup", offsetof(Cell_parameters, Gup)},
+	{"Jleak", offsetof(Cell_parameters, Gleak)},	{"Jrel", offsetof(Cell_parameters, Grel)}
+};
+static const int Npopulation_currents = sizeof(population_currents)/sizeof(Population_current);
+
+// splitmix64 || small, seedable and identical on every platform, so a seed always gives the same population
+static double population_uniform(unsigned long long *state)
+{
+	unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	z = z ^ (z >> 31);
+	return ((z >> 11) + 0.5) * (1.0/9007199254740992.0); // (0,1)
+}
+
+// scales[m*Ncurrents + c] for N members || uniform and LHS over [min, max]; lognormal with median 1
+void sample_population(Argument_parameters *Argin, int *current_index, int Ncurrents, double *scales)
+{
+	int N				= Argin->Population;
+	const char *type	= (Argin->Population_sampling_arg == true) ? Argin->Population_sampling : "LHS";
+	double min			= (Argin->Population_range_arg == true) ? Argin->Population_min : 0.5;
+	double max			= (Argin->Population_range_arg == true) ? Argin->Population_max : 1.5;
+	double sigma		= (Argin->Population_sigma_arg == true) ? Argin->Population_sigma : 0.2;
+	unsigned long long state = (Argin->Population_seed_arg == true) ? Argin->Population_seed : 1;
+
+	if (strcmp(type, "LHS") == 0) // one sample in each of N equal strata per current; strata randomly paired between currents
+	{
+		int *strata = new int[N];
+		for (int c = 0; c < Ncurrents; c++)
+		{
+			for (int m = 0; m < N; m++) strata[m] = m;
+			for (int m = N-1; m > 0; m--) // Fisher-Yates
+			{
+				int k = (int)(population_uniform(&state)*(m+1));
+				if (k > m) k = m;
+				int t = strata[m]; strata[m] = strata[k]; strata[k] = t;
+			}
+			for (int m = 0; m < N; m++) scales[m*Ncurrents + c] = min + (max - min)*(strata[m] + population_uniform(&state))/N;
+		}
+		delete [] strata;
+	}
+	else if (strcmp(type, "lognormal") == 0) // Box-Muller
+	{
+		for (int m = 0; m < N; m++) for (int c = 0; c < Ncurrents; c++)
+		{
+			double z = sqrt(-2.0*log(population_uniform(&state))) * cos(2.0*M_PI*population_uniform(&state));
+			scales[m*Ncurrents + c] = exp(sigma*z);
+		}
+	}
+	else for (int m = 0; m < N; m++) for (int c = 0; c < Ncurrents; c++) scales[m*Ncurrents + c] = min + (max - min)*population_uniform(&state);
+}
+
+// Calibration ranges || "biomarker min max" per line, biomarker being a result column name or CaT_amp; returns number of ranges
+int read_calibration_file(const char *filename, int *column, double *min, double *max)
+{
+	FILE *in = fopen(filename, "r");
+	if (in == NULL)
+	{
+		printf("ERROR: Calibration file \"%s\" could not be found. Is it in this directory?\n", filename);
+		exit(1);
+	}
+	char name[100];
+	int Nranges = 0;
+	while (Nranges < 50 && fscanf(in, "%99s %lf %lf", name, &min[Nranges], &max[Nranges]) == 3)
+	{
+		column[Nranges] = -1;
+		for (int c = 4; c < Nbatch_columns; c++) if (strcmp(name, batch_columns[c]) == 0) column[Nranges] = c;
+		if (strcmp(name, "CaT_amp") == 0) column[Nranges] = Nbatch_columns; // derived column
+		if (column[Nranges] == -1)
+		{
+			printf("ERROR: \"%s\" in %s is not a biomarker. Use APD_t, APD30/50/70/90, APD90_prev, dvdt_max, Vmin, Vmax, Vamp, CaT_min, CaT_max, CaT_amp, CaSR_min or CaSR_max\n", name, filename);
+			exit(1);
+		}
+		Nranges++;
+	}
+	fclose(in);
+	return Nranges;
+}
+
+void run_population_of_models(Argument_parameters *Argin, const char *PATH, const char *directory)
+{
+	// Currents to sample
+	int current_index[Npopulation_currents];
+	int Ncurrents = 0;
+	char list[1000];
+	strncpy(list, (Argin->Population_currents_arg == true) ? Argin->Population_currents : "INa,Ito,ICaL,IKur,IKr,IKs,IK1,INCX,INaK,Jup,Jrel", 999);
+	list[999] = 0;
+	char *save;
+	for (char *t = strtok_r(list, ",", &save); t != NULL; t = strtok_r(NULL, ",", &save))
+	{
+		int index = -1;
+		for (int c = 0; c < Npopulation_currents; c++) if (strcmp(t, population_currents[c].name) == 0) index = c;
+		if (index == -1)
+		{
+			printf("ERROR: \"%s\" is not a valid Population_currents entry; use the names of the {X}_scale arguments (INa, ICaL, IKr, Jup, ...)\n", t);
+			exit(1);
+		}
+		if (Ncurrents < Npopulation_currents) current_index[Ncurrents++] = index;
+	}
+
+	int N = Argin->Population;
+	double *scales = new double[(size_t)N*Ncurrents];
+	sample_population(Argin, current_index, Ncurrents, scales);
+
+	int column[50];
+	double cal_min[50], cal_max[50];
+	int Nranges = (Argin->Calibration_file_arg == true) ? read_calibration_file(Argin->Calibration_file, column, cal_min, cal_max) : 0;
+
+	// Base settings and parameters (identical for all members)
+	Simulation_parameters	Sim;
+	Cell_parameters			Params;
+	set_single_cell_native(Argin, &Sim, &Params);
+	if (strcmp(Sim.Write_state, "Off") != 0)
+	{
+		printf("WARNING: Write_state is ignored for population members (all would write the same state file)\n");
+		Sim.Write_state = "Off";
+	}
+	printf("Population of %d models; %d scale factors each\n", N, Ncurrents);
+
+	// Run members
+	double *results = new double[(size_t)N*Nbatch_columns];
+	int Ndone = 0;
+	#pragma omp parallel for schedule(dynamic)
+	for (int m = 0; m < N; m++)
+	{
+		Cell_parameters Params_m = Params;
+		for (int c = 0; c < Ncurrents; c++) *(double*)((char*)&Params_m + population_currents[current_index[c]].offset) *= scales[(size_t)m*Ncurrents + c];
+		results[(size_t)m*Nbatch_columns] = m;
+		run_single_cell_native(Sim, Params_m, PATH, &results[(size_t)m*Nbatch_columns]);
+
+		#pragma omp critical(batch_progress)
+		{
+			Ndone++;
+			if (Ndone%(N/10 > 0 ? N/10 : 1) == 0) printf("\t%d/%d members complete\n", Ndone, N);
+		}
+	}
+
+	// Results || member, scale factors, biomarkers, CaT amplitude and calibration
+	char filename[500];
+	sprintf(filename, "%s/Population_results.csv", directory);
+	FILE *out = fopen(filename, "w");
+	if (out == NULL)
+	{
+		printf("ERROR: Cannot create %s\n", filename);
+		exit(1);
+	}
+	fprintf(out, "member");
+	for (int c = 0; c < Ncurrents; c++) fprintf(out, ",%s_scale", population_currents[current_index[c]].name);
+	for (int c = 4; c < Nbatch_columns; c++) fprintf(out, ",%s", batch_columns[c]);
+	fprintf(out, ",CaT_amp,accepted\n");
+	int Naccepted = 0;
+	for (int m = 0; m < N; m++)
+	{
+		double *row		= &results[(size_t)m*Nbatch_columns];
+		double CaT_amp	= row[15] - row[14];
+		bool accepted	= true;
+		for (int r = 0; r < Nranges; r++)
+		{
+			double value = (column[r] == Nbatch_columns) ? CaT_amp : row[column[r]];
+			if (!(value >= cal_min[r] && value <= cal_max[r])) accepted = false;
+		}
+		if (accepted == true) Naccepted++;
+
+		fprintf(out, "%d", m);
+		for (int c = 0; c < Ncurrents; c++) fprintf(out, ",%g", scales[(size_t)m*Ncurrents + c]);
+		for (int c = 4; c < Nbatch_columns; c++) fprintf(out, ",%g", row[c]);
+		fprintf(out, ",%g,%d\n", CaT_amp, (accepted == true) ? 1 : 0);
+	}
+	fclose(out);
+	printf("Population results written to %s\n", filename);
+	if (Nranges > 0) printf("%d of %d members accepted by calibration (%d biomarker ranges)\n", Naccepted, N, Nranges);
+
+	delete [] scales;
+	delete [] results;
+}
+// End Population of models =====================================================================//|
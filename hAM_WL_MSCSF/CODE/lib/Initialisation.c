@@ -111,7 +111,22 @@ void set_simulation_defaults(Simulation_parameters *sim, double dt)
 	sim->Spatial_output_interval_data   = 5;	// 5 ms is default
     sim->Spatial_output_start_time      = 0;    
     sim->Spatial_output_end_time        = sim->Total_time;
-
+	sim->N_output_sinks                 = 0;    // no slice/ROI outputs
+
+	sim->State_format       = "text";   // whole tissue state files
+	sim->Checkpoint_interval = 0;        // no checkpoints
+	sim->Restart            = "Off";
+	sim->State_library      = "Off";
+	sim->State_library_BCL  = "exact";
+	sim->Steady_state       = "Off";
+	sim->SS_tol_APD         = 0.1;      // ms
+	sim->SS_tol_Ca          = 1e-3;     // relative
+	sim->SS_tol_Nai         = 1e-5;     // relative; Nai drifts slowly
+	sim->SS_beats           = 3;
+	sim->Early_stop         = "Off";
+	sim->Early_stop_Vm      = -60;      // mV
+	sim->Early_stop_active  = 0.0;      // no node active
+	sim->Early_stop_quiescent = 10;     // ms
 	sim->Delayed_CaSR_IC    = "Off";
 	sim->CaSR_IC_delay      = 1000; // ms
 	sim->CaSR_set           = false;
@@ -184,6 +199,24 @@ void set_simulation_settings(Simulation_parameters *sim, Argument_parameters A,
 	// Read/Write state
 	sim->Write_state	= A.Write_state;
 	sim->Read_state		= A.Read_state;
+	if (A.State_format_arg == true) sim->State_format = A.State_format;
+	if (A.Checkpoint_interval_arg == true) sim->Checkpoint_interval = A.Checkpoint_interval;
+	if (A.Restart_arg == true) sim->Restart = A.Restart;
+	if (A.State_library_arg == true) sim->State_library = A.State_library;
+	if (A.State_library_BCL_arg == true) sim->State_library_BCL = A.State_library_BCL;
+
+	// Steady-state detection
+	if (A.Steady_state_arg == true) sim->Steady_state = A.Steady_state;
+	if (A.SS_tol_APD_arg == true) sim->SS_tol_APD = A.SS_tol_APD;
+	if (A.SS_tol_Ca_arg == true) sim->SS_tol_Ca = A.SS_tol_Ca;
+	if (A.SS_tol_Nai_arg == true) sim->SS_tol_Nai = A.SS_tol_Nai;
+	if (A.SS_beats_arg == true) sim->SS_beats = A.SS_beats;
+
+	// Early termination
+	if (A.Early_stop_arg == true) sim->Early_stop = A.Early_stop;
+	if (A.Early_stop_Vm_arg == true) sim->Early_stop_Vm = A.Early_stop_Vm;
+	if (A.Early_stop_active_arg == true) sim->Early_stop_active = A.Early_stop_active;
+	if (A.Early_stop_quiescent_arg == true) sim->Early_stop_quiescent = A.Early_stop_quiescent;
 
 	// Spatial output interval
 	if (A.SOI_arg 	== true) 	sim->Spatial_output_interval_vtk 	= A.SOI;
@@ -191,6 +224,15 @@ void set_simulation_settings(Simulation_parameters *sim, Argument_parameters A,
     if (A.SORs_arg  == true)    sim->Spatial_output_start_time      = A.SORs;
     if (A.SORe_arg  == true)    sim->Spatial_output_end_time        = A.SORe;
 
+	// Output sinks || sinks without their own range take the global spatial output range
+	sim->N_output_sinks = A.N_output_sinks;
+	for (int i = 0; i < A.N_output_sinks; i++)
+	{
+		sim->output_sink[i] = A.output_sink[i];
+		if (sim->output_sink[i].start_time < 0) sim->output_sink[i].start_time 	= sim->Spatial_output_start_time;
+		if (sim->output_sink[i].end_time   < 0) sim->output_sink[i].end_time 	= sim->Spatial_output_end_time;
+	}
+
 	// Delayed CaSR IC functionality
 	if (A.Delayed_CaSR_IC_arg == true) 	sim->Delayed_CaSR_IC 	= A.Delayed_CaSR_IC;
 	if (A.CaSR_IC_delay_arg == true)	sim->CaSR_IC_delay		= A.CaSR_IC_delay;
@@ -104,6 +104,8 @@
 //	determine_excitation_state_integrated_0D()
 //	calculate_flux_integrals()
 //	calculate_measurement_properties()
+//	steady_state_setup()
+//	steady_state_check()
 //	
 //	run_voltage_clamp()
 //	
@@ -1169,6 +1171,45 @@ void calculate_measurement_properties(Model_variables *var, double Vm1, double V
 	}
 }
 
+// Steady-state monitor || set tolerances from simulation settings
+void steady_state_setup(Steady_state_monitor *ss, Simulation_parameters Sim)
+{
+	ss->tol_APD		= Sim.SS_tol_APD;
+	ss->tol_Ca		= Sim.SS_tol_Ca;
+	ss->tol_Nai		= Sim.SS_tol_Nai;
+	ss->Nrequired	= Sim.SS_beats;
+	ss->Nwithin		= 0;
+	ss->beats		= 0;
+	ss->set			= false;
+	ss->converged	= false;
+}
+
+// Call at excitation (t_ex == time), when the *_prev measurements hold the beat just completed
+// Nai is sampled at the same point so each beat is compared at the same phase
+bool steady_state_check(Steady_state_monitor *ss, Model_variables var, double Nai)
+{
+	bool within = ss->set
+		&& fabs(var.APD_p_prev[8] - ss->APD90)	<= ss->tol_APD
+		&& fabs(var.CaT_min_prev  - ss->CaT_min)	<= ss->tol_Ca*fabs(ss->CaT_min)
+		&& fabs(var.CaT_max_prev  - ss->CaT_max)	<= ss->tol_Ca*fabs(ss->CaT_max)
+		&& fabs(var.CaSR_min_prev - ss->CaSR_min)	<= ss->tol_Ca*fabs(ss->CaSR_min)
+		&& fabs(var.CaSR_max_prev - ss->CaSR_max)	<= ss->tol_Ca*fabs(ss->CaSR_max)
+		&& fabs(Nai - ss->Nai)					<= ss->tol_Nai*fabs(ss->Nai);
+
+	if (within == true) ss->Nwithin++;
+	else ss->Nwithin = 0;
+	if (ss->Nwithin >= ss->Nrequired) ss->converged = true;
+
+	ss->APD90		= var.APD_p_prev[8];
+	ss->CaT_min		= var.CaT_min_prev;
+	ss->CaT_max		= var.CaT_max_prev;
+	ss->CaSR_min	= var.CaSR_min_prev;
+	ss->CaSR_max	= var.CaSR_max_prev;
+	ss->Nai			= Nai;
+	ss->set			= true;
+	ss->beats++;
+	return ss->converged;
+}
 
 // End Excitation properties / measurements =====================================================//|
 
@@ -122,6 +122,8 @@ void determine_excitation_state(Model_variables *var, double Vm, double time);
 void determine_excitation_state_integrated_0D(Model_variables *var, double Vm, double time, double *Ca_JSR_t_ex, double Ca_JSR, double *dyad_SRF_prop_active, double srf_SRF_prop_active, int *srf_init, int *srf_set, const char *SRF_Mode);
 void calculate_measurement_properties(Model_variables *var, double Vm1, double Vm2, double time, double dt, double APD_threshold, double CaT, double CaSR);
 void calculate_flux_integrals(Cell_parameters p, Model_variables *var, double J_SERCA, double J_NCX, double J_rel, double J_LTCC);
+void steady_state_setup(Steady_state_monitor *ss, Simulation_parameters Sim);
+bool steady_state_check(Steady_state_monitor *ss, Model_variables var, double Nai);
 
 // Voltage clamp
 void run_voltage_clamp(Cell_parameters p, Model_variables *var, State_variables *s, char const *directory, double dt);
@@ -66,14 +66,17 @@
 // ========================================================  //
 
 #include "Structs.h"
+#include "Read_write_state.h"
 #include <fstream>
 #include <sstream>
 #include <stdlib.h>
 #include <stdio.h>
 #include <cstring>
+#include <unistd.h>
 
 // Function list ================================================================================\\|
 //	output_properties_to_screen()   || Properties_log.dat
+//	output_steady_state_log()       || Steady_state_log.dat
 //	output_currents()				|| Currents.dat
 //	output_excitation_properties()	|| Properties.dat
 //	
@@ -85,13 +88,25 @@
 //	    data_2D_XYslice_output()
 //	    data_2D_XZslice_output()
 //	    data_2D_YZslice_output()
+//	    vtk_ROI_output()
+//	    set_output_sinks()
+//	    output_sinks()
 //	
 //	    vtk_3D_output()
 //	    data_3D_output()
 //	    array_1D_output()
 //	    array_1D_binary_read()
+//	    output_geometry_sidecar()
+//	    read_geometry_sidecar()
 //	
 //	    Output_activation()
+//	    Output_APD_maps()
+//	
+//	probe recorder
+//	    probe_setup()
+//	    probe_record()
+//	    probe_flush()
+//	    probe_close()
 //	
 //	output_settings()
 //	output_settings_tissue()
@@ -125,6 +140,18 @@ void output_properties_to_screen(const char * log_reference, Model_variables var
 
 }
 
+// Steady-state detection result to file and screen
+void output_steady_state_log(const char * log_reference, Steady_state_monitor ss, Simulation_parameters Sim, int NBeats_paced)
+{
+	if (ss.converged == true) printf("Steady state reached after %d beats (BCL = %d ms)\n\n", NBeats_paced, Sim.BCL);
+	else printf("Steady state NOT reached within %d beats (BCL = %d ms)\n\n", NBeats_paced, Sim.BCL);
+
+	FILE *out;
+	out = fopen(log_reference, "a");    // Note: Appended, not overwritten
+	fprintf(out, "%d %d %d %d %f %f %f %f %f %f\n", Sim.BCL, NBeats_paced, Sim.NBeats, (ss.converged == true) ? 1 : 0, ss.APD90, 1e3*ss.CaT_min, 1e3*ss.CaT_max, ss.CaSR_min, ss.CaSR_max, ss.Nai);
+	fclose(out);
+}
+
 // Output currents and gates to file
 void output_currents(std::ostream& out, double sim_time, Model_variables var, State_variables s, double Vm)
 {
@@ -234,97 +261,201 @@ void linescan_out_Z(std::ostream& out, SC_variables sc, double * variable, int x
 	out<<std::endl;
 }
 
-// 2D slices
-void data_2D_XYslice_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count, int Z)
+// 2D slices || only the requested plane is read (geo_index maps 3D idx to node); k = 1 keeps the
+// full-volume row layout (empty rows outside the plane), k > 1 writes every k-th in-plane voxel to a _k_ file
+void data_2D_XYslice_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count, int Z, int k)
 {
 	FILE * out;
-	//char *str = (char*)malloc(50);
 	char str[1000];
-
-	int cell_count = 0;
 	int idx;
 
-	sprintf(str, "%s/%s/%s_output_2D_XYslice_z_%d_time_%04d.dat", dir, dir2, string, Z, count);
+	if (k == 1) sprintf(str, "%s/%s/%s_output_2D_XYslice_z_%d_time_%04d.dat", dir, dir2, string, Z, count);
+	else 		sprintf(str, "%s/%s/%s_output_2D_XYslice_z_%d_k_%d_time_%04d.dat", dir, dir2, string, Z, k, count);
 	out = fopen(str, "wt");
 
-	for (int z = 0; z < sc.NZ; z++) {
-		for (int y = 0; y < sc.NY; y++) {
-			for (int x = 0; x < sc.NX; x++){
-				idx = x + (sc.NX*y) + (sc.NX*sc.NY*z);
-				if (sc.geo[idx] > 0)
-				{
-					if (z == Z) fprintf(out, "%f ", variable[cell_count]);
-					cell_count++;
+	if (k == 1)
+	{
+		for (int z = 0; z < sc.NZ; z++) {
+			for (int y = 0; y < sc.NY; y++) {
+				if (z == Z) for (int x = 0; x < sc.NX; x++){
+					idx = x + (sc.NX*y) + (sc.NX*sc.NY*z);
+					if (sc.geo[idx] > 0) fprintf(out, "%f ", variable[sc.geo_index[idx]]);
+					else fprintf(out, "-100 ");
 				}
-				else if (z == Z) fprintf(out, "-100 ");
+				fprintf(out, "\n");
+			}
+			fprintf(out, "\n");
+		}
+	}
+	else
+	{
+		for (int y = 0; y < sc.NY; y += k) {
+			for (int x = 0; x < sc.NX; x += k){
+				idx = x + (sc.NX*y) + (sc.NX*sc.NY*Z);
+				if (sc.geo[idx] > 0) fprintf(out, "%f ", variable[sc.geo_index[idx]]);
+				else fprintf(out, "-100 ");
 			}
 			fprintf(out, "\n");
 		}
-		fprintf(out, "\n");
 	}
 	fclose(out);
 }
 
-void data_2D_XZslice_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count, int Y)
+void data_2D_XZslice_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count, int Y, int k)
 {
 	FILE * out;
-	//char *str = (char*)malloc(50);
 	char str[1000];
-
-	int cell_count = 0;
 	int idx;
 
-	sprintf(str, "%s/%s/%s_output_2D_XZslice_y_%d_time_%04d.dat", dir, dir2, string, Y, count);
+	if (k == 1) sprintf(str, "%s/%s/%s_output_2D_XZslice_y_%d_time_%04d.dat", dir, dir2, string, Y, count);
+	else 		sprintf(str, "%s/%s/%s_output_2D_XZslice_y_%d_k_%d_time_%04d.dat", dir, dir2, string, Y, k, count);
 	out = fopen(str, "wt");
 
-	for (int z = 0; z < sc.NZ; z++) {
-		for (int y = 0; y < sc.NY; y++) {
-			for (int x = 0; x < sc.NX; x++){
-				idx = x + (sc.NX*y) + (sc.NX*sc.NY*z);
-				if (sc.geo[idx] > 0)
-				{
-					if (y == Y) fprintf(out, "%f ", variable[cell_count]);
-					cell_count++;
+	if (k == 1)
+	{
+		for (int z = 0; z < sc.NZ; z++) {
+			for (int y = 0; y < sc.NY; y++) {
+				if (y == Y) for (int x = 0; x < sc.NX; x++){
+					idx = x + (sc.NX*y) + (sc.NX*sc.NY*z);
+					if (sc.geo[idx] > 0) fprintf(out, "%f ", variable[sc.geo_index[idx]]);
+					else fprintf(out, "-100 ");
 				}
-				else if (y == Y) fprintf(out, "-100 ");
+				fprintf(out, "\n");
+			}
+			fprintf(out, "\n");
+		}
+	}
+	else
+	{
+		for (int z = 0; z < sc.NZ; z += k) {
+			for (int x = 0; x < sc.NX; x += k){
+				idx = x + (sc.NX*Y) + (sc.NX*sc.NY*z);
+				if (sc.geo[idx] > 0) fprintf(out, "%f ", variable[sc.geo_index[idx]]);
+				else fprintf(out, "-100 ");
 			}
 			fprintf(out, "\n");
 		}
-		fprintf(out, "\n");
 	}
 	fclose(out);
 }
 
-void data_2D_YZslice_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count, int X)
+void data_2D_YZslice_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count, int X, int k)
 {
 	FILE * out;
-	//char *str = (char*)malloc(50);
 	char str[1000];
+	int idx;
 
-	int cell_count = 0;
+	if (k == 1) sprintf(str, "%s/%s/%s_output_2D_YZslice_x_%d_time_%04d.dat", dir, dir2, string, X, count);
+	else 		sprintf(str, "%s/%s/%s_output_2D_YZslice_x_%d_k_%d_time_%04d.dat", dir, dir2, string, X, k, count);
+	out = fopen(str, "wt");
+
+	if (k == 1)
+	{
+		for (int z = 0; z < sc.NZ; z++) {
+			for (int y = 0; y < sc.NY; y++) {
+				idx = X + (sc.NX*y) + (sc.NX*sc.NY*z);
+				if (sc.geo[idx] > 0) fprintf(out, "%f ", variable[sc.geo_index[idx]]);
+				else fprintf(out, "-100 ");
+				fprintf(out, "\n");
+			}
+			fprintf(out, "\n");
+		}
+	}
+	else
+	{
+		for (int z = 0; z < sc.NZ; z += k) {
+			for (int y = 0; y < sc.NY; y += k){
+				idx = X + (sc.NX*y) + (sc.NX*sc.NY*z);
+				if (sc.geo[idx] > 0) fprintf(out, "%f ", variable[sc.geo_index[idx]]);
+				else fprintf(out, "-100 ");
+			}
+			fprintf(out, "\n");
+		}
+	}
+	fclose(out);
+}
+
+// Region of interest || bounding box, every k-th voxel, as vtk with origin and spacing of the box
+void vtk_ROI_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count, Output_sink os, int sink)
+{
+	FILE * out;
+	char str[1000];
 	int idx;
 
-	sprintf(str, "%s/%s/%s_output_2D_YZslice_x_%d_time_%04d.dat", dir, dir2, string, X, count);
+	int NXr = (os.x1 - os.x0)/os.k + 1;
+	int NYr = (os.y1 - os.y0)/os.k + 1;
+	int NZr = (os.z1 - os.z0)/os.k + 1;
+
+	sprintf(str, "%s/%s/%s_output_ROI_%d_%04d.vtk", dir, dir2, string, sink, count);
 	out = fopen(str, "wt");
 
-	for (int z = 0; z < sc.NZ; z++) {
-		for (int y = 0; y < sc.NY; y++) {
-			for (int x = 0; x < sc.NX; x++){
+	fprintf(out, "# vtk DataFile Version 3.0\n");
+	fprintf(out, "vtk output\n");
+	fprintf(out, "ASCII\n");
+	fprintf(out, "DATASET STRUCTURED_POINTS\n");
+	fprintf(out, "DIMENSIONS %d %d %d\n", NXr, NYr, NZr);
+	fprintf(out, "SPACING %d %d %d\n", os.k, os.k, os.k);
+	fprintf(out, "ORIGIN %d %d %d\n", os.x0, os.y0, os.z0);
+	fprintf(out, "POINT_DATA %d\n", NXr*NYr*NZr);
+	fprintf(out, "SCALARS %s float 1\n", string);
+	fprintf(out, "LOOKUP_TABLE default\n");
+
+	for (int z = os.z0; z <= os.z1; z += os.k) {
+		for (int y = os.y0; y <= os.y1; y += os.k) {
+			for (int x = os.x0; x <= os.x1; x += os.k){
 				idx = x + (sc.NX*y) + (sc.NX*sc.NY*z);
-				if (sc.geo[idx] > 0)
-				{
-					if (x == X) fprintf(out, "%f ", variable[cell_count]);
-					cell_count++;
-				}
-				else if (x == X) fprintf(out, "-100 ");
+				if (sc.geo[idx] > 0) fprintf(out, "%f ", variable[sc.geo_index[idx]]);
+				else fprintf(out, "-100 ");
 			}
 			fprintf(out, "\n");
 		}
-		fprintf(out, "\n");
 	}
 	fclose(out);
 }
 
+// Output sinks ====================================\\|
+// Resolve full-extent (-1) bounds to the domain and check the sinks lie within it; call once geometry is set
+void set_output_sinks(Simulation_parameters *sim, SC_variables sc)
+{
+	for (int i = 0; i < sim->N_output_sinks; i++)
+	{
+		Output_sink *os = &sim->output_sink[i];
+		if (os->x0 < -1 || os->x1 < -1 || os->y0 < -1 || os->y1 < -1 || os->z0 < -1 || os->z1 < -1)
+		{
+			printf("ERROR: output sink %d (%s) has a negative bound; only -1 (full extent) is allowed\n", i, os->type);
+			exit(1);
+		}
+		if (os->x0 < 0) os->x0 = 0;
+		if (os->x1 < 0) os->x1 = sc.NX - 1;
+		if (os->y0 < 0) os->y0 = 0;
+		if (os->y1 < 0) os->y1 = sc.NY - 1;
+		if (os->z0 < 0) os->z0 = 0;
+		if (os->z1 < 0) os->z1 = sc.NZ - 1;
+
+		if (os->x1 >= sc.NX || os->y1 >= sc.NY || os->z1 >= sc.NZ || os->x0 > os->x1 || os->y0 > os->y1 || os->z0 > os->z1)
+		{
+			printf("ERROR: output sink %d (%s; x %d-%d y %d-%d z %d-%d) is outside of the tissue domain (NX = %d NY = %d NZ = %d)\n", i, os->type, os->x0, os->x1, os->y0, os->y1, os->z0, os->z1, sc.NX, sc.NY, sc.NZ);
+			exit(1);
+		}
+	}
+}
+
+// Called every ms (count = ms); each sink applies its own interval and time range
+void output_sinks(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count, Simulation_parameters *sim)
+{
+	for (int i = 0; i < sim->N_output_sinks; i++)
+	{
+		Output_sink os = sim->output_sink[i];
+		if (count < os.start_time || count > os.end_time || count % os.interval != 0) continue;
+
+		if      (strcmp(os.type, "slice_XY") == 0) data_2D_XYslice_output(string, dir, dir2, variable, sc, count, os.z0, os.k);
+		else if (strcmp(os.type, "slice_XZ") == 0) data_2D_XZslice_output(string, dir, dir2, variable, sc, count, os.y0, os.k);
+		else if (strcmp(os.type, "slice_YZ") == 0) data_2D_YZslice_output(string, dir, dir2, variable, sc, count, os.x0, os.k);
+		else                                        vtk_ROI_output(string, dir, dir2, variable, sc, count, os, i);
+	}
+}
+// End Output sinks ================================//|
+
 // VTK
 void vtk_3D_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count)
 {
@@ -433,6 +564,292 @@ void array_1D_binary_read(const char *string,  const char * dir, const char * di
 	fclose(in);
 }
 
+// Geometry sidecar || compact description of the tissue layout so post-processing doesn't need the tissue setup
+// Layout (int): NX NY NZ N, then N 3D indices (geo_3D_index), then N celltypes (geo_linear)
+void output_geometry_sidecar(const char * dir, const char * dir2, SC_variables sc)
+{
+	FILE * out;
+	char str[1000];
+	int header[4] = {sc.NX, sc.NY, sc.NZ, sc.N};
+
+	sprintf(str, "%s/%s/Geometry_sidecar.bin", dir, dir2);
+	out = fopen(str, "wb");
+	if (out == NULL)
+	{
+		printf("ERROR: cannot open geometry sidecar %s for writing\n", str);
+		exit(1);
+	}
+	if (fwrite(header, sizeof(int), 4, out) != 4 || fwrite(sc.geo_3D_index, sizeof(int), sc.N, out) != (size_t)sc.N
+		|| fwrite(sc.geo_linear, sizeof(int), sc.N, out) != (size_t)sc.N || fclose(out) != 0)
+	{
+		printf("ERROR: could not write geometry sidecar %s\n", str);
+		exit(1);
+	}
+}
+
+// Allocates and sets geo and geo_index (NX*NY*NZ) from the sidecar; returns false if no sidecar is present
+bool read_geometry_sidecar(const char * dir, const char * dir2, SC_variables *sc)
+{
+	FILE * in;
+	char str[1000];
+	int header[4];
+
+	sprintf(str, "%s/%s/Geometry_sidecar.bin", dir, dir2);
+	in = fopen(str, "rb");
+	if (in == NULL) return false;
+	if (fread(header, sizeof(int), 4, in) != 4)
+	{
+		printf("ERROR: geometry sidecar %s is incomplete\n", str);
+		exit(1);
+	}
+	sc->NX = header[0];
+	sc->NY = header[1];
+	sc->NZ = header[2];
+	sc->N  = header[3];
+
+	int N3 			= sc->NX * sc->NY * sc->NZ;
+	int *index_3D 	= new int[sc->N];
+	int *celltype 	= new int[sc->N];
+	if (fread(index_3D, sizeof(int), sc->N, in) != (size_t)sc->N || fread(celltype, sizeof(int), sc->N, in) != (size_t)sc->N)
+	{
+		printf("ERROR: geometry sidecar %s is incomplete\n", str);
+		exit(1);
+	}
+	fclose(in);
+
+	sc->geo 		= new int[N3];
+	sc->geo_index 	= new int[N3];
+	for (int idx = 0; idx < N3; idx++) { sc->geo[idx] = 0; sc->geo_index[idx] = -1; }
+	for (int n = 0; n < sc->N; n++)
+	{
+		sc->geo[index_3D[n]] 		= celltype[n];
+		sc->geo_index[index_3D[n]] 	= n;
+	}
+	delete [] index_3D;
+	delete [] celltype;
+	return true;
+}
+
+// Probe recorder ===============================================================================\\|
+// Variables which can be recorded; index in this list is the var_id
+static const char *probe_var_list[] = {"Vm", "Istim", "Itot", "INa", "INaL", "Ito", "ICaL", "IKur", "IKr", "IKs", "IK1", "INCX", "INaK", "ICaP", "INab", "ICab", "IKb", "IClCa", "IClb", "IKACh", "Cai", "Cai_sl", "Cai_j", "CajSR", "CanSR", "Nai", "Ki", "dvdt"};
+static const int probe_Nvar_list = 28;
+
+static double probe_value(int id, State_variables *s, Model_variables *v, double Vm, double Istim)
+{
+	switch (id)
+	{
+		case 0:  return Vm;
+		case 1:  return Istim;
+		case 2:  return v->Itot;
+		case 3:  return v->INa;
+		case 4:  return v->INaL;
+		case 5:  return v->Ito;
+		case 6:  return v->ICaL;
+		case 7:  return v->IKur;
+		case 8:  return v->IKr;
+		case 9:  return v->IKs;
+		case 10: return v->IK1;
+		case 11: return v->INCX;
+		case 12: return v->INaK;
+		case 13: return v->ICaP;
+		case 14: return v->INab;
+		case 15: return v->ICab;
+		case 16: return v->IKb;
+		case 17: return v->IClCa;
+		case 18: return v->IClb;
+		case 19: return v->IKACh;
+		case 20: return s->Cai;
+		case 21: return s->Cai_sl;
+		case 22: return s->Cai_j;
+		case 23: return s->CajSR;
+		case 24: return s->CanSR;
+		case 25: return s->Nai;
+		case 26: return s->Ki;
+		default: return v->dvdt;
+	}
+}
+
+// Converts an entry (either "n" or "x y z"/"x:y:z") to a linear node index; a single value is read into x
+static int probe_node_from_entry(SC_variables sc, int Nval, int x, int y, int z, const char *entry)
+{
+	if (Nval == 1)
+	{
+		if (x < 0 || x >= sc.N)
+		{
+			printf("ERROR: probe node \"%s\" is outside of the range of tissue nodes (0 - %d)\n", entry, sc.N-1);
+			exit(1);
+		}
+		return x;
+	}
+	if (Nval == 3)
+	{
+		if (x < 0 || x >= sc.NX || y < 0 || y >= sc.NY || z < 0 || z >= sc.NZ || sc.geo[x + sc.NX*y + sc.NX*sc.NY*z] <= 0)
+		{
+			printf("ERROR: probe coordinate \"%s\" is not a tissue node\n", entry);
+			exit(1);
+		}
+		return sc.geo_index[x + sc.NX*y + sc.NX*sc.NY*z];
+	}
+	printf("ERROR: probe entry \"%s\" must be a node index or x y z coordinates\n", entry);
+	exit(1);
+}
+
+// Sets probe nodes and variables from arguments, allocates buffer and opens output files (restart_length >= 0 continues an existing file)
+void probe_setup(Probe_parameters *pr, Argument_parameters A, SC_variables sc, double dt, const char *directory, long restart_length)
+{
+	char line[1000];
+	int x, y, z, Nval;
+
+	pr->N 			= 0;
+	pr->Nvar 		= 0;
+	pr->Nbuffered 	= 0;
+	pr->node 		= NULL;
+	pr->buffer 		= NULL;
+	pr->out 		= NULL;
+	if (A.Probe_file_arg == false && A.Probe_nodes_arg == false) return;
+
+	// Count probes, then allocate and fill
+	int Nmax = 0;
+	FILE *in = NULL;
+	if (A.Probe_file_arg == true)
+	{
+		in = fopen(A.Probe_file, "r");
+		if (in == NULL)
+		{
+			printf("ERROR: Cannot open probe file \"%s\"\n", A.Probe_file);
+			exit(1);
+		}
+		while (fgets(line, 1000, in) != NULL) Nmax++;
+		rewind(in);
+	}
+	if (A.Probe_nodes_arg == true)
+	{
+		Nmax++;
+		for (const char *c = A.Probe_nodes; *c != '\0'; c++) if (*c == ',') Nmax++;
+	}
+	pr->node = new int[Nmax];
+
+	if (in != NULL)
+	{
+		while (fgets(line, 1000, in) != NULL)
+		{
+			line[strcspn(line, "\r\n")] = '\0';
+			if (line[0] == '#' || strspn(line, " \t") == strlen(line)) continue; // skip comments and blank lines
+			Nval = sscanf(line, "%d %d %d", &x, &y, &z);
+			pr->node[pr->N] = probe_node_from_entry(sc, Nval, x, y, z, line);
+			pr->N++;
+		}
+		fclose(in);
+	}
+	if (A.Probe_nodes_arg == true)
+	{
+		char *list = strdup(A.Probe_nodes);
+		for (char *entry = strtok(list, ","); entry != NULL; entry = strtok(NULL, ","))
+		{
+			Nval = sscanf(entry, "%d:%d:%d", &x, &y, &z);
+			pr->node[pr->N] = probe_node_from_entry(sc, Nval, x, y, z, entry);
+			pr->N++;
+		}
+		free(list);
+	}
+
+	// Variables
+	char *vars = strdup(A.Probe_variables_arg == true ? A.Probe_variables : "Vm");
+	for (char *entry = strtok(vars, ","); entry != NULL; entry = strtok(NULL, ","))
+	{
+		if (pr->Nvar >= 20)
+		{
+			printf("ERROR: a maximum of 20 probe variables can be recorded\n");
+			exit(1);
+		}
+		int id = -1;
+		for (int i = 0; i < probe_Nvar_list; i++) if (strcmp(entry, probe_var_list[i]) == 0) id = i;
+		if (id < 0)
+		{
+			printf("ERROR: \"%s\" is not a valid probe variable. Please select from:", entry);
+			for (int i = 0; i < probe_Nvar_list; i++) printf(" %s", probe_var_list[i]);
+			printf("\n");
+			exit(1);
+		}
+		pr->var_id[pr->Nvar] = id;
+		sprintf(pr->var_name[pr->Nvar], "%s", entry);
+		pr->Nvar++;
+	}
+	free(vars);
+
+	// Sampling and buffer
+	pr->interval 		= (A.Probe_interval_arg == true) ? A.Probe_interval : 1.0;
+	pr->interval_int 	= (int)(pr->interval/dt + 0.5);
+	if (pr->interval_int < 1) pr->interval_int = 1;
+	pr->interval 		= pr->interval_int * dt;
+	pr->buffer_size 	= (A.Probe_buffer_arg == true && A.Probe_buffer > 0) ? A.Probe_buffer : 1000;
+	pr->sample_size 	= 1 + pr->N * pr->Nvar;
+	pr->buffer 			= new double[pr->buffer_size * pr->sample_size];
+
+	// Info file describing the binary layout
+	sprintf(line, "%s/Probes_info.dat", directory);
+	FILE *info = fopen(line, "w");
+	fprintf(info, "N_probes %d\nN_variables %d\ninterval_ms %f\n", pr->N, pr->Nvar, pr->interval);
+	fprintf(info, "variables");
+	for (int v = 0; v < pr->Nvar; v++) fprintf(info, " %s", pr->var_name[v]);
+	fprintf(info, "\nlayout per sample: time, then for each probe all variables (doubles)\n");
+	fprintf(info, "probe node x y z\n");
+	for (int p = 0; p < pr->N; p++) fprintf(info, "%d %d %d %d %d\n", p, pr->node[p], sc.x_index[pr->node[p]], sc.y_index[pr->node[p]], sc.z_index[pr->node[p]]);
+	fclose(info);
+
+	// On restart, continue the existing file from its length at the checkpoint
+	sprintf(line, "%s/Probes.bin", directory);
+	if (restart_length >= 0)
+	{
+		Truncate_checkpoint_output(line, restart_length);	// lib/Read_write_state.c
+		pr->out = fopen(line, "ab");
+	}
+	else pr->out = fopen(line, "wb");
+	if (pr->out == NULL)
+	{
+		printf("ERROR: Cannot open probe output file \"%s\"\n", line);
+		exit(1);
+	}
+}
+
+// Writes the buffered samples as one binary block
+void probe_flush(Probe_parameters *pr)
+{
+	if (pr->Nbuffered == 0) return;
+	fwrite(pr->buffer, sizeof(double), pr->Nbuffered * pr->sample_size, pr->out);
+	pr->Nbuffered = 0;
+}
+
+// Stores one sample of all probes; flushes when the buffer is full
+// Istim is the current applied to the node: stim_current, plus multi_stim_current (stored as dt*Istim) if set
+void probe_record(Probe_parameters *pr, double sim_time, State_variables *s, Model_variables *v, double *Vm, double *stim_current, double *multi_stim_current, double dt)
+{
+	double *sample = &pr->buffer[pr->Nbuffered * pr->sample_size];
+	sample[0] = sim_time;
+	for (int p = 0; p < pr->N; p++)
+	{
+		int n = pr->node[p];
+		double Istim = stim_current[n];
+		if (multi_stim_current != NULL) Istim += multi_stim_current[n]/dt;
+		for (int i = 0; i < pr->Nvar; i++) sample[1 + p*pr->Nvar + i] = probe_value(pr->var_id[i], &s[n], &v[n], Vm[n], Istim);
+	}
+	pr->Nbuffered++;
+	if (pr->Nbuffered == pr->buffer_size) probe_flush(pr);
+}
+
+// Flushes remaining samples, closes file and frees memory
+void probe_close(Probe_parameters *pr)
+{
+	if (pr->out == NULL) return;
+	probe_flush(pr);
+	fclose(pr->out);
+	delete [] pr->node;
+	delete [] pr->buffer;
+	pr->out = NULL;
+}
+// End Probe recorder ===========================================================================//|
+
 // Activation time
 void Output_activation(const char * dir, const char * dir2, Model_variables *v, SC_variables sc)
 {
@@ -483,6 +900,33 @@ void Output_activation(const char * dir, const char * dir2, Model_variables *v,
 	fclose(out);
 	fclose(out2);
 }
+
+// APD at each level of the event-driven measurement engine, final beat; as the activation datafile
+void Output_APD_maps(const char * dir, const char * dir2, Measurement_engine *me, Model_variables *var, SC_variables sc)
+{
+	char str[1000];
+	for (int l = 0; l < me->Nlevels; l++)
+	{
+		sprintf(str, "%s/%s/APD%d_output.dat", dir, dir2, me->percent[l]);
+		FILE *out = fopen(str, "wt");
+		int cell_count = 0;
+		for (int z = 0; z < sc.NZ; z++) {
+			for (int y = 0; y < sc.NY; y++) {
+				for (int x = 0; x < sc.NX; x++){
+					int idx = x + (sc.NX*y) + (sc.NX*sc.NY*z);
+					if (sc.geo[idx] > 0)
+					{
+						fprintf(out, "%f ", var[cell_count].APD_p[me->APD_p_index[l]]);
+						cell_count++;
+					}
+					else fprintf(out, "-100 ");
+				}
+				fprintf(out, "\n");
+			}
+		}
+		fclose(out);
+	}
+}
 // End Spatial outputs  =========================================================================//|
 
 // Settings and initialisation ===========================================================================\\|
@@ -610,6 +1054,7 @@ void output_settings_tissue(Simulation_parameters sim, Tissue_parameters t, char
 	if (strcmp(t.Global_orientation_direction, "Off") != 0) printf("\t\tGlobal orientation was set by direction %s\n", t.Global_orientation_direction);
     printf("\tTime range over which spatial data will be output (if intervals != 0) = %d to %d\n", sim.Spatial_output_start_time, sim.Spatial_output_end_time);
 	printf("\tSpatial output interval (vtk) = %d ms Spatial output interval (data) = %d ms\n", sim.Spatial_output_interval_vtk, sim.Spatial_output_interval_data);
+	for (int i = 0; i < sim.N_output_sinks; i++) printf("\tOutput sink %d: %s x = %d-%d y = %d-%d z = %d-%d k = %d interval = %d ms time range = %d to %d\n", i, sim.output_sink[i].type, sim.output_sink[i].x0, sim.output_sink[i].x1, sim.output_sink[i].y0, sim.output_sink[i].y1, sim.output_sink[i].z0, sim.output_sink[i].z1, sim.output_sink[i].k, sim.output_sink[i].interval, sim.output_sink[i].start_time, sim.output_sink[i].end_time);
 	printf("*************************************************************************************************************\n\n");
 
 	// File
@@ -636,6 +1081,7 @@ void output_settings_tissue(Simulation_parameters sim, Tissue_parameters t, char
 	if (strcmp(t.Global_orientation_direction, "Off") != 0) fprintf(so, "\t\tGlobal orientation was set by direction %s\n", t.Global_orientation_direction);
     fprintf(so, "\tTime range over which spatial data will be output (if intervals != 0) = %d to %d\n", sim.Spatial_output_start_time, sim.Spatial_output_end_time);
 	fprintf(so, "\tSpatial output interval (vtk) = %d ms Spatial output interval (data) = %d ms\n", sim.Spatial_output_interval_vtk, sim.Spatial_output_interval_data);
+	for (int i = 0; i < sim.N_output_sinks; i++) fprintf(so, "\tOutput sink %d: %s x = %d-%d y = %d-%d z = %d-%d k = %d interval = %d ms time range = %d to %d\n", i, sim.output_sink[i].type, sim.output_sink[i].x0, sim.output_sink[i].x1, sim.output_sink[i].y0, sim.output_sink[i].y1, sim.output_sink[i].z0, sim.output_sink[i].z1, sim.output_sink[i].k, sim.output_sink[i].interval, sim.output_sink[i].start_time, sim.output_sink[i].end_time);
 
 	fclose(so);
 }
@@ -78,6 +78,7 @@
 
 // Global output functions
 void output_properties_to_screen(const char * log_reference, Model_variables var, Simulation_parameters Sim);
+void output_steady_state_log(const char * log_reference, Steady_state_monitor ss, Simulation_parameters Sim, int NBeats_paced);
 void output_currents(std::ostream& out, double sim_time, Model_variables var, State_variables s, double Vm);
 void output_excitation_properties(std::ostream& out, double sim_time, Model_variables var, double Vm);
 
@@ -85,14 +86,26 @@ void output_excitation_properties(std::ostream& out, double sim_time, Model_vari
 void linescan_out_X(std::ostream& out, SC_variables sc, double * variable, int y, int z);
 void linescan_out_Y(std::ostream& out, SC_variables sc, double * variable, int x, int z);
 void linescan_out_Z(std::ostream& out, SC_variables sc, double * variable, int x, int y);
-void data_2D_XYslice_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count, int z);
-void data_2D_XZslice_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count, int y);
-void data_2D_YZslice_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count, int x);
+void data_2D_XYslice_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count, int z, int k);
+void data_2D_XZslice_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count, int y, int k);
+void data_2D_YZslice_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count, int x, int k);
+void vtk_ROI_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count, Output_sink os, int sink);
+void set_output_sinks(Simulation_parameters *sim, SC_variables sc);
+void output_sinks(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count, Simulation_parameters *sim);
 void vtk_3D_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count);
 void array_1D_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count);
 void Output_activation(const char * dir, const char * dir2, Model_variables *v, SC_variables sc);
+void Output_APD_maps(const char * dir, const char * dir2, Measurement_engine *me, Model_variables *var, SC_variables sc);
 void data_3D_output(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count);
 void array_1D_binary_read(const char *string,  const char * dir, const char * dir2, double *variable, SC_variables sc, int count);
+void output_geometry_sidecar(const char * dir, const char * dir2, SC_variables sc);
+bool read_geometry_sidecar(const char * dir, const char * dir2, SC_variables *sc);
+
+// Probe recorder (tissue models)
+void probe_setup(Probe_parameters *pr, Argument_parameters A, SC_variables sc, double dt, const char *directory, long restart_length);
+void probe_record(Probe_parameters *pr, double sim_time, State_variables *s, Model_variables *v, double *Vm, double *stim_current, double *multi_stim_current, double dt);
+void probe_flush(Probe_parameters *pr);
+void probe_close(Probe_parameters *pr);
 
 // Settings
 void output_settings(Simulation_parameters sim, char const * directory, bool DC_current_mod_arg, Cell_parameters p, int argc, char *argin[]);
@@ -67,6 +67,14 @@
 
 #include "Structs.h"
 #include "Read_write_state.h"
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <string>
+#include <unordered_map>
 
 // Function list ================================================================================\\|
 //	Actual read/write functions
@@ -79,80 +87,83 @@
 //	
 //	    Write_state_tissue_native_whole_tissue()
 //	    Read_state_tissue_native_whole_tissue()
+//	    Write_state_tissue_native_whole_tissue_binary()
+//	    Read_state_tissue_native_whole_tissue_binary()
 //	    Write_state_tissue_native_ave_tissue()
 //	    Read_state_tissue_native_ave_tissue()
 //	
 //	    Write_state_phase()
 //	    Read_state_phase()
+//	
+//	State cache (per-node reads in tissue)
+//	    Read_state_tissue_native_cached()
+//	
+//	State library (indexed binary store of per-cell states)
+//	    Write_state_library()
+//	    Read_state_library()
+//	    State_write_target_single_cell()
+//	
+//	Checkpoint and restart (tissue)
+//	    Write_checkpoint_tissue()
+//	    Read_checkpoint_tissue_header()
+//	    Read_checkpoint_tissue()
+//	    Read_checkpoint_tissue_extra()
+//	    Truncate_checkpoint_output()
 // End Function list ============================================================================//|
 
+// State fields ===============================\\|
+// The fields stored in state files, in file order. Text, binary and library formats and the state cache are all
+// generated from this one list (file order must not change, so previous state files remain valid)
+#define STATE_FIELD_LIST(X) \
+	X(Vm) X(INa_va) X(INa_vi_1) X(INa_vi_2) X(INaL_va) X(INaL_vi) \
+	X(Ito_va) X(Ito_vi) X(Ito_vi_s) X(Ito_vi_3) X(ICaL_va) X(ICaL_vi) \
+	X(ICaL_vi_s) X(ICaL_ci) X(ICaL_ci_j) X(IKur_va) X(IKur_vi) X(IKr_va) \
+	X(IKr_vi) X(IKs_va) X(IKs_va_2) X(IK1_va) X(IKACh_va) X(IKACh_vi) \
+	X(If_va) /* 25 */ \
+	X(Cai) X(Cai_j) X(Cai_sl) X(CajSR) X(CanSR) /* 30 */ \
+	X(Nai) X(Nai_j) X(Nai_sl) X(Ki) /* 34 */ \
+	X(Cao) X(Nao) X(Ko) /* 37 */ \
+	X(RyRo) X(RyRi) X(RyRr) X(Myo_c) X(Myo_m) X(Tn_CHc) \
+	X(Tn_CHm) X(Tn_CL) /* 45 */ \
+	X(cmdn) X(trpn) X(csqn) /* 48 */ \
+	X(CaCal) X(Catrop) X(Camg) X(Mgmg) X(CaCalse) /* 53 */
+
+typedef struct{
+	const char *name;
+	size_t		offset;
+}State_field;
+
+#define STATE_FIELD(name) {#name, offsetof(State_variables, name)},
+static const State_field state_fields[] = { STATE_FIELD_LIST(STATE_FIELD) };
+#undef STATE_FIELD
+static const int Nstate_fields = sizeof(state_fields)/sizeof(State_field);
+
+// For minimal model, assign to alternatively named state
+static void set_alternatively_named_states(State_variables *s)
+{
+    s->Ip0d_va      = s->INa_va;
+    s->Ip0d_vi_1    = s->INa_vi_1;
+    s->Ip0d_vi_2    = s->INa_vi_2;
+    s->Ip1r_va      = s->Ito_va;
+    s->Ip1r_vi      = s->Ito_vi;
+    s->Ip2d_va      = s->ICaL_va;
+    s->Ip2d_vi      = s->ICaL_vi;
+    s->Ip2r_va      = s->IKur_va;
+    s->Ip2r_vi      = s->IKur_vi;
+    s->Ip3r_va      = s->IKr_va;
+}
+// End State fields ===========================//|
+
 // Functions which write the state ====================================================\\|
 void Write_state_variables_native(State_variables s, FILE *out, const char * Model)
 {
-	fprintf(out, "%lf\t", s.Vm);
-	fprintf(out, "%lf\t", s.INa_va);
-	fprintf(out, "%lf\t", s.INa_vi_1);
-	fprintf(out, "%lf\t", s.INa_vi_2);
-	fprintf(out, "%lf\t", s.INaL_va);
-	fprintf(out, "%lf\t", s.INaL_vi);
-	fprintf(out, "%lf\t", s.Ito_va);
-	fprintf(out, "%lf\t", s.Ito_vi);
-	fprintf(out, "%lf\t", s.Ito_vi_s);
-	fprintf(out, "%lf\t", s.Ito_vi_3);
-	fprintf(out, "%lf\t", s.ICaL_va);
-	fprintf(out, "%lf\t", s.ICaL_vi);
-	fprintf(out, "%lf\t", s.ICaL_vi_s);
-	fprintf(out, "%lf\t", s.ICaL_ci);
-	fprintf(out, "%lf\t", s.ICaL_ci_j);
-	fprintf(out, "%lf\t", s.IKur_va);
-	fprintf(out, "%lf\t", s.IKur_vi);
-	fprintf(out, "%lf\t", s.IKr_va);
-	fprintf(out, "%lf\t", s.IKr_vi);
-	fprintf(out, "%lf\t", s.IKs_va);		
-	fprintf(out, "%lf\t", s.IKs_va_2);		
-	fprintf(out, "%lf\t", s.IK1_va);		
-	fprintf(out, "%lf\t", s.IKACh_va);		
-	fprintf(out, "%lf\t", s.IKACh_vi);		
-	fprintf(out, "%lf\t", s.If_va);		// 25
-
-	fprintf(out, "%lf\t", s.Cai);
-	fprintf(out, "%lf\t", s.Cai_j);
-	fprintf(out, "%lf\t", s.Cai_sl);
-	fprintf(out, "%lf\t", s.CajSR);
-	fprintf(out, "%lf\t", s.CanSR);			// 30
-
-	fprintf(out, "%lf\t", s.Nai);
-	fprintf(out, "%lf\t", s.Nai_j);
-	fprintf(out, "%lf\t", s.Nai_sl);
-	fprintf(out, "%lf\t", s.Ki);			// 34
-
-	fprintf(out, "%lf\t", s.Cao);
-	fprintf(out, "%lf\t", s.Nao);
-	fprintf(out, "%lf\t", s.Ko);			// 37
-
-	fprintf(out, "%lf\t", s.RyRo);			
-	fprintf(out, "%lf\t", s.RyRi);
-	fprintf(out, "%lf\t", s.RyRr);
-	fprintf(out, "%lf\t", s.Myo_c);
-	fprintf(out, "%lf\t", s.Myo_m);
-	fprintf(out, "%lf\t", s.Tn_CHc);
-	fprintf(out, "%lf\t", s.Tn_CHm);
-	fprintf(out, "%lf\t", s.Tn_CL);			// 45
-
-	fprintf(out, "%lf\t", s.cmdn);
-	fprintf(out, "%lf\t", s.trpn);
-	fprintf(out, "%lf\t", s.csqn);			// 48
-
-	fprintf(out, "%lf\t", s.CaCal);
-	fprintf(out, "%lf\t", s.Catrop);
-	fprintf(out, "%lf\t", s.Camg);
-	fprintf(out, "%lf\t", s.Mgmg);
-	fprintf(out, "%lf\t", s.CaCalse);		// 53
+	const char *c = (const char*)&s;
+	for (int f = 0; f < Nstate_fields; f++) fprintf(out, "%lf\t", *(const double*)(c + state_fields[f].offset));
 
 	// If you are adding a new model which has a new state variable, add it here as an If statement.
 	// This is so that previous state files are still valid.
 	// It was decided this would be still cleaner than having a specific function for every individual model
-	// Ensure you add it to both write and read!!
+	// Ensure you add it to both write and read!! (States common to all models are added to STATE_FIELD_LIST)
 	// if (strcmp(Model, "model ref") == 0)
 	//{
 	//	fprintf(out, "%lf\t", new gate);
@@ -166,67 +177,8 @@ void Write_state_variables_native(State_variables s, FILE *out, const char * Mod
 // Functions which read the state =====================================================\\|
 void Read_state_variables_native(State_variables *s, FILE *in, const char * Model)
 {
-	double temp;  // variable to read empty states into
-
-	fscanf(in, "%lf\t", &s->Vm);
-	fscanf(in, "%lf\t", &s->INa_va);
-	fscanf(in, "%lf\t", &s->INa_vi_1);
-	fscanf(in, "%lf\t", &s->INa_vi_2);
-	fscanf(in, "%lf\t", &s->INaL_va);
-	fscanf(in, "%lf\t", &s->INaL_vi);
-	fscanf(in, "%lf\t", &s->Ito_va);
-	fscanf(in, "%lf\t", &s->Ito_vi);
-	fscanf(in, "%lf\t", &s->Ito_vi_s);
-	fscanf(in, "%lf\t", &s->Ito_vi_3);
-	fscanf(in, "%lf\t", &s->ICaL_va);
-	fscanf(in, "%lf\t", &s->ICaL_vi);
-	fscanf(in, "%lf\t", &s->ICaL_vi_s);
-	fscanf(in, "%lf\t", &s->ICaL_ci);
-	fscanf(in, "%lf\t", &s->ICaL_ci_j);
-	fscanf(in, "%lf\t", &s->IKur_va);
-	fscanf(in, "%lf\t", &s->IKur_vi);
-	fscanf(in, "%lf\t", &s->IKr_va);
-	fscanf(in, "%lf\t", &s->IKr_vi);
-	fscanf(in, "%lf\t", &s->IKs_va);		
-	fscanf(in, "%lf\t", &s->IKs_va_2);		
-	fscanf(in, "%lf\t", &s->IK1_va);		
-	fscanf(in, "%lf\t", &s->IKACh_va);
-    fscanf(in, "%lf\t", &s->IKACh_vi);
-    fscanf(in, "%lf\t", &s->If_va);		// 25
-
-	fscanf(in, "%lf\t", &s->Cai);
-	fscanf(in, "%lf\t", &s->Cai_j);
-	fscanf(in, "%lf\t", &s->Cai_sl);
-	fscanf(in, "%lf\t", &s->CajSR);
-	fscanf(in, "%lf\t", &s->CanSR);			// 30
-
-	fscanf(in, "%lf\t", &s->Nai);
-	fscanf(in, "%lf\t", &s->Nai_j);
-	fscanf(in, "%lf\t", &s->Nai_sl);
-	fscanf(in, "%lf\t", &s->Ki);			// 34
-
-	fscanf(in, "%lf\t", &s->Cao);
-	fscanf(in, "%lf\t", &s->Nao);
-	fscanf(in, "%lf\t", &s->Ko);			// 37
-
-	fscanf(in, "%lf\t", &s->RyRo);
-	fscanf(in, "%lf\t", &s->RyRi);
-	fscanf(in, "%lf\t", &s->RyRr);
-	fscanf(in, "%lf\t", &s->Myo_c);
-	fscanf(in, "%lf\t", &s->Myo_m);
-	fscanf(in, "%lf\t", &s->Tn_CHc);
-	fscanf(in, "%lf\t", &s->Tn_CHm);
-	fscanf(in, "%lf\t", &s->Tn_CL);			// 45
-
-	fscanf(in, "%lf\t", &s->cmdn);
-	fscanf(in, "%lf\t", &s->trpn);
-	fscanf(in, "%lf\t", &s->csqn);			// 48
-
-	fscanf(in, "%lf\t", &s->CaCal);
-	fscanf(in, "%lf\t", &s->Catrop);
-	fscanf(in, "%lf\t", &s->Camg);
-	fscanf(in, "%lf\t", &s->Mgmg);
-	fscanf(in, "%lf\t", &s->CaCalse);		// 53
+	char *c = (char*)s;
+	for (int f = 0; f < Nstate_fields; f++) fscanf(in, "%lf\t", (double*)(c + state_fields[f].offset));
 
     // If you are adding a new model which has a new state variable, add it here as an If statement
     // This is so that previous state files are still valid
@@ -241,20 +193,19 @@ void Read_state_variables_native(State_variables *s, FILE *in, const char * Mode
 
 
 	// And for minimal model, assign to alternatively named state
-    s->Ip0d_va          = s->INa_va;
-    s->Ip0d_vi_1        = s->INa_vi_1;
-    s->Ip0d_vi_2        = s->INa_vi_2;
-    s->Ip1r_va          = s->Ito_va;
-    s->Ip1r_vi          = s->Ito_vi;
-    s->Ip2d_va          = s->ICaL_va;
-    s->Ip2d_vi          = s->ICaL_vi;
-    s->Ip2r_va          = s->IKur_va;
-    s->Ip2r_vi          = s->IKur_vi;
-    s->Ip3r_va          = s->IKr_va;
+	set_alternatively_named_states(s);
 }
 // End functions which read the state =================================================//|
 
 // Functions which set filename and call write/read state =============================\\|
+// Filename of per-cell state files read into tissue (as written by single cell, ave tissue and phase)
+static void state_filename_read(char *string, const char *type, Cell_parameters p, int BCL, const char * PATH, const char *Model, int phase, const char * State_ref)
+{
+    if (strcmp(type, "single_cell") == 0)   sprintf(string, "%s/State_files/Single_cell/Native_model_%s_BCL_%d_region_%s_ISO_%.2f_ACh_%.2f_remodelling_%s_drug_%s_mut_%s_env_%s_ref_%s_state.dat", PATH, Model, BCL, p.Celltype, p.ISO, p.ACh, p.Remodelling, p.Agent, p.Mutation, p.environment, State_ref);
+    else if (strcmp(type, "ave") == 0)      sprintf(string, "%s/State_files/Tissue/Native_ave_model_%s_BCL_%d_region_%s_ISO_%.2f_ACh_%.2f_remodelling_%s_drug_%s_mut_%s_env_%s_ref_%s_state.dat", PATH, Model, BCL, p.Celltype, p.ISO, p.ACh, p.Remodelling, p.Agent, p.Mutation, p.environment, State_ref);
+    else                                    sprintf(string, "%s/State_files/phase_files/Native_model_%s_BCL_%d_region_%s_ISO_%.2f_ACh_%.2f_remodelling_%s_drug_%s_mut_%s_phase_%d_ref_%s_state.dat", PATH, Model, BCL, p.Celltype, p.ISO, p.ACh, p.Remodelling, p.Agent, p.Mutation, phase, State_ref);
+}
+
 // Single cell ================================\\|
 void Write_state_single_cell_native(State_variables s, Cell_parameters p, int BCL, const char * PATH, const char *Model, const char * State_ref)
 {
@@ -281,7 +232,7 @@ void Read_state_single_cell_native(State_variables *s, Cell_parameters p, int BC
     FILE *in;
     char *string = (char*)malloc(500);
 
-    sprintf(string, "%s/State_files/Single_cell/Native_model_%s_BCL_%d_region_%s_ISO_%.2f_ACh_%.2f_remodelling_%s_drug_%s_mut_%s_env_%s_ref_%s_state.dat", PATH, Model, BCL, p.Celltype, p.ISO, p.ACh, p.Remodelling, p.Agent, p.Mutation, p.environment, State_ref);
+    state_filename_read(string, "single_cell", p, BCL, PATH, Model, 0, State_ref);
 
     in = fopen(string, "r");
 
@@ -344,6 +295,181 @@ void Read_state_tissue_native_whole_tissue(State_variables *s, Cell_parameters *
     fclose(in);
 }
 
+// Binary whole tissue state ==================\\|
+// Header: "MSCSFSB1", endian check (uint 0x01020304), N, Nfields, reserved int, Model[64], field names[Nfields][32], checksum;
+// followed by one array of N doubles per field (in header order). Fields are matched by name on read, so
+// files remain valid if fields are added; the same fields as the text format are stored
+
+// FNV-1a over each field array, combined in field order (so fields can be hashed in parallel)
+static unsigned long long state_checksum(const double *data, int Nfields, long N)
+{
+	unsigned long long *field_hash = new unsigned long long[Nfields];
+	#pragma omp parallel for
+	for (int f = 0; f < Nfields; f++)
+	{
+		const unsigned char *c = (const unsigned char*)(data + f*N);
+		unsigned long long h = 14695981039346656037ULL;
+		for (long i = 0; i < N*(long)sizeof(double); i++) { h ^= c[i]; h *= 1099511628211ULL; }
+		field_hash[f] = h;
+	}
+	unsigned long long h = 14695981039346656037ULL;
+	for (int f = 0; f < Nfields; f++) { h ^= field_hash[f]; h *= 1099511628211ULL; }
+	delete [] field_hash;
+	return h;
+}
+
+void Write_state_tissue_native_whole_tissue_binary(State_variables *s, Cell_parameters *p, int BCL, const char * PATH, const char *Model, int N, const char* Tissue_order, const char* Tissue_model, const char* Tissue_type, const char *Orientation_type, const char * State_ref)
+{
+    char *string = (char*)malloc(500);
+    char *temp   = (char*)malloc(520);
+    sprintf(string, "%s/State_files/Tissue/Native_model_%s_BCL_%d_ISO_%.2f_ACh_%.2f_remodelling_%s_drug_%s_mut_%s_%s_%s_%s_%s_ref_%s_state.bin", PATH, Model, BCL, p[0].ISO, p[0].ACh, p[0].Remodelling, p[0].Agent, p[0].Mutation, Tissue_order, Tissue_model, Tissue_type, Orientation_type, State_ref);
+    sprintf(temp, "%s.tmp", string);
+
+    // Gather fields into arrays
+    long Nl = N;
+    double *data = new double[(long)Nstate_fields*Nl];
+    #pragma omp parallel for
+    for (long n = 0; n < Nl; n++)
+    {
+        const char *c = (const char*)&s[n];
+        for (int f = 0; f < Nstate_fields; f++) data[f*Nl + n] = *(const double*)(c + state_fields[f].offset);
+    }
+    unsigned long long checksum = state_checksum(data, Nstate_fields, Nl);
+
+    FILE *out = fopen(temp, "wb");
+    if (out == NULL)
+    {
+        printf("Cannot create state file %s\t does the folder exist?? Is your path %s correct?\n", string, PATH);
+        exit(1);
+    }
+    unsigned int endian = 0x01020304;
+    char model_name[64] = {0};
+    char field_name[32];
+    strncpy(model_name, Model, 63);
+    int reserved = 0;
+    fwrite("MSCSFSB1", 1, 8, out);
+    fwrite(&endian, sizeof(unsigned int), 1, out);
+    fwrite(&N, sizeof(int), 1, out);
+    fwrite(&Nstate_fields, sizeof(int), 1, out);
+    fwrite(&reserved, sizeof(int), 1, out);
+    fwrite(model_name, 1, 64, out);
+    for (int f = 0; f < Nstate_fields; f++)
+    {
+        memset(field_name, 0, 32);
+        strncpy(field_name, state_fields[f].name, 31);
+        fwrite(field_name, 1, 32, out);
+    }
+    fwrite(&checksum, sizeof(unsigned long long), 1, out);
+    fwrite(data, sizeof(double), (size_t)Nstate_fields*Nl, out);
+    fclose(out);
+    rename(temp, string);   // atomic replace; a partially written file is never left under the state name
+
+    delete [] data;
+    free(temp);
+    free(string);
+}
+
+void Read_state_tissue_native_whole_tissue_binary(State_variables *s, Cell_parameters *p, int BCL, const char * PATH, const char *Model, int N, const char* Tissue_order, const char* Tissue_model, const char* Tissue_type, const char *Orientation_type, const char * State_ref)
+{
+    char *string = (char*)malloc(500);
+    sprintf(string, "%s/State_files/Tissue/Native_model_%s_BCL_%d_ISO_%.2f_ACh_%.2f_remodelling_%s_drug_%s_mut_%s_%s_%s_%s_%s_ref_%s_state.bin", PATH, Model, BCL, p[0].ISO, p[0].ACh, p[0].Remodelling, p[0].Agent, p[0].Mutation, Tissue_order, Tissue_model, Tissue_type, Orientation_type, State_ref);
+
+    int fd = open(string, O_RDONLY);
+    if (fd < 0)
+    {
+        printf("Cannot open state file %s\t does the folder exist?? Is your path %s correct?\n", string, PATH);
+        exit(1);
+    }
+    struct stat st;
+    fstat(fd, &st);
+    size_t size = st.st_size;
+    const char *file = (const char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (file == MAP_FAILED || size < 88)
+    {
+        printf("ERROR: state file %s could not be read\n", string);
+        exit(1);
+    }
+
+    // Header
+    const char *c = file;
+    unsigned int endian;
+    int Nfile, Nfields;
+    char model_name[65] = {0};
+    if (strncmp(c, "MSCSFSB1", 8) != 0)
+    {
+        printf("ERROR: %s is not a binary tissue state file\n", string);
+        exit(1);
+    }
+    c += 8;
+    memcpy(&endian, c, sizeof(unsigned int));   c += sizeof(unsigned int);
+    memcpy(&Nfile, c, sizeof(int));             c += sizeof(int);
+    memcpy(&Nfields, c, sizeof(int));           c += sizeof(int);
+    c += sizeof(int);                           // reserved
+    memcpy(model_name, c, 64);                  c += 64;
+    if (endian != 0x01020304)
+    {
+        printf("ERROR: state file %s was written with a different byte order\n", string);
+        exit(1);
+    }
+    if (Nfile != N)
+    {
+        printf("ERROR: state file %s contains %d cells; tissue has %d cells. Was it written using the same tissue model?\n", string, Nfile, N);
+        exit(1);
+    }
+    if (strcmp(model_name, Model) != 0) printf("WARNING: state file %s was written by model %s; reading into %s\n", string, model_name, Model);
+
+    size_t data_offset = (c - file) + (size_t)Nfields*32 + sizeof(unsigned long long);
+    if (size != data_offset + (size_t)Nfields*N*sizeof(double))
+    {
+        printf("ERROR: state file %s is truncated or corrupt\n", string);
+        exit(1);
+    }
+
+    // Map file fields to struct offsets
+    int *field_index = new int[Nfields];
+    for (int f = 0; f < Nfields; f++)
+    {
+        char field_name[33] = {0};
+        memcpy(field_name, c + f*32, 32);
+        field_index[f] = -1;
+        for (int g = 0; g < Nstate_fields; g++) if (strcmp(field_name, state_fields[g].name) == 0) field_index[f] = g;
+        if (field_index[f] == -1) printf("WARNING: state field %s in %s is not used by this version and is ignored\n", field_name, string);
+    }
+    for (int g = 0; g < Nstate_fields; g++)
+    {
+        bool present = false;
+        for (int f = 0; f < Nfields; f++) if (field_index[f] == g) present = true;
+        if (present == false) printf("WARNING: state field %s is not in %s; initial condition kept\n", state_fields[g].name, string);
+    }
+    c += Nfields*32;
+
+    unsigned long long checksum;
+    memcpy(&checksum, c, sizeof(unsigned long long));
+    const double *data = (const double*)(file + data_offset);   // data offset is 8-byte aligned (88 + 32*Nfields + 8)
+    if (state_checksum(data, Nfields, N) != checksum)
+    {
+        printf("ERROR: checksum of state file %s does not match its contents\n", string);
+        exit(1);
+    }
+
+    // Scatter fields
+    long Nl = N;
+    #pragma omp parallel for
+    for (long n = 0; n < Nl; n++)
+    {
+        char *sc = (char*)&s[n];
+        for (int f = 0; f < Nfields; f++) if (field_index[f] >= 0) *(double*)(sc + state_fields[field_index[f]].offset) = data[f*Nl + n];
+
+        set_alternatively_named_states(&s[n]);
+    }
+
+    delete [] field_index;
+    munmap((void*)file, size);
+    free(string);
+}
+// End Binary whole tissue state ==============//|
+
 void Write_state_tissue_native_ave_tissue(State_variables s, Cell_parameters p, int BCL, const char * PATH, const char *Model, const char * State_ref)
 {
     FILE *out;
@@ -368,7 +494,7 @@ void Read_state_tissue_native_ave_tissue(State_variables *s, Cell_parameters p,
     FILE *in;
     char *string = (char*)malloc(500);
 
-    sprintf(string, "%s/State_files/Tissue/Native_ave_model_%s_BCL_%d_region_%s_ISO_%.2f_ACh_%.2f_remodelling_%s_drug_%s_mut_%s_env_%s_ref_%s_state.dat", PATH, Model, BCL, p.Celltype, p.ISO, p.ACh, p.Remodelling, p.Agent, p.Mutation, p.environment, State_ref);
+    state_filename_read(string, "ave", p, BCL, PATH, Model, 0, State_ref);
 
     in = fopen(string, "r");
 
@@ -408,7 +534,7 @@ void Read_state_phase(State_variables *s, Cell_parameters p, int BCL, const char
     FILE *in;
     char *string = (char*)malloc(500);
 
-    sprintf(string, "%s/State_files/phase_files/Native_model_%s_BCL_%d_region_%s_ISO_%.2f_ACh_%.2f_remodelling_%s_drug_%s_mut_%s_phase_%d_ref_%s_state.dat", PATH, Model, BCL, p.Celltype, p.ISO, p.ACh, p.Remodelling, p.Agent, p.Mutation, phase, State_ref);
+    state_filename_read(string, "phase", p, BCL, PATH, Model, phase, State_ref);
 
     in = fopen(string, "r");
 
@@ -424,3 +550,454 @@ void Read_state_phase(State_variables *s, Cell_parameters p, int BCL, const char
 // End phase ==================================//|
 // End Functions which set filename and call write/read state =========================//|
 
+// State cache ================================\\|
+// Per-node state reads into tissue (Read_state single_cell, ave or phase): each distinct file (model, celltype,
+// conditions and phase index) is read once, then its fields are copied to all nodes which use it.
+// Only fields stored in state files are copied, so other states keep their initial conditions as with a direct read
+void Read_state_tissue_native_cached(State_variables *s, Cell_parameters *p, int N, int BCL, const char * PATH, const char *type, int *phasemap, const char * State_ref, bool library, bool nearest)
+{
+    std::unordered_map<std::string, int> files;
+    std::string *filenames = new std::string[N];   // distinct files only (at most N)
+    int *node_file = new int[N];
+    int Nfiles = 0;
+    char string[500];
+
+    for (int n = 0; n < N; n++)
+    {
+        state_filename_read(string, type, p[n], BCL, PATH, p[n].Model, (phasemap == NULL) ? 0 : phasemap[n], State_ref);
+        std::unordered_map<std::string, int>::iterator it = files.find(string);
+        if (it != files.end()) node_file[n] = it->second;
+        else
+        {
+            files[string]       = Nfiles;
+            filenames[Nfiles]   = string;
+            node_file[n]        = Nfiles;
+            Nfiles++;
+        }
+    }
+
+    // Read each distinct file once
+    State_variables *file_state = new State_variables[Nfiles];
+    int *file_node = new int[Nfiles];
+    for (int n = N-1; n >= 0; n--) file_node[node_file[n]] = n;    // first node using each file (for its model)
+    // Library lookups are serial: a state not yet in the library is added to it (under the lock), and a missing state exits
+    if (library == true)
+    {
+        for (int f = 0; f < Nfiles; f++) Read_state_library(&file_state[f], p[file_node[f]], BCL, PATH, p[file_node[f]].Model, type, (phasemap == NULL) ? 0 : phasemap[file_node[f]], State_ref, nearest);
+    }
+    int missing = Nfiles;   // first file which cannot be opened; reported after the loop (no exit from worker threads)
+    #pragma omp parallel for schedule(dynamic)
+    for (int f = 0; f < Nfiles; f++)
+    {
+        if (library == true) continue;
+        FILE *in = fopen(filenames[f].c_str(), "r");
+        if (in == NULL)
+        {
+            #pragma omp critical(state_cache_missing)
+            if (f < missing) missing = f;
+            continue;
+        }
+        Read_state_variables_native(&file_state[f], in, p[file_node[f]].Model);
+        fclose(in);
+    }
+    if (missing < Nfiles)
+    {
+        printf("Cannot open state file %s\t does the folder exist?? Is your path %s correct?\n", filenames[missing].c_str(), PATH);
+        exit(1);
+    }
+    printf("\t%d distinct %s read for %d cells\n", Nfiles, (library == true) ? "library states" : "state files", N);
+
+    // Copy to nodes
+    #pragma omp parallel for
+    for (int n = 0; n < N; n++)
+    {
+        char *sn        = (char*)&s[n];
+        const char *sf  = (const char*)&file_state[node_file[n]];
+        for (int i = 0; i < Nstate_fields; i++) *(double*)(sn + state_fields[i].offset) = *(const double*)(sf + state_fields[i].offset);
+        set_alternatively_named_states(&s[n]);
+    }
+
+    delete [] file_state;
+    delete [] file_node;
+    delete [] node_file;
+    delete [] filenames;
+}
+// End State cache ============================//|
+
+// State library ==============================\\|
+// All per-cell states (single cell, ave tissue and phase) in one indexed binary file, PATH/State_files/State_library.bin
+// Layout: "MSCSFSL1", endian, Nfields, Nentries, reserved, field names (32 chars each), then entries sorted by
+// (key, BCL); each entry is a 184 char condition key, BCL, reserved and Nfields doubles.
+// Readers map the file read-only (once per process) and binary search; writers hold an flock on
+// State_library.lock and replace the file by rename, so any number of jobs can read while states are added
+#define STATE_LIBRARY_KEY 184
+
+typedef struct{
+    const char  *file;          // Mapped library (NULL if not present)
+    size_t      size;
+    int         Nfields;
+    int         Nentries;
+    size_t      entry_size;
+    const char  *entries;
+    int         *field_index;   // Library field -> state_fields index (-1 if unused)
+}State_library;
+
+static State_library state_library = {NULL, 0, 0, 0, 0, NULL, NULL};
+static bool state_library_mapped = false;
+
+// Condition key; as the state filenames, less PATH and BCL
+static void state_library_key(char *key, const char *type, Cell_parameters p, const char *Model, int phase, const char * State_ref)
+{
+    memset(key, 0, STATE_LIBRARY_KEY);
+    int length = snprintf(key, STATE_LIBRARY_KEY, "%s|%s|%s|%.2f|%.2f|%s|%s|%s|%s|%d|%s", type, Model, p.Celltype, p.ISO, p.ACh, p.Remodelling, p.Agent, p.Mutation, p.environment, phase, State_ref);
+    if (length < 0 || length >= STATE_LIBRARY_KEY)    // a truncated key could match a different condition
+    {
+        printf("ERROR: state library key \"%s...\" is longer than %d characters; shorten the state reference or use State_library Off\n", key, STATE_LIBRARY_KEY-1);
+        exit(1);
+    }
+}
+
+// Maps a library file and checks its header; false if it does not exist
+static bool state_library_open(const char *filename, State_library *lib)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    fstat(fd, &st);
+    lib->size = st.st_size;
+    lib->file = (const char*)mmap(NULL, lib->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    unsigned int endian = 0;
+    if (lib->file == MAP_FAILED || lib->size < 24 || strncmp(lib->file, "MSCSFSL1", 8) != 0)
+    {
+        printf("ERROR: %s is not a valid state library\n", filename);
+        exit(1);
+    }
+    memcpy(&endian, lib->file + 8, sizeof(unsigned int));
+    memcpy(&lib->Nfields, lib->file + 12, sizeof(int));
+    memcpy(&lib->Nentries, lib->file + 16, sizeof(int));
+    if (endian != 0x01020304)
+    {
+        printf("ERROR: state library %s was written with a different byte order\n", filename);
+        exit(1);
+    }
+    lib->entry_size = STATE_LIBRARY_KEY + 2*sizeof(int) + (size_t)lib->Nfields*sizeof(double);
+    lib->entries    = lib->file + 24 + (size_t)lib->Nfields*32;
+    if (lib->size != 24 + (size_t)lib->Nfields*32 + (size_t)lib->Nentries*lib->entry_size)
+    {
+        printf("ERROR: state library %s is truncated or corrupt\n", filename);
+        exit(1);
+    }
+    lib->field_index = new int[lib->Nfields];
+    for (int f = 0; f < lib->Nfields; f++)
+    {
+        char field_name[33] = {0};
+        memcpy(field_name, lib->file + 24 + f*32, 32);
+        lib->field_index[f] = -1;
+        for (int g = 0; g < Nstate_fields; g++) if (strcmp(field_name, state_fields[g].name) == 0) lib->field_index[f] = g;
+    }
+    return true;
+}
+
+static void state_library_close(State_library *lib)
+{
+    if (lib->file != NULL) munmap((void*)lib->file, lib->size);
+    delete [] lib->field_index;
+    lib->file = NULL;
+    lib->field_index = NULL;
+}
+
+// Index of first entry with (key, BCL) >= the one passed
+static int state_library_lower_bound(const State_library *lib, const char *key, int BCL)
+{
+    int lo = 0, hi = lib->Nentries;
+    while (lo < hi)
+    {
+        int mid = (lo + hi)/2;
+        const char *e = lib->entries + (size_t)mid*lib->entry_size;
+        int entry_BCL;
+        memcpy(&entry_BCL, e + STATE_LIBRARY_KEY, sizeof(int));
+        int cmp = strncmp(e, key, STATE_LIBRARY_KEY);
+        if (cmp < 0 || (cmp == 0 && entry_BCL < BCL)) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Entry for key at BCL; if nearest is true and BCL is not present, the entry for the same key with the closest BCL
+static const char *state_library_find(const State_library *lib, const char *key, int BCL, bool nearest, int *BCL_found)
+{
+    if (lib->file == NULL || lib->Nentries == 0) return NULL;
+    int i = state_library_lower_bound(lib, key, BCL);
+    const char *best = NULL;
+    int best_diff = 0;
+    for (int j = i-1; j <= i; j++) // candidates either side of the insertion point
+    {
+        if (j < 0 || j >= lib->Nentries) continue;
+        const char *e = lib->entries + (size_t)j*lib->entry_size;
+        if (strncmp(e, key, STATE_LIBRARY_KEY) != 0) continue;
+        int entry_BCL;
+        memcpy(&entry_BCL, e + STATE_LIBRARY_KEY, sizeof(int));
+        int diff = abs(entry_BCL - BCL);
+        if (diff != 0 && nearest == false) continue;
+        if (best == NULL || diff < best_diff) { best = e; best_diff = diff; *BCL_found = entry_BCL; }
+    }
+    return best;
+}
+
+// Adds (or replaces) one state; entries are re-written in the current field set
+void Write_state_library(State_variables s, Cell_parameters p, int BCL, const char * PATH, const char *Model, const char *type, int phase, const char * State_ref)
+{
+    char filename[500], temp[520], lockname[500], key[STATE_LIBRARY_KEY];
+    sprintf(filename, "%s/State_files/State_library.bin", PATH);
+    sprintf(lockname, "%s/State_files/State_library.lock", PATH);
+    sprintf(temp, "%s.%d.tmp", filename, (int)getpid());
+    state_library_key(key, type, p, Model, phase, State_ref);
+
+    int lock = open(lockname, O_RDWR | O_CREAT, 0644);
+    if (lock < 0)
+    {
+        printf("Cannot create state library lock %s\t does the folder exist?? Is your path %s correct?\n", lockname, PATH);
+        exit(1);
+    }
+    flock(lock, LOCK_EX);
+
+    State_library lib = {NULL, 0, 0, 0, 0, NULL, NULL};
+    bool exists = state_library_open(filename, &lib);
+    int i = exists ? state_library_lower_bound(&lib, key, BCL) : 0;
+    int entry_BCL = -1;
+    if (exists && i < lib.Nentries) memcpy(&entry_BCL, lib.entries + (size_t)i*lib.entry_size + STATE_LIBRARY_KEY, sizeof(int));
+    bool replace = (exists && i < lib.Nentries && entry_BCL == BCL && strncmp(lib.entries + (size_t)i*lib.entry_size, key, STATE_LIBRARY_KEY) == 0);
+    int Nentries = (exists ? lib.Nentries : 0) + (replace ? 0 : 1);
+
+    FILE *out = fopen(temp, "wb");
+    if (out == NULL)
+    {
+        printf("Cannot create state library %s\t does the folder exist?? Is your path %s correct?\n", temp, PATH);
+        exit(1);
+    }
+    unsigned int endian = 0x01020304;
+    int header[3] = {Nstate_fields, Nentries, 0};
+    char field_name[32];
+    fwrite("MSCSFSL1", 1, 8, out);
+    fwrite(&endian, sizeof(unsigned int), 1, out);
+    fwrite(header, sizeof(int), 3, out);
+    for (int f = 0; f < Nstate_fields; f++)
+    {
+        memset(field_name, 0, 32);
+        strncpy(field_name, state_fields[f].name, 31);
+        fwrite(field_name, 1, 32, out);
+    }
+
+    int entry_header[2];
+    double *data = new double[Nstate_fields];
+    for (int j = 0; j <= (exists ? lib.Nentries : 0); j++)
+    {
+        if (j == i) // new entry
+        {
+            const char *c = (const char*)&s;
+            for (int f = 0; f < Nstate_fields; f++) data[f] = *(const double*)(c + state_fields[f].offset);
+            entry_header[0] = BCL; entry_header[1] = 0;
+            fwrite(key, 1, STATE_LIBRARY_KEY, out);
+            fwrite(entry_header, sizeof(int), 2, out);
+            fwrite(data, sizeof(double), Nstate_fields, out);
+            if (replace == true) continue;
+        }
+        if (j == lib.Nentries || exists == false) continue;
+        const char *e = lib.entries + (size_t)j*lib.entry_size;
+        const double *e_data = (const double*)(e + STATE_LIBRARY_KEY + 2*sizeof(int));
+        for (int f = 0; f < Nstate_fields; f++) data[f] = 0;
+        for (int f = 0; f < lib.Nfields; f++) if (lib.field_index[f] >= 0) data[lib.field_index[f]] = e_data[f];
+        fwrite(e, 1, STATE_LIBRARY_KEY + 2*sizeof(int), out);
+        fwrite(data, sizeof(double), Nstate_fields, out);
+    }
+    delete [] data;
+    fflush(out);
+    fsync(fileno(out));
+    fclose(out);
+    rename(temp, filename);     // readers which have the old file mapped are unaffected
+
+    if (exists) state_library_close(&lib);
+    flock(lock, LOCK_UN);
+    close(lock);
+}
+
+// Reads one state. If it is not in the library the text state file is read and added; if neither exists and
+// nearest is true, the state for the same conditions at the closest BCL is used
+void Read_state_library(State_variables *s, Cell_parameters p, int BCL, const char * PATH, const char *Model, const char *type, int phase, const char * State_ref, bool nearest)
+{
+    char filename[500], key[STATE_LIBRARY_KEY];
+    sprintf(filename, "%s/State_files/State_library.bin", PATH);
+    state_library_key(key, type, p, Model, phase, State_ref);
+
+    #pragma omp critical(state_library)
+    {
+        if (state_library_mapped == false) state_library_open(filename, &state_library);
+        state_library_mapped = true;
+    }
+
+    int BCL_found = BCL;
+    const char *e = state_library_find(&state_library, key, BCL, false, &BCL_found);
+    if (e == NULL)
+    {
+        // Text state file, added to the library so subsequent reads are indexed
+        char string[500];
+        state_filename_read(string, type, p, BCL, PATH, Model, phase, State_ref);
+        FILE *in = fopen(string, "r");
+        if (in != NULL)
+        {
+            Read_state_variables_native(s, in, Model);
+            fclose(in);
+            Write_state_library(*s, p, BCL, PATH, Model, type, phase, State_ref);
+            return;
+        }
+        if (nearest == true) e = state_library_find(&state_library, key, BCL, true, &BCL_found);
+        if (e == NULL)
+        {
+            printf("ERROR: state %s at BCL %d is not in the state library %s or in %s\n", key, BCL, filename, string);
+            exit(1);
+        }
+        printf("WARNING: state %s at BCL %d not found; using nearest BCL %d from the state library\n", key, BCL, BCL_found);
+    }
+
+    const double *data = (const double*)(e + STATE_LIBRARY_KEY + 2*sizeof(int));
+    char *c = (char*)s;
+    for (int f = 0; f < state_library.Nfields; f++) if (state_library.field_index[f] >= 0) *(double*)(c + state_fields[state_library.field_index[f]].offset) = data[f];
+    set_alternatively_named_states(s);
+}
+
+// State file or library entry written by a single cell Write_state || runs with the same target overwrite each other
+void State_write_target_single_cell(char *string, Cell_parameters p, int BCL, const char * PATH, const char *Model, const char * State_ref, bool library)
+{
+    if (library == false)
+    {
+        state_filename_read(string, "single_cell", p, BCL, PATH, Model, 0, State_ref);
+        return;
+    }
+    char key[STATE_LIBRARY_KEY];
+    state_library_key(key, "single_cell", p, Model, 0, State_ref);
+    sprintf(string, "%s/State_files/State_library.bin entry %s at BCL %d", PATH, key, BCL);
+}
+// End State library ==========================//|
+
+// Checkpoint =================================\\|
+// Layout: "MSCSFCP3", N, sizeof(State_variables), sizeof(Model_variables), dt, Checkpoint_parameters, then the raw
+// State, Variables and Vm arrays and Nextra further values (map state). Written to a temporary file, synced and renamed,
+// so the previous checkpoint remains intact if the run is killed while writing
+void Write_checkpoint_tissue(const char *directory, Checkpoint_parameters cp, State_variables *s, Model_variables *v, double *Vm, int N, double dt, const double *extra, long Nextra)
+{
+    char file[500], temp[520];
+    sprintf(file, "%s/Checkpoint.bin", directory);
+    sprintf(temp, "%s.tmp", file);
+
+    FILE *out = fopen(temp, "wb");
+    if (out == NULL)
+    {
+        printf("ERROR: cannot write checkpoint %s\n", temp);
+        exit(1);
+    }
+    int sizes[3] = {N, (int)sizeof(State_variables), (int)sizeof(Model_variables)};
+    bool ok = fwrite("MSCSFCP3", 1, 8, out) == 8;
+    ok = ok && fwrite(sizes, sizeof(int), 3, out) == 3;
+    ok = ok && fwrite(&dt, sizeof(double), 1, out) == 1;
+    ok = ok && fwrite(&cp, sizeof(Checkpoint_parameters), 1, out) == 1;
+    ok = ok && fwrite(s, sizeof(State_variables), N, out) == (size_t)N;
+    ok = ok && fwrite(v, sizeof(Model_variables), N, out) == (size_t)N;
+    ok = ok && fwrite(Vm, sizeof(double), N, out) == (size_t)N;
+    ok = ok && (Nextra == 0 || fwrite(extra, sizeof(double), Nextra, out) == (size_t)Nextra);
+    ok = ok && fflush(out) == 0 && fsync(fileno(out)) == 0;
+    if (fclose(out) != 0) ok = false;
+    if (ok == false || rename(temp, file) != 0)
+    {
+        printf("ERROR: writing checkpoint %s failed; the previous checkpoint is kept\n", file);
+        remove(temp);
+        exit(1);
+    }
+}
+
+// Reads only the counters and output file lengths (needed before output files are opened); false if there is no checkpoint
+bool Read_checkpoint_tissue_header(const char *directory, Checkpoint_parameters *cp)
+{
+    char file[500], magic[8];
+    int sizes[3];
+    double dt;
+    sprintf(file, "%s/Checkpoint.bin", directory);
+    FILE *in = fopen(file, "rb");
+    if (in == NULL) return false;
+    bool valid = (fread(magic, 1, 8, in) == 8 && strncmp(magic, "MSCSFCP3", 8) == 0);
+    valid = valid && fread(sizes, sizeof(int), 3, in) == 3 && fread(&dt, sizeof(double), 1, in) == 1;
+    valid = valid && fread(cp, sizeof(Checkpoint_parameters), 1, in) == 1;
+    fclose(in);
+    if (valid == false)
+    {
+        printf("ERROR: %s is not a valid checkpoint file\n", file);
+        exit(1);
+    }
+    return true;
+}
+
+void Read_checkpoint_tissue(const char *directory, Checkpoint_parameters *cp, State_variables *s, Model_variables *v, double *Vm, int N, double dt)
+{
+    char file[500], magic[8];
+    int sizes[3];
+    double dt_file;
+    sprintf(file, "%s/Checkpoint.bin", directory);
+    FILE *in = fopen(file, "rb");
+    if (in == NULL)
+    {
+        printf("ERROR: Cannot open checkpoint file %s\n", file);
+        exit(1);
+    }
+    if (fread(magic, 1, 8, in) != 8 || fread(sizes, sizeof(int), 3, in) != 3 || fread(&dt_file, sizeof(double), 1, in) != 1)
+    {
+        printf("ERROR: checkpoint %s is truncated\n", file);
+        exit(1);
+    }
+    if (sizes[0] != N || sizes[1] != (int)sizeof(State_variables) || sizes[2] != (int)sizeof(Model_variables) || dt_file != dt)
+    {
+        printf("ERROR: checkpoint %s (N = %d, dt = %f) does not match this simulation (N = %d, dt = %f) or code version; pass the same arguments as the original run\n", file, sizes[0], dt_file, N, dt);
+        exit(1);
+    }
+    size_t read = fread(cp, sizeof(Checkpoint_parameters), 1, in);
+    read += fread(s, sizeof(State_variables), N, in);
+    read += fread(v, sizeof(Model_variables), N, in);
+    read += fread(Vm, sizeof(double), N, in);
+    fclose(in);
+    if (read != 1 + 3*(size_t)N)
+    {
+        printf("ERROR: checkpoint %s is truncated\n", file);
+        exit(1);
+    }
+}
+
+// The Nextra values after the arrays (read once their size is known, after Read_checkpoint_tissue())
+void Read_checkpoint_tissue_extra(const char *directory, double *extra, long Nextra, int N)
+{
+    char file[500];
+    sprintf(file, "%s/Checkpoint.bin", directory);
+    FILE *in = fopen(file, "rb");
+    long offset = 8 + 3*sizeof(int) + sizeof(double) + sizeof(Checkpoint_parameters) + (long)N*(sizeof(State_variables) + sizeof(Model_variables) + sizeof(double));
+    if (in == NULL || fseek(in, offset, SEEK_SET) != 0 || fread(extra, sizeof(double), Nextra, in) != (size_t)Nextra || fgetc(in) != EOF)
+    {
+        printf("ERROR: checkpoint %s does not hold the map state of this simulation; pass the same arguments as the original run\n", file);
+        exit(1);
+    }
+    fclose(in);
+}
+
+// Cuts an appended output back to its length at the checkpoint; the file must be at least that long
+void Truncate_checkpoint_output(const char *file, long length)
+{
+    struct stat st;
+    if (stat(file, &st) != 0 || (long)st.st_size < length)
+    {
+        printf("ERROR: output %s is missing or shorter than at the checkpoint (%ld bytes); cannot restart\n", file, length);
+        exit(1);
+    }
+    if (truncate(file, length) != 0)
+    {
+        printf("ERROR: cannot truncate %s to its length at the checkpoint\n", file);
+        exit(1);
+    }
+}
+// End Checkpoint =============================//|
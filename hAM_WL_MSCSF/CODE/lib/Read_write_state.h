@@ -81,10 +81,24 @@ void Read_state_single_cell_native(State_variables *s, Cell_parameters p, int BC
 
 void Write_state_tissue_native_whole_tissue(State_variables *s, Cell_parameters *p, int BCL, const char * PATH, const char *Model, int N, const char* Tissue_order, const char* Tissue_model, const char* Tissue_type, const char* Orientation_type, const char * State_ref);
 void Read_state_tissue_native_whole_tissue(State_variables *s, Cell_parameters *p, int BCL, const char * PATH, const char *Model, int N, const char* Tissue_order, const char* Tissue_model, const char* Tissue_type, const char* Orientation_type, const char * State_ref);
+void Write_state_tissue_native_whole_tissue_binary(State_variables *s, Cell_parameters *p, int BCL, const char * PATH, const char *Model, int N, const char* Tissue_order, const char* Tissue_model, const char* Tissue_type, const char* Orientation_type, const char * State_ref);
+void Read_state_tissue_native_whole_tissue_binary(State_variables *s, Cell_parameters *p, int BCL, const char * PATH, const char *Model, int N, const char* Tissue_order, const char* Tissue_model, const char* Tissue_type, const char* Orientation_type, const char * State_ref);
 void Write_state_tissue_native_ave_tissue(State_variables s, Cell_parameters p, int BCL, const char * PATH, const char *Model, const char * State_ref);
 void Read_state_tissue_native_ave_tissue(State_variables *s, Cell_parameters p, int BCL, const char * PATH, const char *Model, const char * State_ref);
 
 void Write_state_phase(State_variables s, Cell_parameters p, int BCL, const char * PATH, const char *Model, int phase, const char * State_ref);
 void Read_state_phase(State_variables *s, Cell_parameters p, int BCL, const char * PATH, const char *Model, int phase, const char * State_ref);
 
+void Read_state_tissue_native_cached(State_variables *s, Cell_parameters *p, int N, int BCL, const char * PATH, const char *type, int *phasemap, const char * State_ref, bool library, bool nearest);
+
+void Write_state_library(State_variables s, Cell_parameters p, int BCL, const char * PATH, const char *Model, const char *type, int phase, const char * State_ref);
+void Read_state_library(State_variables *s, Cell_parameters p, int BCL, const char * PATH, const char *Model, const char *type, int phase, const char * State_ref, bool nearest);
+void State_write_target_single_cell(char *string, Cell_parameters p, int BCL, const char * PATH, const char *Model, const char * State_ref, bool library);
+
+void Write_checkpoint_tissue(const char *directory, Checkpoint_parameters cp, State_variables *s, Model_variables *v, double *Vm, int N, double dt, const double *extra, long Nextra);
+bool Read_checkpoint_tissue_header(const char *directory, Checkpoint_parameters *cp);
+void Read_checkpoint_tissue(const char *directory, Checkpoint_parameters *cp, State_variables *s, Model_variables *v, double *Vm, int N, double dt);
+void Read_checkpoint_tissue_extra(const char *directory, double *extra, long Nextra, int N);
+void Truncate_checkpoint_output(const char *file, long length);
+
 #endif
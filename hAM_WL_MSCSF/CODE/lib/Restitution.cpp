@@ -0,0 +1,302 @@
+// Source code associated with  ===========================  //
+// "Multi-scale cardiac simulation framework" =============  //
+// For simulation of cardiac cellular and tissue dynamics =  //
+// from the spatial cellular to full organ scales. ========  //
+// With implementation of multiple, published cell models =  //
+// as well as novel models developed in my lab. ===========  //
+// ========================================================  //
+// This file: Single cell restitution protocols: ==========  //
+// S1-S2 from an in-memory snapshot and dynamic ===========  //
+// (stepped BCL) restitution. =============================  //
+// ========================================================  //
+// GNU 3 LICENSE TEXT =====================================  //
+// COPYRIGHT (C) 2016-2019 MICHAEL A. COLMAN ==============  //
+// THIS PROGRAM IS FREE SOFTWARE: YOU CAN REDISTRIBUTE IT =  //
+// AND/OR MODIFY IT UNDER THE TERMS OF THE GNU GENERAL ====  //
+// PUBLIC LICENSE AS PUBLISHED BY THE FREE SOFTWARE =======  //
+// FOUNDATION, EITHER VERSION 3 OF THE LICENSE, OR (AT YOUR  //
+// OPTION) ANY LATER VERSION. =============================  //
+// THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE=  //
+// USEFUL, BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE =====  //
+// IMPLIED WARRANTY OF MERCHANTABILITY OR FITNESS FOR A ===  //
+// PARTICULAR PURPOSE.  SEE THE GNU GENERAL PUBLIC LICENSE=  //
+// FOR MORE DETAILS. ======================================  //
+// YOU SHOULD HAVE RECEIVED A COPY OF THE GNU GENERAL =====  //
+// PUBLIC LICENSE ALONG WITH THIS PROGRAM.  IF NOT, SEE ===  //
+// <https://www.gnu.org/licenses/>. =======================  //
+// ========================================================  //
+// ADDITIONAL LICENSE TEXT ================================  //
+// THIS SOFTWARE IS PROVIDED OPEN SOURCE AND MAY BE FREELY=  //
+// USED, DISTRIBUTED AND UPDATED, PROVIDED: ===============  //
+//  (i) THE APPROPRIATE WORK(S) IS(ARE) CITED. THIS =======  //
+//      PERTAINS TO THE CITATION OF COLMAN 2019 PLOS COMP =  //
+//      BIOL (FOR THIS IMPLEMTATION) AND ALL WORKS ========  //
+//      ASSOCIATED WITH THE SPECIFIC MODELS AND COMPONENTS=  //
+//      USED IN PARTICULAR SIMULATIONS. IT IS THE USER'S ==  //
+//      RESPONSIBILITY TO ENSURE ALL RELEVANT WORKS ARE ===  //
+//      CITED. PLEASE SEE FULL DOCUMENTATION AND ON-SCREEN=  //
+//      DISCLAIMER OUTPUTS FOR A GUIDE. ===================  //
+//  (ii) ALL OF THIS TEXT IS RETAINED WITHIN OR ASSOCIATED=  //
+//      WITH THE SOURCE CODE AND/OR BINARY FORM OF THE ====  //
+//      SOFTWARE. =========================================  //
+// ========================================================  //
+// ANY INTENDED COMMERCIAL USE OF THIS SOFTWARE MUST BE BY   //
+// EXPRESS PERMISSION OF MICHAEL A COLMAN ONLY. IN NO EVENT  //
+// ARE THE COPYRIGHT HOLDERS LIABLE FOR ANY DIRECT, =======  //
+// INDIRECT INCIDENTAL, SPECIAL, EXEMPLARY OR CONSEQUENTIAL  //
+// DAMAGES ASSOCIATED WITH USE OF THIS SOFTWARE ===========  //
+// ========================================================  //
+// THIS SOFTWARE CONTAINS IMPLEMENTATIONS OF MODELS AND ===  //
+// COMPONENTS WHICH I (MICHAEL COLMAN) DID NOT DEVELOP.====  //
+// ALL OF THESE COMPONENTS HAVE BEEN CODED FROM PROVIDED ==  //
+// SOURCE CODE OR INFORMATION IN THE PUBLICATIONS. ========  //
+// I CLAIM NO RIGHTS OR INTELLECTUAL PROPERTY OWNERSHIP ===  //
+// FOR THESE MODELS AND COMPONENTS, OTHER THAN THEIR ======  //
+// SPECIFIC IMPLEMENTATION IN THIS CODE PACKAGE. FURTHER TO  //
+// THE ABOVE STATEMENT, ANY INDTENDED COMMERCIAL USE OF ===  //
+// THOSE COMPONENTS MUST BE BY EXPRESS PERMISSION OF THE ==  //
+// ORIGINAL COPYRIGHT HOLDERS. ============================  //
+// WHERE IMPLEMENTED FROM PROVIDED CODE, ANY DISCLAIMERS ==  //
+// PRESENT IN THE ORIGINAL CODE HAVE BEEN RETAINED IN THE =  //
+// RELEVANT FILE. =========================================  //
+// ========================================================  //
+// Contact: m.a.colman@leeds.ac.uk ========================  //
+// For updates, corrections etc, please check: ============  //
+// 1. http://physicsoftheheart.com/ =======================  //
+// 2. https://github.com/michaelcolman ====================  //
+// ========================================================  //
+
+#include "Restitution.h"
+#include "Batch.h"
+#include "Structs.h"
+#include "Model.h"
+#include "Read_write_state.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// Function list ================================================================================\\|
+//	S1-S2 restitution
+//	    pace_to_snapshot()
+//	    run_S2_from_snapshot()
+//	    run_S1S2_restitution()
+//	
+//	Dynamic restitution
+//	    read_BCL_list()
+//	    run_dynamic_restitution()
+// End Function list ============================================================================//|
+
+// S1-S2 restitution ============================================================================\\|
+// Paces up to (not including) the last S1, or to the first beat boundary after steady state is detected,
+// and stores the cell there; every S2 interval is then run from this snapshot
+void pace_to_snapshot(Simulation_parameters Sim, Cell_parameters Params, const char *PATH, Single_cell_snapshot *snap)
+{
+	Sim.S2_CL = 0; // S1 only
+	initialise_single_cell_native(&Sim, &Params, PATH, &snap->State, &snap->Variables, &snap->Vm);	// lib/Batch.cpp
+
+	Steady_state_monitor Steady;
+	steady_state_setup(&Steady, Sim);						// lib/Model.c
+	bool steady_state_on	= (strcmp(Sim.Steady_state, "On") == 0);
+	int  BCL_int			= Sim.BCL * (int)(1/Sim.dt);
+	int  last_S1_int		= (Sim.NBeats-1) * BCL_int;
+
+	double sim_time			= 0.0;
+	int iteration_counter	= 0;
+	while (iteration_counter < last_S1_int)
+	{
+		step_single_cell_native(&Sim, &Params, &snap->Variables, &snap->State, &snap->Vm, sim_time, iteration_counter);	// lib/Batch.cpp
+		if (steady_state_on == true && snap->Variables.t_ex == sim_time) steady_state_check(&Steady, snap->Variables, snap->State.Nai);
+		iteration_counter++;
+		sim_time += Sim.dt;
+		if (Steady.converged == true && iteration_counter%BCL_int == 0) break;
+	}
+	snap->sim_time			= sim_time;
+	snap->iteration_counter	= iteration_counter;
+	snap->NBeats			= iteration_counter/BCL_int + 1;	// S1 beats including the last, which is applied from the snapshot
+}
+
+// Last S1 and one S2 from the snapshot || stops once the S2 beat has repolarised (APD90) or after window ms
+// row: S2, response, APD90, APD90 S1, Vamp, Vamp S1, dvdt_max, dvdt_max S1
+void run_S2_from_snapshot(Simulation_parameters Sim, Cell_parameters Params, Single_cell_snapshot *snap, int S2, double window, double *row)
+{
+	State_variables State		= snap->State;
+	Model_variables Variables	= snap->Variables;
+	double Vm					= snap->Vm;
+
+	// Protocol as set_simulation_settings for NS2 = 1, with the snapshot beat count
+	Sim.NBeats		= snap->NBeats;
+	Sim.Paced_time	= (Sim.NBeats-1) * Sim.BCL + 5;
+	Sim.S2_CL		= S2;
+	Sim.NS2			= 1;
+	Sim.S2_time		= Sim.NS2 * Sim.S2_CL + Sim.Paced_time;
+	stimulus_setup(Params, &Variables, Sim.dt, Sim.BCL, Sim.S2_CL, Sim.Paced_time);	// lib/Model.c
+
+	double sim_time			= snap->sim_time;
+	int iteration_counter	= snap->iteration_counter;
+	double t_S2				= -1;	// time S2 was applied
+	while (sim_time <= Sim.S2_time + window)
+	{
+		step_single_cell_native(&Sim, &Params, &Variables, &State, &Vm, sim_time, iteration_counter);	// lib/Batch.cpp
+		if (t_S2 < 0 && Variables.S2_stimflag == true) t_S2 = sim_time;
+		iteration_counter++;
+		sim_time += Sim.dt;
+		if (t_S2 >= 0 && Variables.t_ex >= t_S2 && Variables.ex_switch == 0 && Variables.APD_p_switch[8] == 1) break;
+	}
+
+	// Excited by S2 if the last excitation followed it; otherwise the final beat is still the last S1
+	bool excited	= (t_S2 >= 0 && Variables.t_ex >= t_S2);
+	row[0]			= S2;
+	row[2]			= excited ? Variables.APD_p[8] : 0;
+	row[3]			= excited ? Variables.APD_p_prev[8] : Variables.APD_p[8];
+	row[4]			= excited ? Variables.Vamp : 0;
+	row[5]			= excited ? Variables.Vamp_prev : Variables.Vamp;
+	row[6]			= excited ? Variables.dvdt_max : 0;
+	row[7]			= excited ? Variables.dvdt_max_prev : Variables.dvdt_max;
+	row[1]			= (row[4] >= 0.8*row[5]) ? 1 : 0;	// response: S2 amplitude at least 80% of S1
+}
+
+void run_S1S2_restitution(Argument_parameters *Argin, const char *PATH, const char *directory, const char *results_directory)
+{
+	Simulation_parameters	Sim;
+	Cell_parameters			Params;
+	set_single_cell_native(Argin, &Sim, &Params);	// lib/Batch.cpp
+	if (Sim.NBeats < 1)
+	{
+		printf("ERROR: S1-S2 restitution requires at least one S1 beat (NBeats)\n");
+		exit(1);
+	}
+
+	// S2 intervals, from start to end (either direction)
+	int step	= abs(Argin->S2_range_step);
+	int sign	= (Argin->S2_range_end >= Argin->S2_range_start) ? 1 : -1;
+	int NS2		= abs(Argin->S2_range_end - Argin->S2_range_start)/step + 1;
+
+	Single_cell_snapshot snap;
+	pace_to_snapshot(Sim, Params, PATH, &snap);
+	printf("Paced to last S1 (beat %d) at %.0f ms; running %d S2 intervals from snapshot\n", snap.NBeats, snap.sim_time, NS2);
+
+	double *rows = new double[NS2*8];
+	#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < NS2; i++) run_S2_from_snapshot(Sim, Params, &snap, Argin->S2_range_start + sign*i*step, 1000, &rows[i*8]);
+
+	// Restitution table and ERP (longest S2 without a response)
+	char filename[500];
+	sprintf(filename, "%s/Restitution_S1S2.dat", results_directory);
+	FILE *out = fopen(filename, "w");
+	if (out == NULL)
+	{
+		printf("ERROR: Cannot create %s\n", filename);
+		exit(1);
+	}
+	fprintf(out, "# S2 response APD90_S2 APD90_S1 Vamp_S2 Vamp_S1 dvdt_max_S2 dvdt_max_S1\n");
+	int ERP = -1;
+	for (int i = 0; i < NS2; i++)
+	{
+		double *row = &rows[i*8];
+		fprintf(out, "%d %d %f %f %f %f %f %f\n", (int)row[0], (int)row[1], row[2], row[3], row[4], row[5], row[6], row[7]);
+		if (row[1] == 0 && (int)row[0] > ERP) ERP = (int)row[0];
+	}
+	fclose(out);
+	printf("S1-S2 restitution written to %s\n", filename);
+
+	if (ERP >= 0) printf("ERP = %d ms (BCL = %d ms)\n", ERP, Sim.BCL);
+	else printf("ERP < %d ms: all S2 intervals elicited a response (BCL = %d ms)\n", (sign > 0) ? Argin->S2_range_start : Argin->S2_range_end, Sim.BCL);
+	sprintf(filename, "%s/ERP_log.dat", directory);
+	out = fopen(filename, "a");    // Note: Appended, not overwritten
+	fprintf(out, "%d %d %d\n", Sim.BCL, ERP, snap.NBeats);
+	fclose(out);
+
+	delete [] rows;
+}
+// End S1-S2 restitution ========================================================================//|
+
+// Dynamic restitution ==========================================================================\\|
+// One continuous simulation: BCL is stepped down through a list; at each BCL the cell is paced until steady
+// state (or NBeats beats) and the final beat measured, so pre-pacing is only needed once
+std::vector<int> read_BCL_list(const char *list_in)
+{
+	std::vector<int> BCLs;
+	char list[1000];
+	strncpy(list, list_in, 999);
+	list[999] = 0;
+	char *save;
+	for (char *t = strtok_r(list, ",", &save); t != NULL; t = strtok_r(NULL, ",", &save))
+	{
+		int BCL = atoi(t);
+		if (BCL <= 0)
+		{
+			printf("ERROR: \"%s\" is not a valid Dynamic_BCLs entry; pass a comma separated list of BCLs in ms (e.g. 1000,800,600)\n", t);
+			exit(1);
+		}
+		BCLs.push_back(BCL);
+	}
+	return BCLs;
+}
+
+void run_dynamic_restitution(Argument_parameters *Argin, const char *PATH, const char *directory, const char *results_directory)
+{
+	std::vector<int> BCLs = read_BCL_list(Argin->Dynamic_BCLs);
+	int NBCL = (int)BCLs.size();
+
+	// Initial conditions and state at the first BCL
+	Simulation_parameters	Sim;
+	Cell_parameters			Params;
+	Argin->BCL		= BCLs[0];
+	Argin->BCL_arg	= true;
+	set_single_cell_native(Argin, &Sim, &Params);	// lib/Batch.cpp
+	Sim.S2_CL		= 0;
+	State_variables		State;
+	Model_variables		Variables;
+	double				Vm;
+	initialise_single_cell_native(&Sim, &Params, PATH, &State, &Variables, &Vm);	// lib/Batch.cpp
+
+	char filename[500];
+	sprintf(filename, "%s/Restitution_dynamic.dat", results_directory);
+	FILE *out = fopen(filename, "w");
+	if (out == NULL)
+	{
+		printf("ERROR: Cannot create %s\n", filename);
+		exit(1);
+	}
+	fprintf(out, "# BCL beats steady APD30 APD50 APD70 APD90 dvdt_max Vmin Vmax Vamp CaT_min CaT_max CaSR_min CaSR_max\n");
+
+	double sim_time = 0.0;
+	for (int b = 0; b < NBCL; b++)
+	{
+		// Stimulus restarts at the new BCL; stage_counter is the step within this BCL, so S1 falls on its multiples
+		Sim.BCL			= BCLs[b];
+		int  BCL_int	= Sim.BCL * (int)(1/Sim.dt);
+		int  stage_end	= Sim.NBeats * BCL_int;
+		Sim.Paced_time	= sim_time + Sim.NBeats * Sim.BCL;
+		stimulus_setup(Params, &Variables, Sim.dt, Sim.BCL, 0, Sim.Paced_time);	// lib/Model.c
+
+		Steady_state_monitor Steady;
+		steady_state_setup(&Steady, Sim);					// lib/Model.c
+		int stage_counter = 0;
+		while (stage_counter < stage_end)
+		{
+			step_single_cell_native(&Sim, &Params, &Variables, &State, &Vm, sim_time, stage_counter);	// lib/Batch.cpp
+			if (Variables.t_ex == sim_time && stage_counter > 0) steady_state_check(&Steady, Variables, State.Nai);
+			stage_counter++;
+			sim_time += Sim.dt;
+			if (Steady.converged == true && stage_counter%BCL_int == 0) break;
+		}
+
+		// Final beat at this BCL || as run_single_cell_native()
+		fprintf(out, "%d %d %d %f %f %f %f %f %f %f %f %f %f %f %f\n", Sim.BCL, stage_counter/BCL_int, (Steady.converged == true) ? 1 : 0,
+				Variables.APD_p[2], Variables.APD_p[4], Variables.APD_p[6], Variables.APD_p[8], Variables.dvdt_max,
+				Variables.Vmin_prev, Variables.Vmax, Variables.Vamp, 1e3*Variables.CaT_min, 1e3*Variables.CaT_max, Variables.CaSR_min, Variables.CaSR_max);
+		fflush(out);
+		printf("BCL = %d ms: %d beats (%s), APD90 = %.2f ms\n", Sim.BCL, stage_counter/BCL_int, (Steady.converged == true) ? "steady state" : "beat limit", Variables.APD_p[8]);
+
+		if (strcmp(Sim.Write_state, "On") == 0)
+		{
+			if (strcmp(Sim.State_library, "On") == 0) Write_state_library(State, Params, Sim.BCL, PATH, Params.Model, "single_cell", 0, Sim.state_reference_write); // lib/Read_write_state.c
+			else Write_state_single_cell_native(State, Params, Sim.BCL, PATH, Params.Model, Sim.state_reference_write); // lib/Read_write_state.c
+		}
+	}
+	fclose(out);
+	printf("Dynamic restitution written to %s\n", filename);
+}
+// End Dynamic restitution ======================================================================//|
@@ -74,6 +74,11 @@
 #include <fstream>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <omp.h>
 
 // Function list ================================================================================\\|
 //	Array allocation
@@ -83,6 +88,7 @@
 //	    SC_array_deallocation()
 //	
 //	Read geometry/maps
+//	    load_values_file()
 //	    read_geo_file()
 //	    read_map_file()
 //	    read_map_file_double()
@@ -110,6 +116,7 @@ void SC_set_array_sizes(SC_variables *sc, int NX, int NY, int NZ)
 	sc->NX = NX;
 	sc->NY = NY;
 	sc->NZ = NZ;
+	sc->input_binary_write = false;	// default; set from arguments in tissue models
 }
 // End set array sizes ============================================//|
 
@@ -316,47 +323,194 @@ void SC_array_deallocation(SC_variables *sc)
 // End Allocate and deallocate spatial arrays ===================================================//|
 
 // Read geometry/maps from file into arrays =====================================================\\|
+
+// Fast value loader ==============================================\\|
+// Geometry, map and fibre files are whitespace separated text of NX*NY*NZ values. These are
+// memory-mapped and parsed in parallel chunks; a binary copy ("<file>.bin": "MSCSFBIN", long count,
+// count doubles) is used in preference where present, and written if sc.input_binary_write is set
+
+// Parses one number from [c, end); fast path is exact for mantissas < 2^53 and <= 22 decimals, else strtod
+static inline double parse_value(const char *c, const char *end)
+{
+	static const double pow10[23] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+	const char *start = c;
+	bool neg = false;
+	if (*c == '-' || *c == '+') { neg = (*c == '-'); c++; }
+
+	unsigned long long mant = 0;
+	int digits = 0, decimals = 0;
+	while (c < end && *c >= '0' && *c <= '9') { mant = mant*10 + (*c - '0'); digits++; c++; }
+	if (c < end && *c == '.')
+	{
+		c++;
+		while (c < end && *c >= '0' && *c <= '9') { mant = mant*10 + (*c - '0'); digits++; decimals++; c++; }
+	}
+	if (c == end || *c == ' ' || *c == '\n' || *c == '\t' || *c == '\r')
+	{
+		if (digits <= 15 && decimals <= 22)
+		{
+			double v = (double)mant / pow10[decimals];
+			return neg ? -v : v;
+		}
+	}
+	// exponents, long mantissas, nan/inf etc
+	char token[64];
+	int len = 0;
+	for (c = start; c < end && len < 63 && *c != ' ' && *c != '\n' && *c != '\t' && *c != '\r'; c++) token[len++] = *c;
+	token[len] = '\0';
+	return strtod(token, NULL);
+}
+
+static inline bool is_space(char c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r'; }
+
+// Reads Nvalues numbers from filename into values; returns false if the file cannot be opened
+// With use_binary, <filename>.bin is read in preference when its header matches the text file (size, mtime) and
+// Nvalues, and is (re)written after a text read otherwise; binary copies are neither read nor written without it
+bool load_values_file(const char *filename, double *values, long Nvalues, bool use_binary)
+{
+	char binname[1000];
+	sprintf(binname, "%s.bin", filename);
+
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	fstat(fd, &st);
+	size_t size = st.st_size;
+	long long source[2] = {(long long)st.st_size, (long long)st.st_mtime}; // text file the binary copy was made from
+
+	// Binary copy
+	FILE *bin = (use_binary == true) ? fopen(binname, "rb") : NULL;
+	if (bin != NULL)
+	{
+		char magic[8];
+		long count = 0;
+		long long made_from[2];
+		if (fread(magic, 1, 8, bin) == 8 && strncmp(magic, "MSCSFBN2", 8) == 0 && fread(&count, sizeof(long), 1, bin) == 1 && count == Nvalues
+			&& fread(made_from, sizeof(long long), 2, bin) == 2 && made_from[0] == source[0] && made_from[1] == source[1])
+		{
+			size_t Nread = fread(values, sizeof(double), Nvalues, bin);
+			fclose(bin);
+			if (Nread == (size_t)Nvalues)
+			{
+				close(fd);
+				printf("Binary input %s read\n", binname);
+				return true;
+			}
+		}
+		else fclose(bin);
+		printf("Binary input %s is out of date or not valid; reading text file\n", binname);
+	}
+
+	// Text file, memory-mapped
+	const char *data = (size > 0) ? (const char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+	if (size > 0 && data == MAP_FAILED)
+	{
+		printf("ERROR: cannot map file %s\n", filename);
+		exit(1);
+	}
+
+	// Split into chunks on whitespace boundaries
+	int Nchunks = omp_get_max_threads();
+	size_t *chunk_start = new size_t[Nchunks+1];
+	long *chunk_count   = new long[Nchunks+1];
+	chunk_start[0] = 0;
+	for (int c = 1; c < Nchunks; c++)
+	{
+		size_t pos = (size * c)/Nchunks;
+		if (pos < chunk_start[c-1]) pos = chunk_start[c-1];
+		while (pos < size && !is_space(data[pos])) pos++;
+		chunk_start[c] = pos;
+	}
+	chunk_start[Nchunks] = size;
+
+	// Pass 1: count tokens per chunk; pass 2: parse into place
+	#pragma omp parallel for schedule(static)
+	for (int c = 0; c < Nchunks; c++)
+	{
+		long count = 0;
+		for (size_t i = chunk_start[c]; i < chunk_start[c+1]; i++)
+			if (!is_space(data[i]) && (i == chunk_start[c] || is_space(data[i-1]))) count++;
+		chunk_count[c] = count;
+	}
+	long total = 0;
+	for (int c = 0; c < Nchunks; c++) { long temp = chunk_count[c]; chunk_count[c] = total; total += temp; }
+	if (total < Nvalues)
+	{
+		printf("ERROR: file %s contains %ld values; %ld expected\n", filename, total, Nvalues);
+		exit(1);
+	}
+
+	#pragma omp parallel for schedule(static)
+	for (int c = 0; c < Nchunks; c++)
+	{
+		long v = chunk_count[c];
+		const char *end = data + chunk_start[c+1];
+		for (const char *p = data + chunk_start[c]; p < end && v < Nvalues; )
+		{
+			while (p < end && is_space(*p)) p++;
+			if (p == end) break;
+			values[v++] = parse_value(p, end);
+			while (p < end && !is_space(*p)) p++;
+		}
+	}
+
+	if (size > 0) munmap((void*)data, size);
+	close(fd);
+	delete [] chunk_start;
+	delete [] chunk_count;
+
+	// Written to a temporary name and renamed, so a concurrent run never reads a partial copy
+	if (use_binary == true)
+	{
+		char tmpname[1100];
+		sprintf(tmpname, "%s.%d.tmp", binname, (int)getpid());
+		bin = fopen(tmpname, "wb");
+		if (bin == NULL) printf("WARNING: cannot write binary input %s\n", binname);
+		else
+		{
+			bool ok = fwrite("MSCSFBN2", 1, 8, bin) == 8 && fwrite(&Nvalues, sizeof(long), 1, bin) == 1
+					&& fwrite(source, sizeof(long long), 2, bin) == 2 && fwrite(values, sizeof(double), Nvalues, bin) == (size_t)Nvalues;
+			if (fclose(bin) != 0) ok = false;
+			if (ok == true && rename(tmpname, binname) == 0) printf("Binary input %s written\n", binname);
+			else
+			{
+				remove(tmpname);
+				printf("WARNING: cannot write binary input %s\n", binname);
+			}
+		}
+	}
+	return true;
+}
+// End Fast value loader ==========================================//|
+
 int read_geo_file(SC_variables *sc, int *geo, const char *filein, const char * fileroot, const char *PATH, const char* Output_dir, const char * ref)
 {
-	FILE *in;
 	char *string = (char*)malloc(500);
 
 	// Assign filename to string
 	sprintf(string, "%s/%s/%s", PATH, fileroot, filein);
 
 	// Read in file
-	in = fopen(string, "r");
-
-	if (in == NULL)
+	int idx, cell_count;
+	int N3 = sc->NX * sc->NY * sc->NZ;
+	double *values = new double[N3];
+	if (load_values_file(string, values, N3, sc->input_binary_write) == false)
 	{
 		printf("Cannot load geometry file %s\t :: is the path correct? Does the file exist in that path?\n", string);
 		exit(1);
 	}
 	else printf("File loaded %s\n", string);
 
-	int temp; // temporary int for reading from file
-	int idx, cell_count;
 	cell_count = 0;
-
-	for (int k = 0; k < sc->NZ; k++)
+	for (idx = 0; idx < N3; idx++)
 	{
-		for (int j = 0; j < sc->NY; j++)
-		{
-			for (int i = 0; i < sc->NX; i++)
-			{	
-				idx = i + (sc->NX*j) + (sc->NX * sc->NY * k);
-				geo[idx] = 0;
-				fscanf(in, "%d ", &temp);
-				geo[idx] = temp;
-				if (geo[idx] > 0) cell_count++; // how many real cells
-			}
-		}
+		geo[idx] = (int)values[idx];
+		if (geo[idx] > 0) cell_count++; // how many real cells
 	}
+	delete [] values;
 
 	printf("Geometry file %s read || Ncells = %d\n", filein, cell_count);
 
-	fclose(in);
-
 	// Write vtk of geoemtry to Outputs directory
 	sprintf(string, "%s/Geometry_%s.vtk", Output_dir, ref);
 
@@ -396,49 +550,36 @@ int read_geo_file(SC_variables *sc, int *geo, const char *filein, const char * f
 // Reads integer map
 int read_map_file(SC_variables sc, int *map, const char *filein, const char * fileroot, const char *PATH, const char* Output_dir, const char * ref)
 {
-	FILE *in;
 	char *string = (char*)malloc(500);
 
 	// Assign filename to string
 	sprintf(string, "%s/%s/%s", PATH, fileroot, filein);
 
-	in = fopen(string, "r");
-
-	if (in == NULL)
+	int idx, cell_count, map_count;
+	int N3 = sc.NX * sc.NY * sc.NZ;
+	double *values = new double[N3];
+	if (load_values_file(string, values, N3, sc.input_binary_write) == false)
 	{
 		printf("Cannot load geometry map file %s\t :: is the path correct? Does the file exist in that path?\n", string);
 		exit(1);
 	}
 	else printf("File loaded %s\n", string);
 
-	int temp; // temporary int for reading from file
-	int idx, cell_count, map_count;
 	cell_count = 0;
 	map_count = 0;
-
-	for (int k = 0; k < sc.NZ; k++)
+	for (idx = 0; idx < N3; idx++)
 	{
-		for (int j = 0; j < sc.NY; j++)
+		if (sc.geo[idx] > 0)
 		{
-			for (int i = 0; i < sc.NX; i++)
-			{
-				idx = i + (sc.NX*j) + (sc.NX * sc.NY * k);
-				fscanf(in, "%d ", &temp);			
-
-				if (sc.geo[idx] > 0)
-				{
-					map[cell_count] = temp; 	// reading into 1D array of size N
-					if (map[cell_count] > 0) map_count++;
-					cell_count++;
-				}
-			}
+			map[cell_count] = (int)values[idx]; 	// reading into 1D array of size N
+			if (map[cell_count] > 0) map_count++;
+			cell_count++;
 		}
 	}
+	delete [] values;
 
 	printf("Map file %s read || Nmap = %d, recheck of Ncells = %d\n", filein, map_count, cell_count);
 
-	fclose(in);
-
 	// Write map vtk to Outputs, with map type in filename (this is "ref" here)
 	sprintf(string,"%s/Map_%s.vtk", Output_dir, ref);
 
@@ -486,49 +627,36 @@ int read_map_file(SC_variables sc, int *map, const char *filein, const char * fi
 // And now, the difference is we are reading in a non-integer
 int read_map_file_double(SC_variables sc, double *map, const char *filein, const char * fileroot, const char *PATH, const char* Output_dir, const char * ref)
 {
-	FILE *in;
 	char *string = (char*)malloc(500);
 
 	// Assign filename to string
 	sprintf(string, "%s/%s/%s", PATH, fileroot, filein);
 
-	in = fopen(string, "r");
-
-	if (in == NULL)
+	int idx, cell_count, map_count;
+	int N3 = sc.NX * sc.NY * sc.NZ;
+	double *values = new double[N3];
+	if (load_values_file(string, values, N3, sc.input_binary_write) == false)
 	{
 		printf("Cannot load geometry map file %s\t :: is the path correct? Does the file exist in that path?\n", string);
 		exit(1);
 	}
 	else printf("File loaded %s\n", string);
 
-	double temp; // temporary int for reading from file
-	int idx, cell_count, map_count;
 	cell_count = 0;
 	map_count = 0;
-
-	for (int k = 0; k < sc.NZ; k++)
+	for (idx = 0; idx < N3; idx++)
 	{
-		for (int j = 0; j < sc.NY; j++)
+		if (sc.geo[idx] > 0)
 		{
-			for (int i = 0; i < sc.NX; i++)
-			{
-				idx = i + (sc.NX*j) + (sc.NX * sc.NY * k);
-				fscanf(in, "%lf ", &temp);
-
-				if (sc.geo[idx] > 0)
-				{
-					map[cell_count] = temp;		// reading into 1D array of size N
-					if (map[cell_count] >= 0.0) map_count++;
-					cell_count++;
-				}
-			}
+			map[cell_count] = values[idx];		// reading into 1D array of size N
+			if (map[cell_count] >= 0.0) map_count++;
+			cell_count++;
 		}
 	}
+	delete [] values;
 
 	printf("Map file %s read || Nmap = %d, recheck of Ncells = %d\n", filein, map_count, cell_count);
 
-	fclose(in);
-
 	// Write map vtk to Outputs, with map type in filename (this is "ref" here)
 	sprintf(string,"%s/Map_%s.vtk", Output_dir, ref);
 
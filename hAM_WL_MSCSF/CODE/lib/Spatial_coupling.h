@@ -83,6 +83,7 @@ void SC_array_allocation_Ncell(SC_variables *sc, int Ncell);
 void SC_array_deallocation(SC_variables *sc);
 
 // Read files | returns Ncells or NMap
+bool load_values_file(const char *filename, double *values, long Nvalues, bool use_binary);
 int read_geo_file(SC_variables *sc, int *geo, const char * filein, const char * fileroot, const char *PATH, const char* Output_dir, const char * ref);
 int read_map_file(SC_variables sc, int *map, const char *filein, const char * fileroot, const char *PATH, const char* Output_dir, const char * ref);
 int read_map_file_double(SC_variables sc, double *map, const char *filein, const char * fileroot, const char *PATH, const char* Output_dir, const char * ref);
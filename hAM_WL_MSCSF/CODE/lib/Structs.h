@@ -62,13 +62,38 @@
 #include <iostream>
 
 // Struct list:
+// struct{}Output_sink;
 // struct{}Smulation_parameters;
 // struct{}Cell_parameters;
 // struct{}State_variables;
 // struct{}Model_variables;
 // struct{}SC_variables;
 // struct{}Tissue_parameters;
+// struct{}Probe_parameters;
+// struct{}Steady_state_monitor;
+// struct{}Checkpoint_parameters;
+// struct{}Single_cell_snapshot;
+// struct{}Tissue_snapshot;
 // struct{}Argument_parameters;
+// struct{}Strand_batch;
+// struct{}Branch_scenarios;
+// struct{}Modulation_events;
+// struct{}Pacing_protocol;
+// struct{}Measurement_engine;
+// struct{}CV_maps;
+// struct{}APD_maps;
+
+// Define the output sink struct ================================================================\\|
+// A single runtime-configured spatial output (2D slice or bounding-box ROI, with decimation)
+typedef struct{
+	char const	*type;					// "slice_XY", "slice_XZ", "slice_YZ" or "ROI"
+	int x0, x1, y0, y1, z0, z1;			// Bounding box (inclusive); -1 means full extent of that dimension
+	int k;								// Spatial decimation; output every k-th voxel in each direction
+	int interval;						// ms between outputs (temporal decimation)
+	int start_time;						// ms; lower bound of time to output (-1 means global spatial output range)
+	int end_time;						// ms; upper bound of time to output (-1 means global spatial output range)
+}Output_sink;
+// End Define the output sink struct ============================================================//|
 
 // Define the simulation parameters struct ======================================================\\|
 typedef struct{
@@ -94,6 +119,24 @@ typedef struct{
 	char const	*Vclamp;		// "On" or "Off"
 	char const	*Write_state;	// "On" or "Off"
 	char const 	*Read_state; 	// "On" or "Off"
+	char const	*State_format;	// "text" or "binary" (whole tissue state files)
+	int			Checkpoint_interval;	// ms between checkpoints (0 = off)
+	char const	*Restart;		// "On" or "Off": continue from checkpoint
+	char const	*State_library;	// "On" or "Off": per-cell states in PATH/State_files/State_library.bin
+	char const	*State_library_BCL;	// "exact" or "nearest": BCL fallback for library reads
+
+	// Steady-state detection during pacing
+	char const	*Steady_state;	// "On" or "Off": stop pacing once beat-to-beat changes are within tolerance
+	double		SS_tol_APD;		// ms; APD90 tolerance
+	double		SS_tol_Ca;		// relative tolerance; Cai and CaSR min/max
+	double		SS_tol_Nai;		// relative tolerance; Nai at excitation
+	int			SS_beats;		// consecutive beats within tolerance required
+
+	// Early termination once the outcome is determined (tissue)
+	char const	*Early_stop;			// "On" or "Off": after the last stimulus, stop when quiescent or (1D S1-S2) both ends fired after S2
+	double		Early_stop_Vm;			// mV; nodes above this are active
+	double		Early_stop_active;		// fraction of nodes allowed to be active while quiescent
+	int			Early_stop_quiescent;	// ms; duration of quiescence required
 
 	// Interval to output spatial files
 	int Spatial_output_interval_vtk;	// ms // for VTK
@@ -101,6 +144,10 @@ typedef struct{
     int Spatial_output_start_time;      // lower bound of time to output spatial data
     int Spatial_output_end_time;        // upper bound of time to output spatial data
 
+	// Runtime-configured output sinks (slices, ROIs, decimated volumes)
+	int			N_output_sinks;			// Number of sinks set
+	Output_sink	output_sink[20];		// Sink settings
+
 	// Delayed impose CaSR functionality
 	const char *Delayed_CaSR_IC; 	// "On" or "Off"
 	double		CaSR_IC_delay;		// ms
@@ -1018,6 +1065,7 @@ typedef struct{
 	int *x_index;		// returns the x value at each Ncell
 	int *y_index;		// returns the y value at each Ncell
 	int *z_index;		// returns the z value at each Ncell
+	bool input_binary_write;	// read/write binary copies ("<file>.bin") of text geometry/map/fibre inputs
 
 	// Diffusion coefficient
 	double *D;		// Baseline D, isotropic
@@ -1166,6 +1214,8 @@ typedef struct{
     char const *Default_model;      // Whether we want a tissue model to have a defaulted cell model
     char const *Tissue_model_2;    // Whether we want a tissue model to have a defaulted cell model for second region
     char const *Multiple_models;    // To use two different cell models for different regions in tissue
+    char const *Tissue_cache;       // "On" or "Off" to read/write preprocessed geometry, D and laplacian arrays
+    char const *Tissue_cache_dir;   // Directory of tissue cache files
 
 	// Model-specific settings
 	int NX, NY, NZ;			    // Dimension sizes
@@ -1191,16 +1241,26 @@ typedef struct{
 	// Stimulus and other location specific arrays
 	int Nstim;			// Number of nodes to stimulate
 	int Nstim_S2;		// Number of nodes to stimulate
+	int Nstrands;		// Independent 1D strands (rows); 0 for a single tissue
 	int *stim_area;		// area to apply stimulus (= 1 for yes, = 0 for no)
 	int *S2_stim_area;	// area to apply stimulus (= 1 for yes, = 0 for no)
 	bool stim_set;		// tracker of whether stimulus loc/szie has been set
 	bool S2_stim_set;	// tracker of whether S2 stimulus loc/size has been set
 
-	int **multi_stim_area;	// Stim area for multiple stimulus sites and timings
+	int **multi_stim_area;	// Stim area for multiple stimulus sites and timings (setup only; freed once sites are compiled)
 	char const 	*Multi_stim;	// "On" or "Off"
 	int Nstims;				// Number of different stim sites/timings
 	int stim_delay[20];		// Delay (relative to first stim) for each stim
 
+	// Stimulus sites || sparse node lists compiled from the stimulus areas; site 0 = S1, 1 = S2, 1+m = multi-stim m
+	int Nstim_sites;
+	int stim_site_start[22];	// nodes of site s are stim_site_nodes[stim_site_start[s]] to [stim_site_start[s+1]-1]
+	int *stim_site_nodes;
+	double *stim_site_weight;	// stimulus area value of each site node (the stimulus current is scaled by it)
+	double *stim_current;		// per-node S1/S2 stimulus current of this step (non-zero only on site nodes)
+	double *multi_stim_current;	// per-node dt*current of the multi-stim sites (NULL without multi-stim)
+	bool stim_current_set;		// true if any site node has a non-zero current (cleared by clear_stimulus_sites())
+
 	// ISO/remodelling/D map
 	double 	*ISO_map;		// ISO conc
 	double 	*Dscale_base_map;	// D scaling (inherrent e.g. scaling gradient)
@@ -1296,6 +1356,83 @@ typedef struct{
 }Tissue_parameters;
 // End define the tissue parameters struct ======================================================//|
 
+// Define the probe recorder struct =============================================================\\|
+// Virtual electrodes: a set of nodes and variables sampled into a buffer and flushed to binary in blocks
+typedef struct{
+	int		N;						// Number of probe nodes
+	int		*node;					// Linear (Ncell) index of each probe
+	int		Nvar;					// Number of recorded variables
+	int		var_id[20];				// Variable identifier for each recorded variable
+	char	var_name[20][50];		// Variable names, as passed
+	double	interval;				// ms between samples
+	int		interval_int;			// iterations between samples
+	int		buffer_size;			// Number of samples held in memory before a block is written
+	int		Nbuffered;				// Number of samples currently in the buffer
+	int		sample_size;			// Number of doubles per sample (time + N*Nvar)
+	double	*buffer;				// Sample buffer (buffer_size*sample_size)
+	FILE	*out;					// Binary output file
+}Probe_parameters;
+// End define the probe recorder struct =========================================================//|
+
+// Define the steady-state monitor struct =======================================================\\|
+// Beat-to-beat convergence of a single cell; compares each completed beat to the one before
+typedef struct{
+	double	tol_APD;				// APD90 tolerance (ms)
+	double	tol_Ca;					// Relative tolerance on Cai and CaSR extrema
+	double	tol_Nai;				// Relative tolerance on Nai
+	int		Nrequired;				// Consecutive beats within tolerance required
+	int		Nwithin;				// Current run of consecutive beats within tolerance
+	int		beats;					// Completed beats compared
+	bool	set;					// True once a previous beat has been stored
+	bool	converged;				// True once Nwithin >= Nrequired
+	double	APD90, CaT_min, CaT_max, CaSR_min, CaSR_max, Nai;	// Previous completed beat
+}Steady_state_monitor;
+// End define the steady-state monitor struct ===================================================//|
+
+// Define the checkpoint struct =================================================================\\|
+// Time loop counters and output file lengths at a checkpoint (state, variable and Vm arrays are written alongside)
+typedef struct{
+	double	sim_time;				// Time of the next step (ms)
+	int		iteration_counter;		// Steps completed
+	int		outcount;				// Output (ms) counter
+	int		phase_counter;			// Phase file counter
+	int		Nfiles;					// Number of appended output files tracked
+	long	file_length[10];		// Length of each appended output file at the checkpoint (bytes)
+	int		quiescent_time;			// Early stop: consecutive quiescent ms
+	bool	steady_state;			// Steady-state monitors: all converged
+	Steady_state_monitor steady[3];	// Steady-state monitors of the three reference cells
+	int		map_beat;				// Beats mapped (CV/APD maps); beats run from one stimulus onset to the next
+	double	map_beat_start;			// Onset of the current beat (ms)
+	int		APD_map_pending_beat;	// APD map waiting for its nodes (its values are saved after the arrays)
+	double	APD_map_pending_start;
+	double	APD_map_pending_end;
+}Checkpoint_parameters;
+// End define the checkpoint struct =============================================================//|
+
+// Define the single cell snapshot struct =======================================================\\|
+// Cell at a point in a protocol, from which further protocols (e.g. S2 intervals) are run
+typedef struct{
+	State_variables		State;
+	Model_variables		Variables;
+	double				Vm;
+	double				sim_time;			// Time of the next step (ms)
+	int					iteration_counter;	// Steps completed
+	int					NBeats;				// S1 beats, including the one applied from the snapshot
+}Single_cell_snapshot;
+// End define the single cell snapshot struct ===================================================//|
+
+// Define the tissue snapshot struct ============================================================\\|
+// Copy of all per-node state at a point in a tissue simulation; branches are run from copies of it
+typedef struct{
+	int					N;					// Number of nodes
+	State_variables		*State;
+	Model_variables		*Variables;			// Including stimulus settings and counters in [0]
+	double				*Vm;
+	double				sim_time;			// Time of the next step (ms)
+	int					iteration_counter;	// Steps completed
+}Tissue_snapshot;
+// End define the tissue snapshot struct ========================================================//|
+
 // Define the Arguments struct ==================================================================\\|
 typedef struct {
 
@@ -1332,6 +1469,59 @@ typedef struct {
 	char const	*Vclamp;			// "On" or "Off"
 	char const  *Write_state;		// "On" or "Off"	
 	char const  *Read_state;		// "On" or "Off"
+	char const  *State_format;		// "text" or "binary"
+	bool		State_format_arg;	// True IF argument passed
+	int			Checkpoint_interval;	// ms between checkpoints
+	bool		Checkpoint_interval_arg;// True IF argument passed
+	char const  *Restart;			// "On" or "Off"
+	bool		Restart_arg;		// True IF argument passed
+	char const  *State_library;		// "On" or "Off"
+	bool		State_library_arg;	// True IF argument passed
+	char const  *State_library_BCL;	// "exact" or "nearest"
+	bool		State_library_BCL_arg;	// True IF argument passed
+	char const  *Batch_file;		// Single cell batch file (one job's arguments per line)
+	bool		Batch_file_arg;		// True IF argument passed
+	char const  *Batch_format;		// "csv" or "binary" batch results table
+	bool		Batch_format_arg;	// True IF argument passed
+	int			S2_range_start;		// S1-S2 restitution: first S2 interval (ms)
+	int			S2_range_end;		// Last S2 interval (ms)
+	int			S2_range_step;		// Interval step (ms)
+	bool		S2_range_arg;		// True IF argument passed
+	char const  *Dynamic_BCLs;		// Dynamic restitution: comma separated BCLs (ms), in pacing order
+	bool		Dynamic_BCLs_arg;	// True IF argument passed
+	int			Population;				// Number of population-of-models members (single cell)
+	bool		Population_arg;			// True IF argument passed
+	char const  *Population_sampling;	// "uniform", "lognormal" or "LHS"
+	bool		Population_sampling_arg;// True IF argument passed
+	char const  *Population_currents;	// Comma separated current/flux names to sample (as {X}_scale)
+	bool		Population_currents_arg;// True IF argument passed
+	double		Population_min;			// Lower scale factor (uniform, LHS)
+	double		Population_max;			// Upper scale factor (uniform, LHS)
+	bool		Population_range_arg;	// True IF argument passed
+	double		Population_sigma;		// Standard deviation of log(scale factor) (lognormal)
+	bool		Population_sigma_arg;	// True IF argument passed
+	int			Population_seed;		// Random seed
+	bool		Population_seed_arg;	// True IF argument passed
+	char const  *Calibration_file;		// Biomarker ranges for calibration ("name min max" per line)
+	bool		Calibration_file_arg;	// True IF argument passed
+	char const  *Steady_state;		// "On" or "Off"
+	bool		Steady_state_arg;	// True IF argument passed
+	double		SS_tol_APD;			// APD90 tolerance (ms)
+	bool		SS_tol_APD_arg;		// True IF argument passed
+	double		SS_tol_Ca;			// Relative Ca2+ extrema tolerance
+	bool		SS_tol_Ca_arg;		// True IF argument passed
+	double		SS_tol_Nai;			// Relative Nai tolerance
+	bool		SS_tol_Nai_arg;		// True IF argument passed
+	int			SS_beats;			// Consecutive beats within tolerance
+	bool		SS_beats_arg;		// True IF argument passed
+	char const  *Early_stop;		// "On" or "Off"
+	bool		Early_stop_arg;		// True IF argument passed
+	double		Early_stop_Vm;		// Activity threshold (mV)
+	bool		Early_stop_Vm_arg;	// True IF argument passed
+	double		Early_stop_active;	// Active fraction allowed while quiescent
+	bool		Early_stop_active_arg;	// True IF argument passed
+	int			Early_stop_quiescent;	// Quiescent duration (ms)
+	bool		Early_stop_quiescent_arg;	// True IF argument passed
 	int			SOI;				// Spatial Output Interval (VTK)
 	bool		SOI_arg;			// True IF argument passed (VTK)
 	int			SOId;				// Spatial Output Interval (data)
@@ -1340,6 +1530,8 @@ typedef struct {
     bool        SORs_arg;           // True IF argument passed
     int         SORe;               // Spatial output range start time
     bool        SORe_arg;           // True IF argument passed
+	int			N_output_sinks;		// Number of output sinks passed (Output_slice/ROI/decimated)
+	Output_sink	output_sink[20];	// Output sink settings
 	char const 	*Multi_stim;		// "On" or "Off" for multiple stim sites
 	bool		Multi_stim_arg;		//	True IF argument passed 
 	// End simulation settings ====================================//|
@@ -1424,6 +1616,41 @@ typedef struct {
 	bool		Direct_modulation_map_arg;			// True IF argument has been passed
     char const  *Multiple_models;    // To use two different cell models for different regions in tissue
     bool        Multiple_models_arg;
+    char const  *Tissue_cache;
+    bool        Tissue_cache_arg;
+    char const  *Tissue_cache_dir;
+    bool        Tissue_cache_dir_arg;
+    char const  *Strand_file;           // Batched independent 1D strands; one line of arguments per strand
+    bool        Strand_file_arg;
+    char const  *Vulnerability_window;  // "On" to search the S2 vulnerability window (1D) from a snapshot
+    bool        Vulnerability_window_arg;
+    double      VW_S2_min;              // S2 interval range to search (ms)
+    double      VW_S2_max;
+    bool        VW_S2_range_arg;
+    double      VW_S2_step;             // Coarse scan step (ms)
+    bool        VW_S2_step_arg;
+    double      VW_precision;           // Window boundary precision (ms)
+    bool        VW_precision_arg;
+    char const  *VW_S2_x_locs;          // Comma separated S2 x locations
+    bool        VW_S2_x_locs_arg;
+    char const  *Branch_file;           // What-if scenarios from a snapshot; one line of arguments per branch
+    bool        Branch_file_arg;
+    double      Branch_time;            // Branch point (ms)
+    bool        Branch_time_arg;
+    char const  *Event_file;            // Modulation events; one line per event: time [ramp x [ramp_step x]] arguments
+    bool        Event_file_arg;
+    char const  *Protocol_file;         // Pacing protocol; one stimulus train per line (site, start, duration, amplitude, repeats etc)
+    bool        Protocol_file_arg;
+    char const  *Measurement;           // "Full" or "Events": event-driven activation/APD measurement in tissue
+    bool        Measurement_arg;
+    char const  *Measurement_APD;       // Comma separated APD levels (% repolarisation) measured by the event-driven engine
+    bool        Measurement_APD_arg;
+    char const  *CV_map;                // "On" for per-node CV maps from activation-time gradients, each beat
+    bool        CV_map_arg;
+    char const  *APD_map;               // "On" for per-node APD, repolarisation time and dispersion maps, per beat
+    bool        APD_map_arg;
+    int         APD_map_interval;       // Map every n-th beat
+    bool        APD_map_interval_arg;
     char const  *Tissue_model_2;       // Second tissue model
     bool        Tissue_model_2_arg;
 
@@ -1516,6 +1743,22 @@ typedef struct {
 	bool 	SRF_map_file_arg;
 	bool 	Direct_modulation_map_file_arg;
 	bool 	spatial_gradient_map_file_arg;
+
+	// Probe recorder
+	const char * Probe_file;		// File listing probe nodes (index or x y z per line)
+	bool	Probe_file_arg;
+	const char * Probe_nodes;		// Comma separated list of probe nodes (index or x:y:z)
+	bool	Probe_nodes_arg;
+	const char * Probe_variables;	// Comma separated list of recorded variables
+	bool	Probe_variables_arg;
+	double	Probe_interval;			// ms between samples
+	bool	Probe_interval_arg;
+	int		Probe_buffer;			// samples held before a block is written
+	bool	Probe_buffer_arg;
+
+	// Input files
+	const char * Input_binary_write;	// "On" or "Off"; read/write binary copies of text geometry/map/fibre files
+	bool	Input_binary_write_arg;
 	// Tissue model settings ======================================//|
 
 	// Spatial single cell model settings =========================\\|
@@ -1774,6 +2017,115 @@ typedef struct {
 }Argument_parameters;
 // End Define the arguments struct ==============================================================//|
 
+// Define the strand batch struct ===============================================================\\|
+// Independent 1D strands as the rows (y) of one domain; each strand has its own S2 and conditions
+typedef struct{
+	int					N;					// Number of strands
+	char				**line;				// Strand file line of each strand
+	char				**buffer;			// Argument token storage
+	Argument_parameters	*A;					// Command-line arguments with the strand's line on top
+	Cell_parameters		*conditions;		// Model conditions (Model, ISO, remodelling etc) of each strand
+	int					*S2_CL;				// ms
+	int					*S2_x_loc;
+	double				*S2_time;			// ms; as Sim.S2_time, for each strand
+	Model_variables		*stim;				// S2 stimulus settings and counters of each strand
+}Strand_batch;
+// End define the strand batch struct ===========================================================//|
+
+// Define the branch scenarios struct ===========================================================\\|
+// What-if scenarios advanced from one snapshot of the tissue; each branch has its own conditions and modulation
+typedef struct{
+	int					N;					// Number of branches
+	char				**line;				// Branch file line of each branch
+	char				**buffer;			// Argument token storage
+	Argument_parameters	*A;					// Command-line arguments with the branch's line on top
+	double				time;				// ms; branch point
+	bool				taken;				// True once the snapshot has been taken
+	Tissue_snapshot		snap;				// Tissue at the branch point
+}Branch_scenarios;
+// End define the branch scenarios struct =======================================================//|
+
+// Define the modulation events struct ==========================================================\\|
+// Timeline of condition and modulation changes applied during a run; ramps are expanded into steps at setup
+typedef struct{
+	int					N;					// Number of events (ramp steps included)
+	double				*time;				// ms; applied before the first step at or after this time
+	char				**line;				// Arguments of each event (ramped values substituted)
+	char				**buffer;			// Argument token storage
+	Argument_parameters	*A;					// Arguments in effect from each event (cumulative)
+	int					next;				// Next event to apply
+}Modulation_events;
+// End define the modulation events struct ======================================================//|
+
+// Define the pacing protocol struct ============================================================\\|
+// Timed stimulus pulses on the stimulus sites, compiled at setup into a queue ordered by onset step
+typedef struct{
+	int			N;					// Number of pulses
+	int			*site;				// Stimulus site of each pulse (0 = S1, 1 = S2, k = multi-stim map value k)
+	int			*start;				// Onset step of each pulse, in increasing order
+	int			*stop;				// First step after each pulse
+	double		*amplitude;			// As stimmag
+	int			next;				// Next pulse to start
+	int			Nactive;			// Pulses currently on
+	int			*active;			// Indexes of the pulses currently on
+	double		Istim[22];			// Current of each site for this step
+}Pacing_protocol;
+// End define the pacing protocol struct ========================================================//|
+
+// Define the measurement engine struct =========================================================\\|
+// Activation time and APD at the requested repolarisation levels only, updated at the upstroke and level crossings.
+// Results (t_ex, APD_p, APD_p_switch) are written to the Model_variables at these events; the fields checked every
+// step are kept in compact per-node arrays (27 bytes per node) and copied back by measurement_engine_sync(). This is
+// in addition to the Model_variables, which are shared with the fully measured nodes and so cannot be reduced
+typedef struct{
+	int				N;					// Number of nodes (0 = engine off)
+	int				Nlevels;			// Number of APD levels
+	int				percent[9];			// APD levels (% repolarisation, multiples of 10), increasing
+	double			level[9];			// APD levels as proportions
+	int				APD_p_index[9];		// Index of each level in Model_variables APD_p[]
+	bool			*full;				// Nodes measured with the full Model_variables routines (reference cells and probes)
+	unsigned char	*excited;			// As ex_switch
+	unsigned char	*next;				// Next APD level to be crossed (Nlevels = none pending)
+	double			*Vmin;				// Minimum V while repolarising		(mV)
+	double			*Vrest;				// V before the upstroke, current beat (as Vmin_prev) (mV)
+	double			*Vmax;				// Maximum V, current beat; updated only while levels are pending (mV)
+}Measurement_engine;
+// End define the measurement engine struct =====================================================//|
+
+// Define the conduction velocity maps struct ===================================================\\|
+// Per-node CV vectors from the activation-time gradient over the neighbour stencil, once per beat
+typedef struct{
+	int		N;					// Number of nodes (0 = off)
+	double	beat_start;			// Start of the current beat (ms); nodes activated since are in its map
+	bool	*exclude;			// Stimulus site nodes (activated together, so no local CV)
+	double	*t_ex;				// Activation times gathered from Model_variables (without the measurement engine)
+	double	*CV;				// Speed 							(m/s)
+	double	*CVx;				// Components of the CV vector		(m/s)
+	double	*CVy;
+	double	*CVz;
+	double	*speeds;			// Valid speeds, for the summary statistics
+	FILE	*summary;			// Per-beat statistics
+}CV_maps;
+// End define the conduction velocity maps struct ===============================================//|
+
+// Define the APD maps struct ===================================================================\\|
+// Per-node APD at each level, repolarisation time and its local dispersion, once every "interval" beats
+typedef struct{
+	int		N;					// Number of nodes (0 = off)
+	int		Nlevels;			// APD levels mapped (those of the measurement engine, else 30, 50 and 90%)
+	int		percent[9];			// APD levels (% repolarisation), increasing
+	int		interval;			// Map every interval-th beat
+	int		pending_beat;		// Beat whose map is waiting for its nodes to repolarise (0 = none)
+	double	pending_start;		// Its start and end (stimulus onsets; ms)
+	double	pending_end;
+	double	*APD;				// APD at each level (Nlevels*N; level-major)	(ms) || start of the (Nlevels+2)*N block saved in checkpoints
+	double	*RT;				// Repolarisation time, t_ex + APD at the highest level (ms)
+	double	*open;				// 1 for nodes activated in the pending beat and not yet repolarised or re-activated
+	double	*dispersion;		// Largest RT difference to a neighbour			(ms)
+	FILE	*summary;			// Per-beat statistics
+}APD_maps;
+// End define the APD maps struct ===============================================================//|
+
 
 #endif
 
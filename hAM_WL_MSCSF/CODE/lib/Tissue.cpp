@@ -67,9 +67,19 @@
 #include "Tissue.h"
 #include "Structs.h"
 #include "Spatial_coupling.h"
+#include "Initialisation.h"
+#include "Model.h"
+#include "Outputs.h"
 #include <fstream>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
 
 // Function list ================================================================================\\|
 //	Setup and tissue model
@@ -90,6 +100,10 @@
 //	    select_stimulus_area_function_multi_stim()
 //	    create_stimulus_area()
 //	    create_stimulus_area_sphere()
+//	    stimulus_site_nodes()
+//	    compile_stimulus_sites()
+//	    clear_stimulus_sites()
+//	    apply_stimulus_site()
 //	    set_orientation()
 //	    create_orientation_ideal()
 //	    read_orientation_anatomical()
@@ -109,8 +123,32 @@
 //	conduction velocity model parameters and calculation
 //	    set_CV_cells()
 //	    calculate_CV()
+//	    cv_map_setup()
+//	    cv_map_beat()
+//	    cv_map_free()
 //	
+//	conduction_success_type()
 //	compute_conduction_success()
+//	
+//	Event-driven measurement engine
+//	    measurement_engine_setup()
+//	    measurement_engine_step()
+//	    measurement_engine_sync()
+//	    measurement_engine_free()
+//	
+//	APD and repolarisation maps
+//	    apd_map_setup()
+//	    apd_map_update()
+//	    apd_map_beat()
+//	    apd_map_free()
+//	
+//	Tissue cache (geometry, neighbours, D and laplacian arrays)
+//	    tissue_cache_key()
+//	    read_tissue_cache()
+//	    write_tissue_cache()
+//	
+//	set_parameter_regions()
+//	set_region_parameters_native()
 // End Function list ============================================================================//|
 
 // Set tissue model and type ====================================================================\\|
@@ -143,11 +181,14 @@ void set_tissue_model_conditions(Tissue_parameters *t, Argument_parameters A)
 	t->map_in_type      = "coords";         // this is auto set to file for geo models
 	t->Multi_stim		= "Off";
 	t->Nstims			= 1;
+	t->Nstrands			= 0;
 	t->Global_orientation_direction = "Off";
 	t->spatial_gradient_map_on = "Off"; 
 	t->Default_model    = "none";       // do not set from tissue defaults
 	t->Tissue_model_2  = "none";
 	t->Multiple_models  = "Off";
+	t->Tissue_cache     = "Off";            // build geometry/D/laplacian each run
+	t->Tissue_cache_dir = "Tissue_cache";
 
 	// Overwrite from arguments || may need to do again if tissue settings set some of these
 	if (A.Tissue_order_arg == true) 	t->Tissue_order		= A.Tissue_order;
@@ -163,6 +204,8 @@ void set_tissue_model_conditions(Tissue_parameters *t, Argument_parameters A)
 	if (A.S2_shape_arg == true)			t->S2_shape			= A.S2_shape;
 	if (A.Tissue_model_2_arg == true)	t->Tissue_model_2	= A.Tissue_model_2;
 	if (A.Multiple_models_arg == true)	t->Multiple_models	= A.Multiple_models;
+	if (A.Tissue_cache_arg == true)		t->Tissue_cache		= A.Tissue_cache;
+	if (A.Tissue_cache_dir_arg == true)	t->Tissue_cache_dir	= A.Tissue_cache_dir;
 }
 // End set tissue model and type ================================================================//|
 
@@ -183,8 +226,13 @@ void tissue_array_allocation(Tissue_parameters *t, int N)
 	t->Direct_modulation_map		= new double [N];
 	t->spatial_gradient_map		= new double [N];
 
-	t->multi_stim_area	= new int *[20];
-	for (int n = 0; n < 20; n++) t->multi_stim_area[n] = new int [N];
+	t->multi_stim_area	= NULL;	// allocated only for multi-stim (select_stimulus_area_function_multi_stim())
+	t->stim_site_nodes	= NULL;
+	t->stim_site_weight	= NULL;
+	t->stim_current		= NULL;
+	t->multi_stim_current	= NULL;
+	t->stim_current_set	= false;
+	t->Nstim_sites		= 0;
 }
 void tissue_array_deallocation(Tissue_parameters *t)
 {
@@ -202,8 +250,15 @@ void tissue_array_deallocation(Tissue_parameters *t)
 	delete [] t->Direct_modulation_map;
 	delete [] t->spatial_gradient_map;
 
-	for (int n = 0; n < 20; n++) delete t->multi_stim_area[n];
-	delete t->multi_stim_area;
+	if (t->multi_stim_area != NULL)
+	{
+		for (int n = 1; n < t->Nstims; n++) delete [] t->multi_stim_area[n];
+		delete [] t->multi_stim_area;
+	}
+	delete [] t->stim_site_nodes;
+	delete [] t->stim_site_weight;
+	delete [] t->stim_current;
+	delete [] t->multi_stim_current;
 }
 // End array allocation and deallocation ========================================================//|
 
@@ -1470,6 +1525,10 @@ void select_stimulus_area_function_multi_stim(Tissue_parameters *t, SC_variables
     {
         if (strcmp(t->S1_loc_type, "file") == 0)
         {
+            // Area of each further site (1 to Nstims-1); only needed until the sites are compiled
+            t->multi_stim_area = new int *[Nstims];
+            for (int n = 1; n < Nstims; n++) t->multi_stim_area[n] = new int [sc.N];
+
             // First, read in stim file to stim area as normally
             t->Nstim    = read_map_file(sc, t->stim_area, t->stim_file, "Tissue_geometries", PATH, Output_dir, "S1"); // lib/Spatial_coupling.cpp	
 
@@ -1707,6 +1766,90 @@ void create_stimulus_area_sphere(SC_variables sc, const char *Tissue_order, int
     }
     fclose(out);
 }
+
+// Nodes of a stimulus area (area[n] != 0) in increasing order; returns the number of nodes
+int stimulus_site_nodes(const int *area, int N, int *nodes)
+{
+    int count = 0;
+    for (int n = 0; n < N; n++) if (area[n] != 0) nodes[count++] = n;
+    return count;
+}
+
+// Compiles the stimulus areas into sparse node lists (S1, S2 if its area is set, then each multi-stim site) and frees the multi-stim areas
+// The per-node stimulus currents are then only written on these nodes, and only while a site's current is on (apply_stimulus_site())
+void compile_stimulus_sites(Tissue_parameters *t, int N, bool S2_area_set)
+{
+    bool multi_stim = (strcmp(t->Multi_stim, "On") == 0);
+    int *nodes = new int[N];
+    std::vector<int> sites;
+    std::vector<double> weights;
+
+    t->Nstim_sites          = (multi_stim == true) ? t->Nstims + 1 : 2;
+    t->stim_site_start[0]   = 0;
+    for (int s = 0; s < t->Nstim_sites; s++)
+    {
+        int count = 0;
+        if (s == 0) count = stimulus_site_nodes(t->stim_area, N, nodes);
+        else if (s == 1 && S2_area_set == true) count = stimulus_site_nodes(t->S2_stim_area, N, nodes);
+        else if (s > 1) count = stimulus_site_nodes(t->multi_stim_area[s-1], N, nodes);
+        const int *area = (s == 0) ? t->stim_area : (s == 1) ? t->S2_stim_area : t->multi_stim_area[s-1];
+        for (int i = 0; i < count; i++)
+        {
+            sites.push_back(nodes[i]);
+            weights.push_back(area[nodes[i]]);
+        }
+        t->stim_site_start[s+1] = (int)sites.size();
+    }
+    delete [] nodes;
+
+    delete [] t->stim_site_nodes;
+    delete [] t->stim_site_weight;
+    t->stim_site_nodes  = new int[sites.size() + 1];
+    t->stim_site_weight = new double[sites.size() + 1];
+    for (size_t i = 0; i < sites.size(); i++)
+    {
+        t->stim_site_nodes[i]   = sites[i];
+        t->stim_site_weight[i]  = weights[i];
+    }
+
+    delete [] t->stim_current;
+    delete [] t->multi_stim_current;
+    t->stim_current         = new double[N];
+    t->multi_stim_current   = (multi_stim == true) ? new double[N] : NULL;
+    for (int n = 0; n < N; n++) t->stim_current[n] = 0.0;
+    if (multi_stim == true) for (int n = 0; n < N; n++) t->multi_stim_current[n] = 0.0;
+    t->stim_current_set     = false;
+
+    if (t->multi_stim_area != NULL)
+    {
+        for (int n = 1; n < t->Nstims; n++) delete [] t->multi_stim_area[n];
+        delete [] t->multi_stim_area;
+        t->multi_stim_area = NULL;
+    }
+}
+
+// Resets the per-node stimulus currents of the previous step (site nodes only, and only if any was set)
+void clear_stimulus_sites(Tissue_parameters *t)
+{
+    if (t->stim_current_set == false) return;
+    int Nnodes = t->stim_site_start[t->Nstim_sites];
+    for (int i = 0; i < Nnodes; i++) t->stim_current[t->stim_site_nodes[i]] = 0.0;
+    if (t->multi_stim_current != NULL) for (int i = 0; i < Nnodes; i++) t->multi_stim_current[t->stim_site_nodes[i]] = 0.0;
+    t->stim_current_set = false;
+}
+
+// Stimulus current of one site, scaled by the stimulus area value of each node || read per node in the tissue loop, in the
+// same expressions as the dense stimulus maps: S1 and S2 (sites 0, 1) with Itot, multi-stim sites (> 1) as dt*Istim*area
+void apply_stimulus_site(Tissue_parameters *t, int site, double Istim, double dt)
+{
+    if (Istim == 0.0) return;
+    t->stim_current_set = true;
+    for (int i = t->stim_site_start[site]; i < t->stim_site_start[site+1]; i++)
+    {
+        if (site < 2) t->stim_current[t->stim_site_nodes[i]] += Istim*t->stim_site_weight[i];
+        else t->multi_stim_current[t->stim_site_nodes[i]] = dt*Istim*t->stim_site_weight[i];
+    }
+}
 // End create or read stimulus ==================================================================//|
 
 // Create or read orientation ===================================================================\\|
@@ -1741,223 +1884,159 @@ void create_orientation_ideal(SC_variables *sc, Tissue_parameters t)
 
 void read_orientation_anatomical(SC_variables *sc, Tissue_parameters t, const char *PATH)
 {
-    FILE *in1, *in2, *in3;
     char *string = (char*)malloc(500);
 
     int idx;
     int count = 0;
+    int N3 = sc->NX * sc->NY * sc->NZ;
 
+    // Files are loaded whole (lib/Spatial_coupling.cpp) then the tissue nodes extracted
+    // values are rounded through float to match the precision of the fibre files as previously read
     if (strcmp(t.orientation_file_type, "xyz") == 0)
     {
         printf("Reading fibres, xyz style, from file...\n");
         float X, Y, Z;
+        double *vx = new double[N3];
+        double *vy = new double[N3];
+        double *vz = new double[N3];
 
-        // open fibre files
+        // read fibre files
+        bool found = true;
         sprintf(string, "%s/Tissue_geometries/%s_OX.dat", PATH, t.orientation_file_root);
-        in1 = fopen(string, "r");
-        printf("Fibre file %s open\n", string);
+        if (load_values_file(string, vx, N3, sc->input_binary_write) == false) found = false;
+        else printf("Fibre file %s read\n", string);
 
-        sprintf(string, "%s/Tissue_geometries/%s_OY.dat", PATH, t.orientation_file_root);
-        in2 = fopen(string, "r");
-        printf("Fibre file %s open\n", string);
+        if (found == true) sprintf(string, "%s/Tissue_geometries/%s_OY.dat", PATH, t.orientation_file_root);
+        if (found == true && load_values_file(string, vy, N3, sc->input_binary_write) == false) found = false;
+        else if (found == true) printf("Fibre file %s read\n", string);
 
-        sprintf(string, "%s/Tissue_geometries/%s_OZ.dat", PATH, t.orientation_file_root);
-        in3 = fopen(string, "r");
-        printf("Fibre file %s open\n", string);
+        if (found == true) sprintf(string, "%s/Tissue_geometries/%s_OZ.dat", PATH, t.orientation_file_root);
+        if (found == true && load_values_file(string, vz, N3, sc->input_binary_write) == false) found = false;
+        else if (found == true) printf("Fibre file %s read\n", string);
 
-        if (in1 == NULL || in2 == NULL || in3 == NULL)
+        if (found == false)
         {
             printf("Cannot load fibre files %s\t :: is the path correct? Does the file exist in that path?\n", string);
             exit(1);
         }
 
         // read in components to sc array
-        for (int k = 0; k < sc->NZ; k++)
+        for (idx = 0; idx < N3; idx++)
         {
-            for (int j = 0; j < sc->NY; j++)
-            {
-                for (int i = 0; i < sc->NX; i++)
-                {
-                    idx = i + (sc->NX*j) + (sc->NX * sc->NY * k);
+            X = (float)vx[idx];
+            Y = (float)vy[idx];
+            Z = (float)vz[idx];
 
-                    fscanf(in1, "%f ", &X);
-                    fscanf(in2, "%f ", &Y);
-                    fscanf(in3, "%f ", &Z);
+            if (X != 0 && sc->geo[idx] == 0)  printf("Fibre error  - fibre present where there is no geometry. Continuing..\n");
 
-                    if (X != 0 && sc->geo[idx] == 0)  printf("Fibre error  - fibre present where there is no geometry. Continuing..\n");
-
-                    if (sc->geo[idx] > 0) // note that ox, oy, oz arrays are only size Ncell, not NX*NY*NZ
-                    {
-                        //if (X == 0) printf("Fibre error\n");
-                        sc->ox[count]  = X;
-                        sc->oy[count]  = Y;
-                        sc->oz[count]  = Z;
-
-                        //ensure "normalised" (this is a soft check of each component; not a full check of the vector)
-                        if (sc->ox[count] > 1.0) sc->ox[count] = 1.0;
-                        if (sc->oy[count] > 1.0) sc->oy[count] = 1.0;
-                        if (sc->oz[count] > 1.0) sc->oz[count] = 1.0;
+            if (sc->geo[idx] > 0) // note that ox, oy, oz arrays are only size Ncell, not NX*NY*NZ
+            {
+                sc->ox[count]  = X;
+                sc->oy[count]  = Y;
+                sc->oz[count]  = Z;
 
-                        //printf("%f %f %f\n", sc->ox[count], sc->oy[count], sc->oz[count]);
+                //ensure "normalised" (this is a soft check of each component; not a full check of the vector)
+                if (sc->ox[count] > 1.0) sc->ox[count] = 1.0;
+                if (sc->oy[count] > 1.0) sc->oy[count] = 1.0;
+                if (sc->oz[count] > 1.0) sc->oz[count] = 1.0;
 
-                        count ++;
-                    }
-                }
+                count ++;
             }
         }
-
-        fclose(in1);
-        fclose(in2);
-        fclose(in3);
+        delete [] vx;
+        delete [] vy;
+        delete [] vz;
     } // end "xyz" style
 
     else if (strcmp(t.orientation_file_type, "orientation") == 0)
     {
         printf("Reading fibres, xyz style, from file...\n");
         float X, Y, Z;
+        double *v = new double[3*N3]; // X Y Z per voxel
 
-        // open fibre files
+        // read fibre file
         sprintf(string, "%s/Tissue_geometries/%s_orientation.dat", PATH, t.orientation_file_root);
-        in1 = fopen(string, "r");
-        printf("Fibre file %s open\n", string);
-
-        if (in1 == NULL)
+        if (load_values_file(string, v, 3*N3, sc->input_binary_write) == false)
         {
             printf("Cannot load fibre files %s\t :: is the path correct? Does the file exist in that path?\n", string);
             exit(1);
         }
+        printf("Fibre file %s read\n", string);
 
         // read in components to sc array
-        for (int k = 0; k < sc->NZ; k++)
+        for (idx = 0; idx < N3; idx++)
         {
-            for (int j = 0; j < sc->NY; j++)
-            {
-                for (int i = 0; i < sc->NX; i++)
-                {
-                    idx = i + (sc->NX*j) + (sc->NX * sc->NY * k);
+            X = (float)v[3*idx];
+            Y = (float)v[3*idx + 1];
+            Z = (float)v[3*idx + 2];
 
-                    fscanf(in1, "%f %f %f ", &X, &Y, &Z);
-                    //if (X != 0 && sc->geo[idx] == 0)  printf("Fibre error\n");
-
-                    if (sc->geo[idx] > 0) // note that ox, oy, oz arrays are only size Ncell, not NX*NY*NZ
-                    {
-                        //if (X == 0 && Y == 0 && Z == 0) printf("Fibre error\n");
-                        sc->ox[count]  = X;
-                        sc->oy[count]  = Y;
-                        sc->oz[count]  = Z;
-
-                        //ensure "normalised" (this is a soft check of each component; not a full check of the vector)
-                        if (sc->ox[count] > 1.0) sc->ox[count] = 1.0;
-                        if (sc->oy[count] > 1.0) sc->oy[count] = 1.0;
-                        if (sc->oz[count] > 1.0) sc->oz[count] = 1.0;
+            if (sc->geo[idx] > 0) // note that ox, oy, oz arrays are only size Ncell, not NX*NY*NZ
+            {
+                sc->ox[count]  = X;
+                sc->oy[count]  = Y;
+                sc->oz[count]  = Z;
 
-                        //printf("%f %f %f\n", sc->ox[count], sc->oy[count], sc->oz[count]);
+                //ensure "normalised" (this is a soft check of each component; not a full check of the vector)
+                if (sc->ox[count] > 1.0) sc->ox[count] = 1.0;
+                if (sc->oy[count] > 1.0) sc->oy[count] = 1.0;
+                if (sc->oz[count] > 1.0) sc->oz[count] = 1.0;
 
-                        count ++;
-                    }
-                }
-                //fscanf(in1, "\n");
+                count ++;
             }
-            //fscanf(in1, "\n");
         }
-        fclose(in1);
+        delete [] v;
     } // end "orientation" style
 
-    else if (strcmp(t.orientation_file_type, "angles") == 0)
+    else if (strcmp(t.orientation_file_type, "angles") == 0 || strcmp(t.orientation_file_type, "angles_short_axis") == 0)
     {
         float theta, phi;
+        double *vt = new double[N3];
+        double *vp = new double[N3];
+        bool short_axis = (strcmp(t.orientation_file_type, "angles_short_axis") == 0); // angles defined from the short axis
 
         sprintf(string, "%s/Tissue_geometries/%s_theta.dat", PATH, t.orientation_file_root);
-        in1 = fopen(string, "r");
-
-        sprintf(string, "%s/Tissue_geometries/%s_phi.dat", PATH, t.orientation_file_root);
-        in2 = fopen(string, "r");
-
-        if (in1 == NULL || in2 == NULL)
+        bool found = load_values_file(string, vt, N3, sc->input_binary_write);
+        if (found == true)
         {
-            printf("Cannot load fibre files %s\t :: is the path correct? Does the file exist in that path?\n", string);
-            exit(1);
-        }
-
-        // read and convert components to sc array
-        for (int k = 0; k < sc->NZ; k++)
-        {
-            for (int j = 0; j < sc->NY; j++)
-            {
-                for (int i = 0; i < sc->NX; i++)
-                {
-                    idx = i + (sc->NX*j) + (sc->NX * sc->NY * k);
-
-                    fscanf(in1, "%f ", &theta);
-                    fscanf(in2, "%f ", &phi);
-                    // radians
-
-                    if (sc->geo[idx] > 0) // note that ox, oy, oz arrays are only size Ncell, not NX*NY*NZ
-                    {
-                        sc->ox[count]  = sin(theta)*cos(phi);
-                        sc->oy[count]  = cos(theta)*cos(phi);
-                        sc->oz[count]  = sin(phi);
-
-                        if (theta < -10 || phi < -10) printf("ERROR -10\n");
-
-                        //printf("%f %f %f\n", sc->ox[count], sc->oy[count], sc->oz[count]);
-
-                        count ++;
-                    }
-                }
-            }
+            sprintf(string, "%s/Tissue_geometries/%s_phi.dat", PATH, t.orientation_file_root);
+            found = load_values_file(string, vp, N3, sc->input_binary_write);
         }
-        fclose(in1);
-        fclose(in2);
-    }  // end "angles" style
 
-    // angles style, where angles are defined from the short axis
-    else if (strcmp(t.orientation_file_type, "angles_short_axis") == 0)
-    {
-        float theta, phi;
-
-        sprintf(string, "%s/Tissue_geometries/%s_theta.dat", PATH, t.orientation_file_root);
-        in1 = fopen(string, "r");
-
-        sprintf(string, "%s/Tissue_geometries/%s_phi.dat", PATH, t.orientation_file_root);
-        in2 = fopen(string, "r");
-
-        if (in1 == NULL || in2 == NULL)
+        if (found == false)
         {
             printf("Cannot load fibre files %s\t :: is the path correct? Does the file exist in that path?\n", string);
             exit(1);
         }
 
         // read and convert components to sc array
-        for (int k = 0; k < sc->NZ; k++)
+        for (idx = 0; idx < N3; idx++)
         {
-            for (int j = 0; j < sc->NY; j++)
+            theta = (float)vt[idx];     // radians
+            phi   = (float)vp[idx];
+
+            if (sc->geo[idx] > 0) // note that ox, oy, oz arrays are only size Ncell, not NX*NY*NZ
             {
-                for (int i = 0; i < sc->NX; i++)
+                if (short_axis == true)
                 {
-                    idx = i + (sc->NX*j) + (sc->NX * sc->NY * k);
-
-                    fscanf(in1, "%f ", &theta);
-                    fscanf(in2, "%f ", &phi);
-
-                    if (sc->geo[idx] > 0) // note that ox, oy, oz arrays are only size Ncell, not NX*NY*NZ
-                    {
-                        sc->ox[count]  = cos(theta)*cos(phi);
-                        sc->oy[count]  = sin(theta)*cos(phi);
-                        sc->oz[count]  = sin(phi);
-
-                        if (theta < -10 || phi < -10) printf("ERROR -10\n");
+                    sc->ox[count]  = cos(theta)*cos(phi);
+                    sc->oy[count]  = sin(theta)*cos(phi);
+                }
+                else
+                {
+                    sc->ox[count]  = sin(theta)*cos(phi);
+                    sc->oy[count]  = cos(theta)*cos(phi);
+                }
+                sc->oz[count]  = sin(phi);
 
-                        //printf("%f %f %f\n", sc->ox[count], sc->oy[count], sc->oz[count]);
+                if (theta < -10 || phi < -10) printf("ERROR -10\n");
 
-                        count ++;
-                    }
-                }
+                count ++;
             }
         }
-        fclose(in1);
-        fclose(in2);
-    }  // end "angles_short_axis" style
+        delete [] vt;
+        delete [] vp;
+    }  // end "angles" and "angles_short_axis" styles
+    free(string);
 }
 
 void output_fibre_orientation(SC_variables sc, Tissue_parameters t, const char* Output_dir)
@@ -2532,25 +2611,145 @@ void calculate_CV(Tissue_parameters t, Model_variables *var, const char* directo
 }
 // End conduction velocity calculation ==========================================================//|
 
-// Conduction success calculation ===============================================================\\|
-void compute_conduction_success(Tissue_parameters t, Model_variables *var, int N, double S2_time, double S2_CL, const char* directory)
+// Conduction velocity maps =====================================================================\\|
+// CV vector at each node is grad(t_ex)/|grad(t_ex)|^2, with the gradient from central differences over
+// the x, y and z neighbours (one-sided where a neighbour is absent or not activated in the beat)
+void cv_map_setup(CV_maps *cv, Tissue_parameters t, SC_variables sc, double beat_start, const char *directory, bool restart)
 {
-    int left_ex, right_ex, ex_type;
+	cv->N			= sc.N;
+	cv->beat_start	= beat_start;
+	cv->exclude		= new bool[sc.N];
+	cv->t_ex		= new double[sc.N];
+	cv->CV			= new double[sc.N];
+	cv->CVx			= new double[sc.N];
+	cv->CVy			= new double[sc.N];
+	cv->CVz			= new double[sc.N];
+	cv->speeds		= new double[sc.N];
+	for (int n = 0; n < sc.N; n++) cv->exclude[n] = false;
+	for (int i = 0; i < t.stim_site_start[t.Nstim_sites]; i++) cv->exclude[t.stim_site_nodes[i]] = true;
+
+	char * filename = (char*)malloc(500);
+	sprintf(filename, "%s/CV_map_summary.dat", directory);
+	cv->summary = fopen(filename, (restart == true) ? "a" : "wt");
+	if (restart == false)
+	{
+		fprintf(cv->summary, "# beat time Nvalid CV_mean CV_sd CV_min CV_median CV_max (m/s)\n");
+		fflush(cv->summary); // the checkpoint records the on-disk length
+	}
+	free(filename);
+}
 
-    // if its most recent excitation is after the time of S2 stimulus, it was successful
-    // This is of course not infallable, if your situation is such that at time of S2, S1 is still propagating
-    // But works for almost all cases and doesn't seem worth the additional functionality
-    
+// d(t_ex)/dx along one axis; m and p are the minus and plus neighbours (the node itself at a boundary)
+static double cv_gradient(const double *t_ex, int n, int m, int p, double h, double t0)
+{
+	bool m_set = (m != n && t_ex[m] >= t0);
+	bool p_set = (p != n && t_ex[p] >= t0);
+	if (m_set == true && p_set == true) return (t_ex[p] - t_ex[m])/(2*h);
+	if (p_set == true) return (t_ex[p] - t_ex[n])/h;
+	if (m_set == true) return (t_ex[n] - t_ex[m])/h;
+	return 0;
+}
+
+// Map of the beat ending at "time" (nodes activated since beat_start); written as CV{,x,y,z}_output_<beat>.bin
+// Activation times are gathered from the Model_variables (also kept by the measurement engine)
+// Returns the number of nodes with a valid CV; nothing is written if no node was activated
+int cv_map_beat(CV_maps *cv, SC_variables sc, Model_variables *var, double time, int beat, const char *dir, const char *dir2)
+{
+	#pragma omp parallel for
+	for (int n = 0; n < cv->N; n++) cv->t_ex[n] = var[n].t_ex;
+	const double *t_ex = cv->t_ex;
+
+	double t0		= cv->beat_start;
+	int Nactivated	= 0;
+	#pragma omp parallel for reduction(+:Nactivated)
+	for (int n = 0; n < cv->N; n++)
+	{
+		cv->CV[n] = cv->CVx[n] = cv->CVy[n] = cv->CVz[n] = 0;
+		if (t_ex[n] < t0) continue;
+		Nactivated++;
+		if (cv->exclude[n] == true) continue;
+
+		double gx	= cv_gradient(t_ex, n, sc.xm[n], sc.xp[n], sc.dx, t0);	// ms/mm
+		double gy	= cv_gradient(t_ex, n, sc.ym[n], sc.yp[n], sc.dy, t0);
+		double gz	= cv_gradient(t_ex, n, sc.zm[n], sc.zp[n], sc.dz, t0);
+		double g2	= gx*gx + gy*gy + gz*gz;
+		if (g2 == 0) continue;
+		cv->CVx[n]	= gx/g2;	// mm/ms = m/s
+		cv->CVy[n]	= gy/g2;
+		cv->CVz[n]	= gz/g2;
+		cv->CV[n]	= 1.0/sqrt(g2);
+	}
+	cv->beat_start = time;
+	if (Nactivated == 0) return 0;
+
+	// Summary statistics over the valid nodes
+	int Nvalid = 0;
+	double sum = 0, sum2 = 0, min = 0, max = 0, median = 0;
+	for (int n = 0; n < cv->N; n++) if (cv->CV[n] > 0) cv->speeds[Nvalid++] = cv->CV[n];
+	if (Nvalid > 0)
+	{
+		min = max = cv->speeds[0];
+		for (int i = 0; i < Nvalid; i++)
+		{
+			sum		+= cv->speeds[i];
+			sum2	+= cv->speeds[i]*cv->speeds[i];
+			if (cv->speeds[i] < min) min = cv->speeds[i];
+			if (cv->speeds[i] > max) max = cv->speeds[i];
+		}
+		std::nth_element(cv->speeds, cv->speeds + Nvalid/2, cv->speeds + Nvalid);
+		median = cv->speeds[Nvalid/2];
+	}
+	double mean	= (Nvalid > 0) ? sum/Nvalid : 0;
+	double sd	= (Nvalid > 0) ? sqrt(fmax(sum2/Nvalid - mean*mean, 0)) : 0;
+	fprintf(cv->summary, "%d %f %d %f %f %f %f %f\n", beat, time, Nvalid, mean, sd, min, median, max);
+	fflush(cv->summary);
+	printf("CV map beat %d: %d nodes, mean = %.3f m/s (min %.3f, median %.3f, max %.3f)\n", beat, Nvalid, mean, min, median, max);
+
+	array_1D_output("CV", dir, dir2, cv->CV, sc, beat);		// lib/Outputs.cpp
+	array_1D_output("CVx", dir, dir2, cv->CVx, sc, beat);
+	if (sc.NY > 1) array_1D_output("CVy", dir, dir2, cv->CVy, sc, beat);
+	if (sc.NZ > 1) array_1D_output("CVz", dir, dir2, cv->CVz, sc, beat);
+	return Nvalid;
+}
+
+void cv_map_free(CV_maps *cv)
+{
+	if (cv->N == 0) return;
+	fclose(cv->summary);
+	delete [] cv->exclude;
+	delete [] cv->t_ex;
+	delete [] cv->CV;
+	delete [] cv->CVx;
+	delete [] cv->CVy;
+	delete [] cv->CVz;
+	delete [] cv->speeds;
+	cv->N = 0;
+}
+// End Conduction velocity maps =================================================================//|
+
+// Conduction success calculation ===============================================================\\|
+// if its most recent excitation is after the time of S2 stimulus, it was successful
+// This is of course not infallable, if your situation is such that at time of S2, S1 is still propagating
+// But works for almost all cases and doesn't seem worth the additional functionality
+int conduction_success_type(Model_variables *var, int N, double S2_ex_time, int *left_ex, int *right_ex)
+{
     // Left success
-    if (var[3].t_ex > S2_time-5) left_ex = 1; 
-    else left_ex = 0;
+    if (var[3].t_ex > S2_ex_time) *left_ex = 1; 
+    else *left_ex = 0;
 
     // Right success
-    if (var[N - 3].t_ex > S2_time-5) right_ex = 1; 
-    else right_ex = 0;
+    if (var[N - 3].t_ex > S2_ex_time) *right_ex = 1; 
+    else *right_ex = 0;
+
+    return *left_ex + *right_ex; // 0 for no conduction, 1 for uni block, 2 for full conduction
+}
+
+void compute_conduction_success(Tissue_parameters t, Model_variables *var, int N, double S2_time, double S2_CL, const char* directory)
+{
+    int left_ex, right_ex, ex_type;
 
     // Determine excitation type
-    ex_type = left_ex + right_ex; // 0 for no conduction, 1 for uni block, 2 for full conduction
+    ex_type = conduction_success_type(var, N, S2_time-5, &left_ex, &right_ex);
 
     // Print to screen
     printf("S2 loc = %d\t S2 = %f\tleft excitation = %d\tright excitation = %d\tconduction success type = %d\n", t.S2_x_loc, S2_CL, left_ex, right_ex, ex_type);
@@ -2568,3 +2767,644 @@ void compute_conduction_success(Tissue_parameters t, Model_variables *var, int N
 }
 // End Conduction success calculation ===========================================================//|
 
+// Event-driven measurement engine ==============================================================\\|
+// Tissue replacement for determine_excitation_state() and calculate_measurement_properties(): only
+// activation time and the requested APD levels are kept. Per step, each node checks the upstroke or
+// repolarisation threshold and its running minimum, and only the next APD level to be crossed.
+// Levels are those of Model_variables APD_p[], so the results are checkpointed with the Model_variables
+
+// Levels from "p1,p2,..." (% repolarisation); state taken from the Model_variables so a restart continues
+void measurement_engine_setup(Measurement_engine *me, const char *levels, Model_variables *var, int N, const int *full_nodes, int Nfull)
+{
+	me->Nlevels = 0;
+	char *list = strdup(levels);
+	for (char *tok = strtok(list, ","); tok != NULL; tok = strtok(NULL, ","))
+	{
+		int p = atoi(tok);
+		if (p < 10 || p > 90 || p%10 != 0)
+		{
+			printf("ERROR: Measurement_APD levels must be multiples of 10 %% repolarisation (10 - 90); \"%s\" passed\n", tok);
+			exit(1);
+		}
+		if (me->Nlevels == 9)
+		{
+			printf("ERROR: at most 9 Measurement_APD levels can be measured\n");
+			exit(1);
+		}
+		// Insert in increasing order
+		int l = me->Nlevels;
+		while (l > 0 && me->percent[l-1] > p) { me->percent[l] = me->percent[l-1]; l--; }
+		if (l > 0 && me->percent[l-1] == p)
+		{
+			printf("ERROR: Measurement_APD level %d passed twice\n", p);
+			exit(1);
+		}
+		me->percent[l] = p;
+		me->Nlevels++;
+	}
+	free(list);
+	if (me->Nlevels == 0)
+	{
+		printf("ERROR: no Measurement_APD levels passed\n");
+		exit(1);
+	}
+	for (int l = 0; l < me->Nlevels; l++)
+	{
+		me->level[l]		= me->percent[l];
+		me->level[l]		*= 0.01;	// as calculate_measurement_properties(), so thresholds are identical
+		me->APD_p_index[l]	= me->percent[l]/10 - 1;
+	}
+
+	me->N		= N;
+	me->full	= new bool[N];
+	me->excited	= new unsigned char[N];
+	me->next	= new unsigned char[N];
+	me->Vmin	= new double[N];
+	me->Vrest	= new double[N];
+	me->Vmax	= new double[N];
+	for (int n = 0; n < N; n++)
+	{
+		me->full[n]		= false;
+		me->excited[n]	= var[n].ex_switch;
+		me->Vmin[n]		= var[n].Vmin;
+		me->Vrest[n]	= var[n].Vmin_prev;
+		me->Vmax[n]		= var[n].Vmax;
+		me->next[n]		= me->Nlevels;
+		for (int l = me->Nlevels-1; l >= 0; l--) if (var[n].APD_p_switch[me->APD_p_index[l]] == 0) me->next[n] = l;
+	}
+	for (int r = 0; r < Nfull; r++) me->full[full_nodes[r]] = true;
+
+	printf("Event-driven measurement: activation time and APD");
+	for (int l = 0; l < me->Nlevels; l++) printf("%s%d", (l == 0) ? "" : ",", me->percent[l]);
+	printf(" (full measurement on %d reference and probe nodes)\n", Nfull);
+}
+
+// "Vm1" is voltage at t-dt, "Vm2" at t (as determine_excitation_state() and calculate_measurement_properties())
+// Not for the full nodes, whose Model_variables are set by the full routines
+void measurement_engine_step(Measurement_engine *me, Model_variables *var, int n, double Vm1, double Vm2, double time)
+{
+	// Upstroke and repolarisation, with the thresholds of determine_excitation_state()
+	if (me->excited[n] == 0)
+	{
+		if (Vm1 > -30)
+		{
+			me->excited[n]	= 1;
+			var->t_ex		= time;
+			me->Vrest[n]	= me->Vmin[n];
+			me->Vmin[n]		= 50;
+			me->Vmax[n]		= -80;
+			me->next[n]		= 0;
+			for (int l = 0; l < me->Nlevels; l++) var->APD_p_switch[me->APD_p_index[l]] = 0;
+		}
+	}
+	else if (Vm1 < -45) me->excited[n] = 0;
+
+	// Minimum while repolarising; the reference for the APD levels of the next beat
+	if (Vm2 <= Vm1 && Vm2 < me->Vmin[n]) me->Vmin[n] = Vm2;
+
+	// APD levels || thresholds decrease with level, so only the next one needs checking
+	int l = me->next[n];
+	if (l < me->Nlevels)
+	{
+		if (Vm2 > me->Vmax[n]) me->Vmax[n] = Vm2;
+		while (l < me->Nlevels && Vm2 < me->Vmax[n] - me->level[l]*(me->Vmax[n] - me->Vrest[n]))
+		{
+			var->APD_p[me->APD_p_index[l]]			= time - var->t_ex;
+			var->APD_p_switch[me->APD_p_index[l]]	= 1;
+			l++;
+		}
+		me->next[n] = l;
+	}
+}
+
+// Writes the compact engine fields to the Model_variables, for snapshots and checkpoints (t_ex and APDs are already there)
+// Full nodes already hold the full measurements
+void measurement_engine_sync(Measurement_engine *me, Model_variables *var)
+{
+	#pragma omp parallel for
+	for (int n = 0; n < me->N; n++)
+	{
+		if (me->full[n] == true) continue;
+		var[n].ex_switch	= me->excited[n];
+		var[n].Vmin			= me->Vmin[n];
+		var[n].Vmin_prev	= me->Vrest[n];
+		var[n].Vmax			= me->Vmax[n];
+	}
+}
+
+void measurement_engine_free(Measurement_engine *me)
+{
+	if (me->N == 0) return;
+	delete [] me->full;
+	delete [] me->excited;
+	delete [] me->next;
+	delete [] me->Vmin;
+	delete [] me->Vrest;
+	delete [] me->Vmax;
+	me->N = 0;
+}
+// End Event-driven measurement engine ==========================================================//|
+
+// APD and repolarisation maps ==================================================================\\|
+// Beats run from one stimulus onset to the next (as the CV maps). A beat's map is deferred until every node activated in it
+// has crossed all levels (its values are then taken) or has re-activated (left out); it is written when the next mapped beat
+// ends at the latest. Checked once per ms (apd_map_update())
+
+// Maps the levels of the measurement engine if it is on, else APD30, 50 and 90 from the Model_variables
+void apd_map_setup(APD_maps *am, Measurement_engine *me, int N, int interval, const char *directory, bool restart)
+{
+	if (me->N > 0)
+	{
+		am->Nlevels = me->Nlevels;
+		for (int l = 0; l < me->Nlevels; l++) am->percent[l] = me->percent[l];
+	}
+	else
+	{
+		am->Nlevels		= 3;
+		am->percent[0]	= 30;
+		am->percent[1]	= 50;
+		am->percent[2]	= 90;
+	}
+	am->N				= N;
+	am->interval		= interval;
+	am->pending_beat	= 0;
+	am->pending_start	= 0;
+	am->pending_end		= 0;
+	am->APD				= new double[(am->Nlevels+2)*N];	// APD, RT and open in one block, for checkpoints
+	am->RT				= am->APD + am->Nlevels*N;
+	am->open			= am->RT + N;
+	am->dispersion		= new double[N];
+	for (int i = 0; i < (am->Nlevels+2)*N; i++) am->APD[i] = 0;
+
+	char * filename = (char*)malloc(500);
+	sprintf(filename, "%s/APD_map_summary.dat", directory);
+	am->summary = fopen(filename, (restart == true) ? "a" : "wt");
+	if (restart == false)
+	{
+		fprintf(am->summary, "# beat time Nvalid");
+		for (int l = 0; l < am->Nlevels; l++) fprintf(am->summary, " APD%d_mean APD%d_sd APD%d_min APD%d_max", am->percent[l], am->percent[l], am->percent[l], am->percent[l]);
+		fprintf(am->summary, " RT_min RT_max dispersion_mean dispersion_max (ms)\n");
+		fflush(am->summary); // the checkpoint records the on-disk length
+	}
+	free(filename);
+}
+
+// Writes the pending map (nodes still open are left out) as APD<p>_output_<beat>.bin, RT_output_<beat>.bin and
+// RT_dispersion_output_<beat>.bin; nothing is written for a beat without mapped nodes. Returns the number of nodes mapped
+static int apd_map_write(APD_maps *am, SC_variables sc, const char *dir, const char *dir2)
+{
+	int L		= am->Nlevels;
+	int beat	= am->pending_beat;
+	am->pending_beat = 0;
+	int Nvalid	= 0;
+	for (int n = 0; n < am->N; n++) if (am->RT[n] != 0) Nvalid++;
+	if (Nvalid == 0) return 0;
+
+	// Local dispersion || largest difference in repolarisation time to a mapped neighbour
+	#pragma omp parallel for
+	for (int n = 0; n < am->N; n++)
+	{
+		am->dispersion[n] = 0;
+		if (am->RT[n] == 0) continue;
+		int nb[6] = {sc.xm[n], sc.xp[n], sc.ym[n], sc.yp[n], sc.zm[n], sc.zp[n]};
+		for (int k = 0; k < 6; k++)
+		{
+			if (nb[k] == n || am->RT[nb[k]] == 0) continue;
+			double d = fabs(am->RT[n] - am->RT[nb[k]]);
+			if (d > am->dispersion[n]) am->dispersion[n] = d;
+		}
+	}
+
+	// Summary statistics over the mapped nodes
+	double mean = 0;
+	fprintf(am->summary, "%d %f %d", beat, am->pending_end, Nvalid);
+	for (int l = 0; l < L; l++)
+	{
+		double *APD = &am->APD[l*am->N];
+		double sum = 0, sum2 = 0, min = 0, max = 0;
+		bool set = false;
+		for (int n = 0; n < am->N; n++)
+		{
+			if (am->RT[n] == 0) continue;
+			sum		+= APD[n];
+			sum2	+= APD[n]*APD[n];
+			if (set == false || APD[n] < min) min = APD[n];
+			if (set == false || APD[n] > max) max = APD[n];
+			set = true;
+		}
+		mean = sum/Nvalid;
+		fprintf(am->summary, " %f %f %f %f", mean, sqrt(fmax(sum2/Nvalid - mean*mean, 0)), min, max);
+	}
+	double RT_min = 0, RT_max = 0, disp_sum = 0, disp_max = 0;
+	bool set = false;
+	for (int n = 0; n < am->N; n++)
+	{
+		if (am->RT[n] == 0) continue;
+		if (set == false || am->RT[n] < RT_min) RT_min = am->RT[n];
+		if (set == false || am->RT[n] > RT_max) RT_max = am->RT[n];
+		disp_sum += am->dispersion[n];
+		if (am->dispersion[n] > disp_max) disp_max = am->dispersion[n];
+		set = true;
+	}
+	fprintf(am->summary, " %f %f %f %f\n", RT_min, RT_max, disp_sum/Nvalid, disp_max);
+	fflush(am->summary);
+	printf("APD map beat %d: %d nodes, mean APD%d = %.2f ms, RT range = %.2f ms, max local dispersion = %.2f ms\n", beat, Nvalid, am->percent[L-1], mean, RT_max - RT_min, disp_max);
+
+	char name[50];
+	for (int l = 0; l < L; l++)
+	{
+		sprintf(name, "APD%d", am->percent[l]);
+		array_1D_output(name, dir, dir2, &am->APD[l*am->N], sc, beat);		// lib/Outputs.cpp
+	}
+	array_1D_output("RT", dir, dir2, am->RT, sc, beat);
+	array_1D_output("RT_dispersion", dir, dir2, am->dispersion, sc, beat);
+	return Nvalid;
+}
+
+// Takes the values of the open nodes which have crossed all levels, and closes those which have re-activated;
+// the map is written once no node is open. Returns the number of nodes still open
+int apd_map_update(APD_maps *am, SC_variables sc, Model_variables *var, const char *dir, const char *dir2)
+{
+	if (am->pending_beat == 0) return 0;
+	int L		= am->Nlevels;
+	int Nopen	= 0;
+	#pragma omp parallel for reduction(+:Nopen)
+	for (int n = 0; n < am->N; n++)
+	{
+		if (am->open[n] == 0) continue;
+		if (var[n].t_ex >= am->pending_end)
+		{
+			am->open[n] = 0;	// re-activated before crossing all levels
+			continue;
+		}
+		bool done = true;
+		for (int l = 0; l < L; l++) done = done && (var[n].APD_p_switch[am->percent[l]/10 - 1] == 1);
+		if (done == false)
+		{
+			Nopen++;
+			continue;
+		}
+		for (int l = 0; l < L; l++) am->APD[l*am->N + n] = var[n].APD_p[am->percent[l]/10 - 1];
+		am->RT[n]	= var[n].t_ex + am->APD[(L-1)*am->N + n];
+		am->open[n]	= 0;
+	}
+	if (Nopen == 0) apd_map_write(am, sc, dir, dir2);
+	return Nopen;
+}
+
+// End of the beat from "start" to "end": the pending map is written (as it stands), and this beat becomes pending if it is
+// an interval-th beat or the final one ("last"; written at once)
+void apd_map_beat(APD_maps *am, SC_variables sc, Model_variables *var, double start, double end, int beat, bool last, const char *dir, const char *dir2)
+{
+	if (am->pending_beat != 0) apd_map_write(am, sc, dir, dir2);
+	if (last == false && beat%am->interval != 0) return;
+
+	am->pending_beat	= beat;
+	am->pending_start	= start;
+	am->pending_end		= end;
+	#pragma omp parallel for
+	for (int n = 0; n < am->N; n++)
+	{
+		for (int l = 0; l < am->Nlevels; l++) am->APD[l*am->N + n] = 0;
+		am->RT[n]	= 0;
+		am->open[n]	= (var[n].t_ex >= start && var[n].t_ex < end) ? 1 : 0;
+	}
+	apd_map_update(am, sc, var, dir, dir2);
+	if (last == true && am->pending_beat != 0) apd_map_write(am, sc, dir, dir2);
+}
+
+void apd_map_free(APD_maps *am)
+{
+	if (am->N == 0) return;
+	fclose(am->summary);
+	delete [] am->APD;
+	delete [] am->dispersion;
+	am->N = 0;
+}
+// End APD and repolarisation maps ==============================================================//|
+
+
+// Tissue cache =================================================================================\\|
+// All SC arrays set during tissue setup (geometry, index, neighbours, orientation, D, dD and laplacian)
+// are written once to a binary file named by a hash of the settings and input files they depend on,
+// and loaded on subsequent runs in place of the setup
+
+// FNV-1a 64 bit
+static unsigned long long hash_bytes(unsigned long long h, const void *data, size_t size)
+{
+    const unsigned char *c = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) { h ^= c[i]; h *= 1099511628211ULL; }
+    return h;
+}
+
+static unsigned long long hash_string(unsigned long long h, const char *string)
+{
+    if (string == NULL) string = "(null)";
+    return hash_bytes(h, string, strlen(string) + 1);
+}
+
+// Hashes file contents (and any binary copy used in preference by load_values_file); missing files hash as their name only
+static unsigned long long hash_file(unsigned long long h, const char *filename)
+{
+    char binname[1000];
+    sprintf(binname, "%s.bin", filename);
+    const char *files[2] = {filename, binname};
+    for (int f = 0; f < 2; f++)
+    {
+        h = hash_string(h, files[f]);
+        int fd = open(files[f], O_RDONLY);
+        if (fd < 0) continue;
+        struct stat st;
+        fstat(fd, &st);
+        if (st.st_size > 0)
+        {
+            void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                h = hash_bytes(h, data, st.st_size);
+                munmap(data, st.st_size);
+            }
+        }
+        close(fd);
+    }
+    return h;
+}
+
+unsigned long long tissue_cache_key(Tissue_parameters t, const char *PATH)
+{
+    char file[1000];
+    unsigned long long h = 14695981039346656037ULL;
+
+    h = hash_string(h, "MSCSF tissue cache v1");
+    h = hash_string(h, t.Tissue_order);
+    h = hash_string(h, t.Tissue_model);
+    h = hash_string(h, t.Tissue_type);
+    h = hash_string(h, t.Orientation_type);
+    h = hash_string(h, t.D_uniformity);
+    h = hash_string(h, t.Dscale_map_on);
+    h = hash_string(h, t.D_AR_scale_map_on);
+    h = hash_string(h, t.map_in_type);
+    h = hash_string(h, t.ideal_map_shape);
+    h = hash_string(h, t.Global_orientation_direction);
+    int ints[10]       = {t.NX, t.NY, t.NZ, t.Ncelltypes, t.ideal_map_x_loc, t.ideal_map_x_size, t.ideal_map_y_loc, t.ideal_map_y_size, t.ideal_map_z_loc, t.ideal_map_z_size};
+    double doubles[12] = {t.dx, t.dy, t.dz, t.D1, t.D2, t.D_AR, t.Diso, t.Dscale, t.D_AR_scale, t.OX, t.OY, t.OZ};
+    h = hash_bytes(h, ints, sizeof(ints));
+    h = hash_bytes(h, doubles, sizeof(doubles));
+    h = hash_bytes(h, t.non_uniform_D1_scale, sizeof(t.non_uniform_D1_scale));
+    h = hash_bytes(h, t.non_uniform_AR_scale, sizeof(t.non_uniform_AR_scale));
+    h = hash_bytes(h, t.het_junction_X_location, sizeof(t.het_junction_X_location));
+
+    // Input files (anatomical models only)
+    if (strcmp(t.Tissue_order, "geo") == 0)
+    {
+        sprintf(file, "%s/Tissue_geometries/%s", PATH, t.geo_file);                                     h = hash_file(h, file);
+        if (strcmp(t.Orientation_type, "anisotropic") == 0)
+        {
+            const char *suffix[6] = {"OX", "OY", "OZ", "orientation", "theta", "phi"};
+            h = hash_string(h, t.orientation_file_type);
+            for (int i = 0; i < 6; i++) { sprintf(file, "%s/Tissue_geometries/%s_%s.dat", PATH, t.orientation_file_root, suffix[i]); h = hash_file(h, file); }
+        }
+        if (strcmp(t.D_uniformity, "map") == 0 || strcmp(t.D_uniformity, "regional_map") == 0)
+        {
+            sprintf(file, "%s/Tissue_geometries/%s", PATH, t.Dscale_base_map_file);                     h = hash_file(h, file);
+            sprintf(file, "%s/Tissue_geometries/%s", PATH, t.D_AR_scale_base_map_file);                 h = hash_file(h, file);
+        }
+        if (strcmp(t.Dscale_map_on, "On") == 0)     { sprintf(file, "%s/Tissue_geometries/%s", PATH, t.Dscale_mod_map_file);      h = hash_file(h, file); }
+        if (strcmp(t.D_AR_scale_map_on, "On") == 0) { sprintf(file, "%s/Tissue_geometries/%s", PATH, t.D_AR_scale_mod_map_file);  h = hash_file(h, file); }
+    }
+    return h;
+}
+
+// Lists the cached Ncell arrays so that read and write are always consistent
+static int tissue_cache_int_arrays(SC_variables *sc, int ***arrays)
+{
+    static int *a[31];
+    int i = 0;
+    a[i++] = sc->geo_linear;  a[i++] = sc->geo_3D_index;  a[i++] = sc->x_index;  a[i++] = sc->y_index;  a[i++] = sc->z_index;
+    a[i++] = sc->xp;  a[i++] = sc->xm;  a[i++] = sc->yp;  a[i++] = sc->ym;  a[i++] = sc->zp;  a[i++] = sc->zm;
+    a[i++] = sc->xp_yp;  a[i++] = sc->xp_ym;  a[i++] = sc->xp_zp;  a[i++] = sc->xp_zm;
+    a[i++] = sc->xm_yp;  a[i++] = sc->xm_ym;  a[i++] = sc->xm_zp;  a[i++] = sc->xm_zm;
+    a[i++] = sc->yp_zp;  a[i++] = sc->yp_zm;  a[i++] = sc->ym_zp;  a[i++] = sc->ym_zm;
+    a[i++] = sc->xm_ym_zm;  a[i++] = sc->xm_ym_zp;  a[i++] = sc->xm_yp_zm;  a[i++] = sc->xm_yp_zp;
+    a[i++] = sc->xp_ym_zm;  a[i++] = sc->xp_ym_zp;  a[i++] = sc->xp_yp_zm;  a[i++] = sc->xp_yp_zp;
+    *arrays = a;
+    return i;
+}
+
+static int tissue_cache_double_arrays(SC_variables *sc, double ***arrays)
+{
+    static double *a[40];
+    int i = 0;
+    a[i++] = sc->D;  a[i++] = sc->D1;  a[i++] = sc->D2;
+    a[i++] = sc->Dxx;  a[i++] = sc->Dyy;  a[i++] = sc->Dzz;  a[i++] = sc->Dxy;  a[i++] = sc->Dxz;  a[i++] = sc->Dyz;
+    a[i++] = sc->dDxx_dx;  a[i++] = sc->dDxy_dx;  a[i++] = sc->dDxz_dx;  a[i++] = sc->dDyy_dy;  a[i++] = sc->dDxy_dy;
+    a[i++] = sc->dDyz_dy;  a[i++] = sc->dDzz_dz;  a[i++] = sc->dDxz_dz;  a[i++] = sc->dDyz_dz;
+    a[i++] = sc->ox;  a[i++] = sc->oy;  a[i++] = sc->oz;
+    a[i++] = sc->lap_self;  a[i++] = sc->lap_xm;  a[i++] = sc->lap_xp;  a[i++] = sc->lap_ym;  a[i++] = sc->lap_yp;
+    a[i++] = sc->lap_zm;  a[i++] = sc->lap_zp;  a[i++] = sc->lap_xm_ym;  a[i++] = sc->lap_xm_yp;  a[i++] = sc->lap_xp_ym;
+    a[i++] = sc->lap_xp_yp;  a[i++] = sc->lap_xm_zm;  a[i++] = sc->lap_xm_zp;  a[i++] = sc->lap_xp_zm;  a[i++] = sc->lap_xp_zp;
+    a[i++] = sc->lap_ym_zm;  a[i++] = sc->lap_ym_zp;  a[i++] = sc->lap_yp_zm;  a[i++] = sc->lap_yp_zp;
+    *arrays = a;
+    return i;
+}
+
+// Layout: "MSCSFTC1", key, NX NY NZ N, dx dy dz, geo and geo_index (NX*NY*NZ), int arrays (N), double arrays (N)
+// Reads the cache if present and matching; allocates Ncell arrays (SC_array_allocation_Ncell) and returns true
+bool read_tissue_cache(SC_variables *sc, const char *filename, unsigned long long key)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    fstat(fd, &st);
+    size_t size = st.st_size;
+    size_t header_size = 8 + sizeof(unsigned long long) + 4*sizeof(int) + 3*sizeof(double);
+    if (size < header_size) { close(fd); return false; }
+    const char *data = (const char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+
+    const char *c = data;
+    unsigned long long file_key;
+    int dims[4];
+    double steps[3];
+    bool valid = (strncmp(c, "MSCSFTC1", 8) == 0);                          c += 8;
+    memcpy(&file_key, c, sizeof(file_key));                                 c += sizeof(file_key);
+    memcpy(dims, c, sizeof(dims));                                          c += sizeof(dims);
+    memcpy(steps, c, sizeof(steps));                                        c += sizeof(steps);
+
+    size_t N3 = (size_t)dims[0] * dims[1] * dims[2];
+    size_t N  = dims[3];
+    if (valid == false || file_key != key || dims[0] != sc->NX || dims[1] != sc->NY || dims[2] != sc->NZ || size != header_size + 2*N3*sizeof(int) + 31*N*sizeof(int) + 40*N*sizeof(double))
+    {
+        printf("Tissue cache %s does not match current settings; rebuilding\n", filename);
+        munmap((void*)data, size);
+        return false;
+    }
+
+    sc->N  = N;
+    sc->dx = steps[0];
+    sc->dy = steps[1];
+    sc->dz = steps[2];
+    memcpy(sc->geo, c, N3*sizeof(int));                                     c += N3*sizeof(int);
+    memcpy(sc->geo_index, c, N3*sizeof(int));                               c += N3*sizeof(int);
+
+    SC_array_allocation_Ncell(sc, sc->N);       // lib/Spatial_coupling.cpp
+    int **iarr;
+    double **darr;
+    int Ni = tissue_cache_int_arrays(sc, &iarr);
+    int Nd = tissue_cache_double_arrays(sc, &darr);
+    for (int i = 0; i < Ni; i++) { memcpy(iarr[i], c, N*sizeof(int));       c += N*sizeof(int); }
+    for (int i = 0; i < Nd; i++) { memcpy(darr[i], c, N*sizeof(double));    c += N*sizeof(double); }
+
+    munmap((void*)data, size);
+    printf("Tissue cache %s read || Ncells = %d\n", filename, sc->N);
+    return true;
+}
+
+// Writes to a temporary file then renames, so concurrent runs never see a partial cache
+void write_tissue_cache(SC_variables *sc, const char *filename, unsigned long long key)
+{
+    char temp[1000];
+    sprintf(temp, "%s.%d.tmp", filename, (int)getpid());
+    FILE *out = fopen(temp, "wb");
+    if (out == NULL)
+    {
+        printf("WARNING: cannot write tissue cache %s\n", filename);
+        return;
+    }
+    int dims[4]       = {sc->NX, sc->NY, sc->NZ, sc->N};
+    double steps[3]   = {sc->dx, sc->dy, sc->dz};
+    size_t N3         = (size_t)sc->NX * sc->NY * sc->NZ;
+    fwrite("MSCSFTC1", 1, 8, out);
+    fwrite(&key, sizeof(key), 1, out);
+    fwrite(dims, sizeof(int), 4, out);
+    fwrite(steps, sizeof(double), 3, out);
+    fwrite(sc->geo, sizeof(int), N3, out);
+    fwrite(sc->geo_index, sizeof(int), N3, out);
+
+    int **iarr;
+    double **darr;
+    int Ni = tissue_cache_int_arrays(sc, &iarr);
+    int Nd = tissue_cache_double_arrays(sc, &darr);
+    for (int i = 0; i < Ni; i++) fwrite(iarr[i], sizeof(int), sc->N, out);
+    for (int i = 0; i < Nd; i++) fwrite(darr[i], sizeof(double), sc->N, out);
+    fclose(out);
+    rename(temp, filename);
+    printf("Tissue cache %s written\n", filename);
+}
+// End Tissue cache =============================================================================//|
+
+// Parameter regions ============================================================================\\|
+// Nodes with identical local conditions (celltype region, ISO, remodelling, ACh, spatial gradient and
+// direct modulation map) have identical parameters, so only one node per region needs the full setup.
+// The ISO, remodelling and ACh map values are part of the key so that regions stay valid if the global
+// conditions change during the run (modulation events).
+// region_node[n] returns the node whose parameters n copies (itself if it is the first of its region);
+// region_list holds those first nodes in increasing order. Returns the number of regions.
+static bool same_parameter_region(Tissue_parameters t, SC_variables sc, Cell_parameters *Params, int n, int m)
+{
+    if (sc.geo_linear[n] != sc.geo_linear[m]) return false;
+    if (Params[n].ISO != Params[m].ISO || Params[n].Remodelling_prop != Params[m].Remodelling_prop) return false;
+    if (Params[n].ACh != Params[m].ACh || Params[n].spatial_gradient_prop != Params[m].spatial_gradient_prop) return false;
+    if (strcmp(t.Direct_modulation_map_on, "On") == 0 && (t.Direct_modulation_map[n] > 0.0) != (t.Direct_modulation_map[m] > 0.0)) return false;
+    if (t.Nstrands > 0 && sc.y_index[n] != sc.y_index[m]) return false; // strands have their own arguments
+    if (strcmp(t.ISO_map_on, "On") == 0 && t.ISO_map[n] != t.ISO_map[m]) return false;
+    if (strcmp(t.remod_map_on, "On") == 0 && t.remod_map[n] != t.remod_map[m]) return false;
+    if (strcmp(t.ACh_map_on, "On") == 0 && t.ACh_map[n] != t.ACh_map[m]) return false;
+    return true;
+}
+
+int set_parameter_regions(Tissue_parameters t, SC_variables sc, Cell_parameters *Params, int *region_node, int *region_list)
+{
+    std::unordered_map<unsigned long long, int> regions;
+    int Nregions = 0;
+    bool DC_map = (strcmp(t.Direct_modulation_map_on, "On") == 0);
+    bool ISO_map = (strcmp(t.ISO_map_on, "On") == 0);
+    bool remod_map = (strcmp(t.remod_map_on, "On") == 0);
+    bool ACh_map = (strcmp(t.ACh_map_on, "On") == 0);
+
+    for (int n = 0; n < sc.N; n++)
+    {
+        int DC = (DC_map == true && t.Direct_modulation_map[n] > 0.0) ? 1 : 0;
+        int strand = (t.Nstrands > 0) ? sc.y_index[n] : 0;
+        unsigned long long h = 14695981039346656037ULL;
+        h = hash_bytes(h, &sc.geo_linear[n], sizeof(int));
+        h = hash_bytes(h, &Params[n].ISO, sizeof(double));
+        h = hash_bytes(h, &Params[n].Remodelling_prop, sizeof(double));
+        h = hash_bytes(h, &Params[n].ACh, sizeof(double));
+        h = hash_bytes(h, &Params[n].spatial_gradient_prop, sizeof(double));
+        h = hash_bytes(h, &DC, sizeof(int));
+        h = hash_bytes(h, &strand, sizeof(int));
+        if (ISO_map == true) h = hash_bytes(h, &t.ISO_map[n], sizeof(double));
+        if (remod_map == true) h = hash_bytes(h, &t.remod_map[n], sizeof(double));
+        if (ACh_map == true) h = hash_bytes(h, &t.ACh_map[n], sizeof(double));
+
+        std::unordered_map<unsigned long long, int>::iterator it = regions.find(h);
+        if (it != regions.end() && same_parameter_region(t, sc, Params, n, it->second) == true) region_node[n] = it->second;
+        else
+        {
+            if (it == regions.end()) regions[h] = n;    // (a hash collision is simply set up as its own region)
+            region_node[n]          = n;
+            region_list[Nregions]   = n;
+            Nregions++;
+        }
+    }
+    return Nregions;
+}
+
+// Full parameter setup of the region whose first node is n (defaults, model, argument modification, heterogeneity)
+// Local conditions (Model, ISO, remodelling etc) must already be set in p
+void set_region_parameters_native(Cell_parameters *p, Tissue_parameters t, SC_variables sc, Argument_parameters A, int n, double dt)
+{
+    // Set parameters (defaults and model specific) =====\\|
+    // Default modifiers || sets all scale factors to 1 and shifts to 0 so they can be multiplicatively applied by various modifications
+    set_modification_defaults_native(p);		// lib/Initialisation.c
+
+    // Set default parameters (constants etc); can be overwritten by model-specific later
+    set_default_parameters(p);					// lib/Initialisation.c
+
+    // Set model specific parameters
+    p->dt = dt; 	// Set before "set_params" called, which may explicitly set dt, for checking if dt has changed
+
+    // Select local baseline model if multiple models is on
+    // For regions assigned "Model_2", set local Model to the entry held in "Tissue_model_2" (set in Tissue model settings or by argument)
+    // No need to do anything for regions assigned "Model_1" as this is what p->Model already contains
+    if (strcmp(t.Multiple_models, "On") == 0 && strcmp(t.Modeltype_number[sc.geo_linear[n]], "Model_2") == 0) p->Model = t.Tissue_model_2;
+
+    set_model_group_variables(p, A); // Model dependent so needs to be called here (as p->Model may have changed)
+
+    // Set default parameters (constants etc); can be overwritten by model-specific later
+    // Can be set now that local conditions (Model, ISO, Remodelling etc) have be set
+    set_parameters_native(p, p->Model);			// lib/Model.c and dependants (may set dt for model-specific)
+
+    // Set model condition params from arguments where passed; only for those which are set in set_parameters_native() to overwrite with argument value
+    if (A.Celltype_arg 	== true)	p->Celltype 	= A.Celltype;
+    if (A.ISO_model_arg == true)	p->ISO_model	= A.ISO_model;
+    if (A.ACh_model_arg == true)    p->ACh_model 	= A.ACh_model;
+    // End set parameters (defaults and model specific) =//|
+
+    // Set current modification ==========================\\|
+    // lib/Initialisation.c || sets the mod variables (Gx, x_shift/tau_scale etc) from arguments
+    // These are the "DC" modulation variables, controlled by t.Direct_modulation_map_on if set
+    // If map is off, then simply update modifiers with argument values for all tissue; if map is on, do it only within map region
+    if (strcmp(t.Direct_modulation_map_on, "On") == 0)
+    {
+        if (t.Direct_modulation_map[n] > 0.0) assign_modification_from_arguments(p, A); // lib/Initialisation.c || assign only to map area
+    }
+    else assign_modification_from_arguments(p, A);	// lib/Initialisation.c || assign to all nodes
+
+    // Now set local celltype if heterogeneity is on (else all cells will be set to default or argument celltype)
+    // sc.geo_linear[n] = cellnumber at n; celltype_number[cellnumber] = string of celltype defined in Tissue model settings
+    if (strcmp(t.Tissue_type, "heterogeneous") == 0) p->Celltype = t.celltype_number[sc.geo_linear[n]];
+
+    // Now call set heterogneiety and modulation (local celltype and modulation are already set by maps if relevant)
+    // lib/Model.c  -> lib/Model_X.cp; calls functions which set modification variables for het and modulation
+    // Updates the modifier variables (scales, shifts etc) using the defined settings for any/all het and modulation
+    set_heterogeneity_and_modulation_native(p);	// lib/Model.c
+
+    // set expression scale by open rate scale, as both are equivilent in native models
+    p->GCaL *= p->GLTCC_kva1_va2;
+    p->Grel *= p->GRyR_kCO;
+    // end set current modification ======================//|
+}
+// End Parameter regions ========================================================================//|
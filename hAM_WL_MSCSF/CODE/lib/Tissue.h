@@ -94,6 +94,10 @@ void select_stimulus_area_function(Tissue_parameters *t, SC_variables sc, const
 void select_stimulus_area_function_multi_stim(Tissue_parameters *t, SC_variables sc, const char *PATH, const char* Output_dir, int S2_CL, int Nstims);
 void create_stimulus_area(SC_variables sc, const char * Tissue_order, int * stim_area, int x, int xs, int y, int yz, int z, int zs, int *Nstim, const char* Output_dir, const char *ref);
 void create_stimulus_area_sphere(SC_variables sc, const char *Tissue_order, int * stim_area, int x, int xs, int y, int z, int *Nstim, const char* Output_dir, const char *ref);
+int stimulus_site_nodes(const int *area, int N, int *nodes);
+void compile_stimulus_sites(Tissue_parameters *t, int N, bool S2_area_set);
+void clear_stimulus_sites(Tissue_parameters *t);
+void apply_stimulus_site(Tissue_parameters *t, int site, double Istim, double dt);
 
 // Create or read orientation
 void set_orientation(SC_variables *sc, Tissue_parameters t, const char *PATH, const char *Tissue_order);
@@ -118,8 +122,35 @@ void create_phasemap_3D(int * phase, SC_variables sc, const char* Output_dir);
 void set_CV_cells(Cell_parameters p, Tissue_parameters *t);
 void calculate_CV(Tissue_parameters t, Model_variables *var, const char* directory);
 
+// CV maps from activation-time gradients, per beat
+void cv_map_setup(CV_maps *cv, Tissue_parameters t, SC_variables sc, double beat_start, const char *directory, bool restart);
+int cv_map_beat(CV_maps *cv, SC_variables sc, Model_variables *var, double time, int beat, const char *dir, const char *dir2);
+void cv_map_free(CV_maps *cv);
+
 // Conduction success calculation
+int conduction_success_type(Model_variables *var, int N, double S2_ex_time, int *left_ex, int *right_ex);
 void compute_conduction_success(Tissue_parameters t, Model_variables *var, int N, double S2_time, double S2_CL, const char* directory);
 
+// Event-driven measurement engine (activation time and requested APD levels)
+void measurement_engine_setup(Measurement_engine *me, const char *levels, Model_variables *var, int N, const int *full_nodes, int Nfull);
+void measurement_engine_step(Measurement_engine *me, Model_variables *var, int n, double Vm1, double Vm2, double time);
+void measurement_engine_sync(Measurement_engine *me, Model_variables *var);
+void measurement_engine_free(Measurement_engine *me);
+
+// APD, repolarisation time and dispersion maps, per beat
+void apd_map_setup(APD_maps *am, Measurement_engine *me, int N, int interval, const char *directory, bool restart);
+int apd_map_update(APD_maps *am, SC_variables sc, Model_variables *var, const char *dir, const char *dir2);
+void apd_map_beat(APD_maps *am, SC_variables sc, Model_variables *var, double start, double end, int beat, bool last, const char *dir, const char *dir2);
+void apd_map_free(APD_maps *am);
+
+// Parameter regions (nodes with identical local conditions share a parameter set)
+int set_parameter_regions(Tissue_parameters t, SC_variables sc, Cell_parameters *Params, int *region_node, int *region_list);
+void set_region_parameters_native(Cell_parameters *p, Tissue_parameters t, SC_variables sc, Argument_parameters A, int n, double dt);
+
+// Tissue cache (geometry, neighbours, D and laplacian)
+unsigned long long tissue_cache_key(Tissue_parameters t, const char *PATH);
+bool read_tissue_cache(SC_variables *sc, const char *filename, unsigned long long key);
+void write_tissue_cache(SC_variables *sc, const char *filename, unsigned long long key);
+
 #endif
 
@@ -0,0 +1,1177 @@
+// Source code associated with  ===========================  //
+// "Multi-scale cardiac simulation framework" =============  //
+// For simulation of cardiac cellular and tissue dynamics =  //
+// from the spatial cellular to full organ scales. ========  //
+// With implementation of multiple, published cell models =  //
+// as well as novel models developed in my lab. ===========  //
+// ========================================================  //
+// This file: Tissue protocols: batched independent =======  //
+// 1D strands, and runs from an in-memory snapshot ========  //
+// of the tissue (vulnerability window search). ===========  //
+// ========================================================  //
+// GNU 3 LICENSE TEXT =====================================  //
+// COPYRIGHT (C) 2016-2019 MICHAEL A. COLMAN ==============  //
+// THIS PROGRAM IS FREE SOFTWARE: YOU CAN REDISTRIBUTE IT =  //
+// AND/OR MODIFY IT UNDER THE TERMS OF THE GNU GENERAL ====  //
+// PUBLIC LICENSE AS PUBLISHED BY THE FREE SOFTWARE =======  //
+// FOUNDATION, EITHER VERSION 3 OF THE LICENSE, OR (AT YOUR  //
+// OPTION) ANY LATER VERSION. =============================  //
+// THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE=  //
+// USEFUL, BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE =====  //
+// IMPLIED WARRANTY OF MERCHANTABILITY OR FITNESS FOR A ===  //
+// PARTICULAR PURPOSE.  SEE THE GNU GENERAL PUBLIC LICENSE=  //
+// FOR MORE DETAILS. ======================================  //
+// YOU SHOULD HAVE RECEIVED A COPY OF THE GNU GENERAL =====  //
+// PUBLIC LICENSE ALONG WITH THIS PROGRAM.  IF NOT, SEE ===  //
+// <https://www.gnu.org/licenses/>. =======================  //
+// ========================================================  //
+// ADDITIONAL LICENSE TEXT ================================  //
+// THIS SOFTWARE IS PROVIDED OPEN SOURCE AND MAY BE FREELY=  //
+// USED, DISTRIBUTED AND UPDATED, PROVIDED: ===============  //
+//  (i) THE APPROPRIATE WORK(S) IS(ARE) CITED. THIS =======  //
+//      PERTAINS TO THE CITATION OF COLMAN 2019 PLOS COMP =  //
+//      BIOL (FOR THIS IMPLEMTATION) AND ALL WORKS ========  //
+//      ASSOCIATED WITH THE SPECIFIC MODELS AND COMPONENTS=  //
+//      USED IN PARTICULAR SIMULATIONS. IT IS THE USER'S ==  //
+//      RESPONSIBILITY TO ENSURE ALL RELEVANT WORKS ARE ===  //
+//      CITED. PLEASE SEE FULL DOCUMENTATION AND ON-SCREEN=  //
+//      DISCLAIMER OUTPUTS FOR A GUIDE. ===================  //
+//  (ii) ALL OF THIS TEXT IS RETAINED WITHIN OR ASSOCIATED=  //
+//      WITH THE SOURCE CODE AND/OR BINARY FORM OF THE ====  //
+//      SOFTWARE. =========================================  //
+// ========================================================  //
+// ANY INTENDED COMMERCIAL USE OF THIS SOFTWARE MUST BE BY   //
+// EXPRESS PERMISSION OF MICHAEL A COLMAN ONLY. IN NO EVENT  //
+// ARE THE COPYRIGHT HOLDERS LIABLE FOR ANY DIRECT, =======  //
+// INDIRECT INCIDENTAL, SPECIAL, EXEMPLARY OR CONSEQUENTIAL  //
+// DAMAGES ASSOCIATED WITH USE OF THIS SOFTWARE ===========  //
+// ========================================================  //
+// THIS SOFTWARE CONTAINS IMPLEMENTATIONS OF MODELS AND ===  //
+// COMPONENTS WHICH I (MICHAEL COLMAN) DID NOT DEVELOP.====  //
+// ALL OF THESE COMPONENTS HAVE BEEN CODED FROM PROVIDED ==  //
+// SOURCE CODE OR INFORMATION IN THE PUBLICATIONS. ========  //
+// I CLAIM NO RIGHTS OR INTELLECTUAL PROPERTY OWNERSHIP ===  //
+// FOR THESE MODELS AND COMPONENTS, OTHER THAN THEIR ======  //
+// SPECIFIC IMPLEMENTATION IN THIS CODE PACKAGE. FURTHER TO  //
+// THE ABOVE STATEMENT, ANY INDTENDED COMMERCIAL USE OF ===  //
+// THOSE COMPONENTS MUST BE BY EXPRESS PERMISSION OF THE ==  //
+// ORIGINAL COPYRIGHT HOLDERS. ============================  //
+// WHERE IMPLEMENTED FROM PROVIDED CODE, ANY DISCLAIMERS ==  //
+// PRESENT IN THE ORIGINAL CODE HAVE BEEN RETAINED IN THE =  //
+// RELEVANT FILE. =========================================  //
+// ========================================================  //
+// Contact: m.a.colman@leeds.ac.uk ========================  //
+// For updates, corrections etc, please check: ============  //
+// 1. http://physicsoftheheart.com/ =======================  //
+// 2. https://github.com/michaelcolman ====================  //
+// ========================================================  //
+
+#include "Tissue_protocols.h"
+#include "Tissue.h"
+#include "Structs.h"
+#include "Model.h"
+#include "Arguments.h"
+#include "Initialisation.h"
+#include "Spatial_coupling.h"
+#include "Outputs.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <omp.h>
+
+// Function list ================================================================================\\|
+//	Strand batch
+//	    strand_batch_setup()
+//	    strand_batch_tissue()
+//	    strand_batch_conditions()
+//	    strand_batch_stimulus()
+//	    strand_batch_compute_Istim()
+//	    strand_batch_apply_S2()
+//	    strand_batch_full_conduction()
+//	    strand_batch_results()
+//	    strand_batch_free()
+//	
+//	Tissue snapshot and step
+//	    tissue_snapshot_take()
+//	    tissue_snapshot_free()
+//	    step_tissue_native()
+//	
+//	Vulnerability window search
+//	    vw_evaluate()
+//	    run_vulnerability_window_search()
+//	
+//	Branch scenarios
+//	    branch_scenarios_setup()
+//	    branch_parameters()
+//	    branch_run()
+//	    run_branch_scenarios()
+//	    branch_scenarios_free()
+//	
+//	Modulation events
+//	    modulation_events_setup()
+//	    apply_modulation_event()
+//	    modulation_events_free()
+//	
+//	Pacing protocol
+//	    pacing_protocol_setup()
+//	    pacing_protocol_seek()
+//	    pacing_protocol_step()
+//	    pacing_protocol_free()
+// End Function list ============================================================================//|
+
+// Strand batch =================================================================================\\|
+// Many small 1D strands are solved as the rows of one domain, with y neighbours removed so that they are uncoupled;
+// each row is then identical to a 1D run. S1 and tissue settings are common; each strand's line of the strand file
+// sets its own S2 (S2, NS2, S2_x_loc, S2_x_size) and conditions (Model, ISO, remodelling, current scaling etc)
+
+// Reads the strand file and sets each strand's arguments and S2 timing; the S2 train ends at the latest strand S2
+void strand_batch_setup(Strand_batch *sb, Argument_parameters *Argin, Simulation_parameters *Sim, const char *directory)
+{
+	std::vector<std::string> lines;
+	sb->N			= read_batch_file(Argin->Strand_file, &lines);	// lib/Arguments.c
+	if (sb->N == 0)
+	{
+		printf("ERROR: Strand file \"%s\" contains no strands\n", Argin->Strand_file);
+		exit(1);
+	}
+	sb->line		= new char*[sb->N];
+	sb->buffer		= new char*[sb->N];
+	sb->A			= new Argument_parameters[sb->N];
+	sb->conditions	= new Cell_parameters[sb->N];
+	sb->S2_CL		= new int[sb->N];
+	sb->S2_x_loc	= new int[sb->N];
+	sb->S2_time		= new double[sb->N];
+	sb->stim		= new Model_variables[sb->N];
+
+	char filename[500];
+	sprintf(filename, "%s/Strand_arguments.dat", directory);
+	FILE *log = fopen(filename, "w");
+	double S2_time_max = 0;
+	int S2_CL_max = 0;
+	for (int s = 0; s < sb->N; s++)
+	{
+		sb->line[s]		= new char[lines[s].size()+1];
+		sb->buffer[s]	= new char[lines[s].size()+1];
+		strcpy(sb->line[s], lines[s].c_str());
+		fprintf(log, "%d ", s);
+		set_batch_job_arguments(&sb->A[s], Argin, sb->line[s], sb->buffer[s], log, "Tissue_native");	// lib/Arguments.c
+		fprintf(log, "\n");
+
+		Simulation_parameters Sim_s;
+		set_simulation_defaults(&Sim_s, Sim->dt);				// lib/Initialisation.c
+		set_simulation_settings(&Sim_s, sb->A[s], "native");	// lib/Initialisation.c
+		sb->S2_CL[s]	= Sim_s.S2_CL;
+		sb->S2_time[s]	= Sim_s.S2_time;
+		if (Sim_s.S2_CL > S2_CL_max) S2_CL_max = Sim_s.S2_CL;
+		if (Sim_s.S2_time > S2_time_max) S2_time_max = Sim_s.S2_time;
+	}
+	fclose(log);
+
+	// Common S2 settings || as set_simulation_settings, for the latest strand
+	if (S2_CL_max > 0)
+	{
+		Sim->S2_CL		= S2_CL_max;
+		Sim->S2_time	= S2_time_max;
+		if (Argin->Total_time_arg == false)
+		{
+			Sim->Total_time						= Sim->S2_time + 2000 - 5;
+			Sim->Spatial_output_end_time		= Sim->Total_time;
+		}
+	}
+	printf(">%d strands read from %s\n", sb->N, Argin->Strand_file);
+}
+
+// One row per strand
+void strand_batch_tissue(Strand_batch *sb, Tissue_parameters *t)
+{
+	if (strcmp(t->Tissue_order, "1D") != 0 || strcmp(t->Multi_stim, "On") == 0)
+	{
+		printf("ERROR: Strand_file requires Tissue_order 1D and Multi_stim Off\n");
+		exit(1);
+	}
+	t->NY		= sb->N;
+	t->NZ		= 1;
+	t->Nstrands	= sb->N;
+}
+
+// Model conditions of each strand || as set_model_conditions() for the tissue, keeping the tissue model unless the strand sets Model
+void strand_batch_conditions(Strand_batch *sb, Cell_parameters Params_global)
+{
+	for (int s = 0; s < sb->N; s++)
+	{
+		set_model_conditions(&sb->conditions[s], sb->A[s]);	// lib/Initialisation.c
+		if (sb->A[s].Model_arg == false) sb->conditions[s].Model = Params_global.Model;
+	}
+}
+
+// Removes y neighbours (so strands are uncoupled), then sets the S2 area and stimulus of each strand
+void strand_batch_stimulus(Strand_batch *sb, Tissue_parameters *t, SC_variables *sc, Cell_parameters p, Simulation_parameters Sim)
+{
+	for (int n = 0; n < sc->N; n++)
+	{
+		sc->yp[n] = sc->ym[n] = n;
+		sc->xp_yp[n] = sc->xp_ym[n] = sc->xm_yp[n] = sc->xm_ym[n] = n;
+		sc->yp_zp[n] = sc->yp_zm[n] = sc->ym_zp[n] = sc->ym_zm[n] = n;
+	}
+
+	t->Nstim_S2 = 0;
+	for (int s = 0; s < sb->N; s++)
+	{
+		sb->S2_x_loc[s]	= (sb->A[s].S2_x_loc_arg == true) ? sb->A[s].S2_x_loc : t->S2_x_loc;
+		stimulus_setup(p, &sb->stim[s], Sim.dt, Sim.BCL, sb->S2_CL[s], Sim.Paced_time);	// lib/Model.c
+	}
+	for (int n = 0; n < sc->N; n++)
+	{
+		int s		= sc->y_index[n];
+		int xs		= (sb->A[s].S2_x_size_arg == true) ? sb->A[s].S2_x_size : t->S2_x_size;
+		t->S2_stim_area[n] = (sb->S2_CL[s] != 0 && sc->x_index[n] >= sb->S2_x_loc[s] - xs && sc->x_index[n] <= sb->S2_x_loc[s] + xs) ? 1 : 0;
+		t->Nstim_S2 += t->S2_stim_area[n];
+	}
+}
+
+// S2 current of each strand for this step || as compute_Istim() with the strand's S2 timing
+void strand_batch_compute_Istim(Strand_batch *sb, Cell_parameters p, Simulation_parameters Sim, double sim_time, int iteration_counter)
+{
+	for (int s = 0; s < sb->N; s++) compute_Istim(p, &sb->stim[s], Sim.Paced_time, sb->S2_time[s], sim_time, iteration_counter);	// lib/Model.c
+}
+
+// S2 current of each strand on its S2 site nodes || as apply_stimulus_site()
+void strand_batch_apply_S2(Strand_batch *sb, Tissue_parameters *t, SC_variables sc)
+{
+	for (int i = t->stim_site_start[1]; i < t->stim_site_start[2]; i++)
+	{
+		int n = t->stim_site_nodes[i];
+		double Istim_S2 = sb->stim[sc.y_index[n]].Istim_S2;
+		if (Istim_S2 == 0.0) continue;
+		t->stim_current[n]	+= Istim_S2*t->stim_site_weight[i];
+		t->stim_current_set	= true;
+	}
+}
+
+// True once every strand with an S2 has conducted in both directions
+bool strand_batch_full_conduction(Strand_batch *sb, Model_variables *var, int NX)
+{
+	int left_ex, right_ex;
+	for (int s = 0; s < sb->N; s++)
+	{
+		if (sb->S2_CL[s] == 0) continue;
+		if (conduction_success_type(&var[s*NX], NX, sb->S2_time[s]-5, &left_ex, &right_ex) != 2) return false;	// lib/Tissue.cpp
+	}
+	return true;
+}
+
+// Conduction success (as compute_conduction_success) and final beat properties of the centre node of each strand
+void strand_batch_results(Strand_batch *sb, Model_variables *var, int NX, const char *directory, const char *results_directory)
+{
+	char filename[500];
+	sprintf(filename, "%s/1D_conduction_success_log.dat", directory);
+	FILE *cs = fopen(filename, "a");
+	sprintf(filename, "%s/Strand_results.dat", results_directory);
+	FILE *out = fopen(filename, "w");
+	fprintf(out, "# strand S2_x_loc S2 left right type APD90 dvdt_max Vamp t_ex | strand arguments\n");
+	for (int s = 0; s < sb->N; s++)
+	{
+		Model_variables *v	= &var[s*NX];
+		int left_ex = 0, right_ex = 0, type = 0;
+		if (sb->S2_CL[s] != 0)
+		{
+			type = conduction_success_type(v, NX, sb->S2_time[s]-5, &left_ex, &right_ex);	// lib/Tissue.cpp
+			fprintf(cs, "%d %f %d %d %d\n", sb->S2_x_loc[s], (double)sb->S2_CL[s], left_ex, right_ex, type);
+		}
+		Model_variables c	= v[NX/2];
+		fprintf(out, "%d %d %d %d %d %d %f %f %f %f | %s\n", s, sb->S2_x_loc[s], sb->S2_CL[s], left_ex, right_ex, type, c.APD_p[8], c.dvdt_max, c.Vamp, c.t_ex, sb->line[s]);
+	}
+	fclose(cs);
+	fclose(out);
+	printf("Results of %d strands written to %s\n", sb->N, filename);
+}
+
+void strand_batch_free(Strand_batch *sb)
+{
+	for (int s = 0; s < sb->N; s++)
+	{
+		delete [] sb->line[s];
+		delete [] sb->buffer[s];
+	}
+	delete [] sb->line;
+	delete [] sb->buffer;
+	delete [] sb->A;
+	delete [] sb->conditions;
+	delete [] sb->S2_CL;
+	delete [] sb->S2_x_loc;
+	delete [] sb->S2_time;
+	delete [] sb->stim;
+}
+// End Strand batch =============================================================================//|
+
+// Tissue snapshot and step =====================================================================\\|
+void tissue_snapshot_take(Tissue_snapshot *s, State_variables *State, Model_variables *Variables, double *Vm, int N, double sim_time, int iteration_counter)
+{
+	s->N					= N;
+	s->State				= new State_variables[N];
+	s->Variables			= new Model_variables[N];
+	s->Vm					= new double[N];
+	memcpy(s->State, State, N*sizeof(State_variables));
+	memcpy(s->Variables, Variables, N*sizeof(Model_variables));
+	memcpy(s->Vm, Vm, N*sizeof(double));
+	s->sim_time				= sim_time;
+	s->iteration_counter	= iteration_counter;
+}
+
+void tissue_snapshot_free(Tissue_snapshot *s)
+{
+	delete [] s->State;
+	delete [] s->Variables;
+	delete [] s->Vm;
+}
+
+// One time step of the whole tissue || as the time loop of Tissue_native_main.cc (single stimulus map)
+// sc->diff must be owned by the caller when steps of different tissues run concurrently
+// Node loops are parallel when called serially; within a parallel region (branches) they run on the calling thread
+// param_index maps each node to its parameter set (NULL for one set per node)
+// Stimulus maps are dense here (not the shared per-node currents of the stimulus sites), as branches step concurrently
+void step_tissue_native(SC_variables *sc, Tissue_parameters *t, Cell_parameters *Params, int *param_index, State_variables *State, Model_variables *Variables, double *Vm, int *S2_stim_area, double dt, double sim_time, double Istim, double Istim_S2)
+{
+	#pragma omp parallel for if(!omp_in_parallel())
+	for (int n = 0; n < sc->N; n++)
+	{
+		calc_diff_from_lap(sc, Vm, n);														// lib/Spatial_coupling.cpp
+		compute_model_native(Params[(param_index == NULL) ? n : param_index[n]], &Variables[n], &State[n], Vm[n], dt);				// lib/Model.c
+		State[n].Vm	= State[n].Vm + dt*(-(Variables[n].Itot + Istim*t->stim_area[n] + Istim_S2*S2_stim_area[n]));
+		State[n].Vm	= State[n].Vm + dt*sc->diff[n];
+		determine_excitation_state(&Variables[n], Vm[n], sim_time);						// lib/Model.c
+		calculate_measurement_properties(&Variables[n], Vm[n], State[n].Vm, sim_time, dt, -70, State[n].Cai, State[n].CanSR);	// lib/Model.c
+	}
+	#pragma omp parallel for if(!omp_in_parallel())
+	for (int n = 0; n < sc->N; n++) Vm[n] = State[n].Vm;
+}
+// End Tissue snapshot and step =================================================================//|
+
+// Vulnerability window search ==================================================================\\|
+// 1D only. The strand is paced once to just before the earliest S2 and snapshot; every S2 (interval and location)
+// is run from a copy of the snapshot until its conduction outcome (as compute_conduction_success()) is known.
+// A coarse scan over the S2 range is refined by bisection on each change of outcome to the requested precision
+
+// Runs one S2 from the snapshot; returns conduction type (0 none, 1 unidirectional, 2 full) and sets left/right
+// S2 onset is at the same step as compute_Istim() for an S2 of this interval, so integer intervals match separate runs
+int vw_evaluate(Tissue_snapshot *snap, SC_variables sc, Tissue_parameters *t, Cell_parameters *Params, Simulation_parameters Sim, int *S2_stim_area, double S2, double window, int *left, int *right)
+{
+	int N						= snap->N;
+	State_variables *State		= new State_variables[N];
+	Model_variables *Variables	= new Model_variables[N];
+	double *Vm					= new double[N];
+	memcpy(State, snap->State, N*sizeof(State_variables));
+	memcpy(Variables, snap->Variables, N*sizeof(Model_variables));
+	memcpy(Vm, snap->Vm, N*sizeof(double));
+	sc.diff						= new double[N];	// own spatial differential; all other SC arrays are read only
+
+	int    steps_per_ms			= (int)(1/Sim.dt);
+	int    S2_on				= Variables[0].Paced_time_int - 5 + (int)round(S2*steps_per_ms);
+	int    S2_off				= S2_on + Variables[0].stimduration_int;
+	double S2_ex_time			= Sim.Paced_time - 5 + S2;	// excitation after this time is due to S2 (as compute_conduction_success)
+	double end_time				= S2_ex_time + window;
+
+	double sim_time				= snap->sim_time;
+	int iteration_counter		= snap->iteration_counter;
+	int type					= 0;
+	while (sim_time <= end_time)
+	{
+		compute_Istim(Params[0], &Variables[0], Sim.Paced_time, Sim.S2_time, sim_time, iteration_counter);	// lib/Model.c || S1 only
+		double Istim_S2 = (iteration_counter >= S2_on && iteration_counter < S2_off) ? Params[0].stimmag : 0.0;
+		if (iteration_counter == S2_on) Variables[0].ex_switch = 0;
+		step_tissue_native(&sc, t, Params, NULL, State, Variables, Vm, S2_stim_area, Sim.dt, sim_time, Variables[0].Istim, Istim_S2);
+		iteration_counter++;
+		sim_time += Sim.dt;
+
+		// Full conduction cannot be undone; stop as soon as both ends have been excited
+		type = conduction_success_type(Variables, N, S2_ex_time, left, right);	// lib/Tissue.cpp
+		if (type == 2) break;
+	}
+
+	delete [] State;
+	delete [] Variables;
+	delete [] Vm;
+	delete [] sc.diff;
+	return type;
+}
+
+void run_vulnerability_window_search(Argument_parameters A, Simulation_parameters Sim, Tissue_parameters Tissue, SC_variables SC, Cell_parameters *Params, State_variables *State, Model_variables *Variables, double *Vm, const char *directory)
+{
+	if (strcmp(Tissue.Tissue_order, "1D") != 0 || strcmp(Tissue.Multi_stim, "On") == 0 || Sim.NBeats < 1)
+	{
+		printf("ERROR: Vulnerability_window search requires Tissue_order 1D, Multi_stim Off and at least one S1 beat\n");
+		exit(1);
+	}
+
+	// Search settings
+	double S2_min		= (A.VW_S2_range_arg == true) ? A.VW_S2_min : 150;
+	double S2_max		= (A.VW_S2_range_arg == true) ? A.VW_S2_max : 200;
+	double S2_step		= (A.VW_S2_step_arg == true) ? A.VW_S2_step : 5;
+	double precision	= (A.VW_precision_arg == true) ? A.VW_precision : 0.1;
+	if (precision < Sim.dt) precision = Sim.dt;
+	std::vector<int> locations;
+	if (A.VW_S2_x_locs_arg == true)
+	{
+		char list[1000];
+		strncpy(list, A.VW_S2_x_locs, 999);
+		list[999] = 0;
+		char *save;
+		for (char *c = strtok_r(list, ",", &save); c != NULL; c = strtok_r(NULL, ",", &save)) locations.push_back(atoi(c));
+	}
+	else locations.push_back(Tissue.S2_x_loc);
+	int Nloc = (int)locations.size();
+
+	// S2 stimulus area for each location
+	std::vector<int*> S2_area(Nloc);
+	for (int l = 0; l < Nloc; l++)
+	{
+		char ref[100];
+		sprintf(ref, "S2_loc_%d", locations[l]);
+		S2_area[l] = new int[SC.N];
+		int Nstim_S2;
+		create_stimulus_area(SC, Tissue.Tissue_order, S2_area[l], locations[l], Tissue.S2_x_size, Tissue.S2_y_loc, Tissue.S2_y_size, Tissue.S2_z_loc, Tissue.S2_z_size, &Nstim_S2, directory, ref); // lib/Tissue.cpp
+	}
+
+	// Pace S1 to the snapshot: the step of the earliest S2 onset
+	stimulus_setup(Params[0], &Variables[0], Sim.dt, Sim.BCL, 0, Sim.Paced_time);	// lib/Model.c || S1 only; S2 is applied per branch
+	int steps_per_ms	= (int)(1/Sim.dt);
+	int snapshot_step	= Variables[0].Paced_time_int - 5 + (int)round(S2_min*steps_per_ms);
+	double sim_time		= 0;
+	int iteration_counter = 0;
+	printf("Pacing to vulnerability window snapshot at %.2f ms\n", snapshot_step*Sim.dt);
+	while (iteration_counter < snapshot_step)
+	{
+		compute_Istim(Params[0], &Variables[0], Sim.Paced_time, Sim.S2_time, sim_time, iteration_counter);	// lib/Model.c
+		step_tissue_native(&SC, &Tissue, Params, NULL, State, Variables, Vm, S2_area[0], Sim.dt, sim_time, Variables[0].Istim, 0.0);
+		iteration_counter++;
+		sim_time += Sim.dt;
+		if (iteration_counter%(500*steps_per_ms) == 0) printf("Time = %.0fms\n", sim_time);
+	}
+	Tissue_snapshot snap;
+	tissue_snapshot_take(&snap, State, Variables, Vm, SC.N, sim_time, iteration_counter);
+
+	// Outcome window: twice the S1 conduction time over the strand, plus 100 ms
+	double t_first = 1e9, t_last = -1e9;
+	for (int n = 0; n < SC.N; n++)
+	{
+		if (Variables[n].t_ex < t_first) t_first = Variables[n].t_ex;
+		if (Variables[n].t_ex > t_last) t_last = Variables[n].t_ex;
+	}
+	double window = 2*(t_last - t_first) + 100;
+
+	// Evaluated points || location index, S2, left, right, type
+	struct VW_point { int l; double S2; int left, right, type; };
+	std::vector<VW_point> points;
+
+	// Coarse scan (all locations and intervals in parallel)
+	int Ncoarse = (int)floor((S2_max - S2_min)/S2_step + 1e-9) + 1;
+	for (int l = 0; l < Nloc; l++) for (int i = 0; i < Ncoarse; i++) points.push_back({l, S2_max - i*S2_step, 0, 0, 0});
+	#pragma omp parallel for schedule(dynamic)
+	for (int p = 0; p < (int)points.size(); p++) points[p].type = vw_evaluate(&snap, SC, &Tissue, Params, Sim, S2_area[points[p].l], points[p].S2, window, &points[p].left, &points[p].right);
+	printf("Coarse scan: %d locations x %d intervals\n", Nloc, Ncoarse);
+
+	// Bisection on every change of outcome between neighbouring intervals; all open brackets are refined in parallel
+	struct VW_bracket { int l; double lo, hi; int type_lo, type_hi; };
+	std::vector<VW_bracket> brackets;
+	for (int l = 0; l < Nloc; l++) for (int i = 0; i < Ncoarse-1; i++)
+	{
+		VW_point hi = points[l*Ncoarse + i], lo = points[l*Ncoarse + i+1];
+		if (hi.type != lo.type) brackets.push_back({l, lo.S2, hi.S2, lo.type, hi.type});
+	}
+	while (brackets.size() > 0)
+	{
+		int Nb = (int)brackets.size();
+		std::vector<VW_point> mid(Nb);
+		#pragma omp parallel for schedule(dynamic)
+		for (int b = 0; b < Nb; b++)
+		{
+			mid[b].l	= brackets[b].l;
+			mid[b].S2	= round(0.5*(brackets[b].lo + brackets[b].hi)*steps_per_ms)/steps_per_ms;
+			mid[b].type	= vw_evaluate(&snap, SC, &Tissue, Params, Sim, S2_area[mid[b].l], mid[b].S2, window, &mid[b].left, &mid[b].right);
+		}
+		std::vector<VW_bracket> next;
+		for (int b = 0; b < Nb; b++)
+		{
+			VW_bracket k = brackets[b];
+			points.push_back(mid[b]);
+			if (mid[b].type != k.type_lo) next.push_back({k.l, k.lo, mid[b].S2, k.type_lo, mid[b].type});
+			if (mid[b].type != k.type_hi) next.push_back({k.l, mid[b].S2, k.hi, mid[b].type, k.type_hi});
+		}
+		brackets.clear();
+		for (size_t b = 0; b < next.size(); b++) if (next[b].hi - next[b].lo > precision + 1e-9) brackets.push_back(next[b]);
+	}
+	tissue_snapshot_free(&snap);
+
+	// All evaluations to the conduction success log (as compute_conduction_success), by location and decreasing S2
+	std::sort(points.begin(), points.end(), [](const VW_point &a, const VW_point &b) { return (a.l != b.l) ? a.l < b.l : a.S2 > b.S2; });
+	char filename[500];
+	sprintf(filename, "%s/1D_conduction_success_log.dat", directory);
+	FILE *out = fopen(filename, "a");
+	for (size_t p = 0; p < points.size(); p++) fprintf(out, "%d %f %d %d %d\n", locations[points[p].l], points[p].S2, points[p].left, points[p].right, points[p].type);
+	fclose(out);
+
+	// Windows: runs of unidirectional conduction, bounded by the evaluated intervals
+	sprintf(filename, "%s/Vulnerability_window_log.dat", directory);
+	out = fopen(filename, "a");    // Note: Appended, not overwritten
+	for (int l = 0; l < Nloc; l++)
+	{
+		int Nwindows = 0;
+		for (size_t p = 0; p < points.size(); p++)
+		{
+			if (points[p].l != l || points[p].type != 1) continue;
+			if (p > 0 && points[p-1].l == l && points[p-1].type == 1) continue; // not the start (largest S2) of a run
+			size_t q = p;
+			while (q+1 < points.size() && points[q+1].l == l && points[q+1].type == 1) q++;
+			printf("S2 loc = %d\t vulnerability window = %.2f - %.2f ms (width %.2f ms, precision %.2f ms)\n", locations[l], points[q].S2, points[p].S2, points[p].S2 - points[q].S2, precision);
+			fprintf(out, "%d %f %f %f %f\n", locations[l], points[q].S2, points[p].S2, points[p].S2 - points[q].S2, precision);
+			Nwindows++;
+		}
+		if (Nwindows == 0) printf("S2 loc = %d\t no unidirectional conduction for S2 in %.2f - %.2f ms\n", locations[l], S2_min, S2_max);
+	}
+	fclose(out);
+	printf("Evaluated %d S2 branches from one snapshot\n", (int)points.size());
+
+	for (int l = 0; l < Nloc; l++) delete [] S2_area[l];
+}
+// End Vulnerability window search ==============================================================//|
+
+// Branch scenarios =============================================================================\\|
+// What-if scenarios: the simulation runs as normal (the trunk) and the tissue is snapshot at Branch_time; each line of
+// the branch file is then a scenario (ISO, ACh, remodelling, current scaling etc) advanced from a copy of the snapshot
+// to the end of the simulation. Geometry, neighbours, diffusion and laplacian arrays and maps are shared by all branches;
+// each has its own state and its parameters once per parameter region. Branches are spread over the cores when there
+// are at least as many as threads, else run in turn with the node loops parallel
+
+// Reads the branch file, sets each branch's arguments and creates the branch output directories
+void branch_scenarios_setup(Branch_scenarios *bs, Argument_parameters *Argin, Simulation_parameters Sim, Tissue_parameters Tissue, int Nstrands, double sim_time_start, const char *directory, const char *results_directory)
+{
+	bs->time	= (Argin->Branch_time_arg == true) ? Argin->Branch_time : 0;
+	bs->taken	= false;
+	if (strcmp(Tissue.Multi_stim, "On") == 0 || Nstrands > 0)
+	{
+		printf("ERROR: Branch_file cannot be combined with Multi_stim or Strand_file\n");
+		exit(1);
+	}
+	if (bs->time >= Sim.Total_time || bs->time < sim_time_start)
+	{
+		printf("ERROR: Branch_time (%.0f ms) must be within the simulation (%.0f - %d ms)\n", bs->time, sim_time_start, Sim.Total_time);
+		exit(1);
+	}
+
+	std::vector<std::string> lines;
+	bs->N		= read_batch_file(Argin->Branch_file, &lines);	// lib/Arguments.c
+	if (bs->N == 0)
+	{
+		printf("ERROR: Branch file \"%s\" contains no branches\n", Argin->Branch_file);
+		exit(1);
+	}
+	bs->line	= new char*[bs->N];
+	bs->buffer	= new char*[bs->N];
+	bs->A		= new Argument_parameters[bs->N];
+
+	char filename[1000];
+	sprintf(filename, "%s/Branch_arguments.dat", directory);
+	FILE *log = fopen(filename, "w");
+	for (int b = 0; b < bs->N; b++)
+	{
+		bs->line[b]		= new char[lines[b].size()+1];
+		bs->buffer[b]	= new char[lines[b].size()+1];
+		strcpy(bs->line[b], lines[b].c_str());
+		fprintf(log, "%d ", b);
+		set_batch_job_arguments(&bs->A[b], Argin, bs->line[b], bs->buffer[b], log, "Tissue_native");	// lib/Arguments.c
+		fprintf(log, "\n");
+
+		sprintf(filename, "mkdir -p %s/Branch_%d", results_directory, b);
+		system(filename);
+	}
+	fclose(log);
+	printf(">%d branches read from %s; branch point at %.0f ms\n", bs->N, Argin->Branch_file, bs->time);
+}
+
+// Parameters of one branch || as the tissue setup, with the branch's conditions on the same maps; the Model cannot change
+// Sets local[] and the regions of the branch; the full setup is in local[region_list[r]]. Returns the number of regions
+int branch_parameters(Argument_parameters A, Tissue_parameters Tissue, SC_variables SC, Cell_parameters *Params, Cell_parameters Params_global, double dt, Cell_parameters *local, int *region_node, int *region_list)
+{
+	Cell_parameters conditions;
+	set_model_conditions(&conditions, A);	// lib/Initialisation.c
+	if (A.Model_arg == true && strcmp(A.Model, Params_global.Model) != 0)
+	{
+		printf("ERROR: Model cannot be changed in a branch (\"%s\")\n", A.Model);
+		exit(1);
+	}
+	conditions.Model = Params_global.Model;
+
+	#pragma omp parallel for
+	for (int n = 0; n < SC.N; n++)
+	{
+		set_local_model_conditions(conditions, &local[n]);	// lib/Initialisation.c
+		if (strcmp(Tissue.ISO_map_on, "On") == 0)	local[n].ISO				*= Tissue.ISO_map[n];
+		if (strcmp(Tissue.remod_map_on, "On") == 0)	local[n].Remodelling_prop	*= Tissue.remod_map[n];
+		if (strcmp(Tissue.ACh_map_on, "On") == 0)	local[n].ACh				*= Tissue.ACh_map[n];
+		local[n].spatial_gradient		= Params[n].spatial_gradient;
+		local[n].spatial_gradient_prop	= Params[n].spatial_gradient_prop;
+	}
+	int Nregions = set_parameter_regions(Tissue, SC, local, region_node, region_list);	// lib/Tissue.cpp
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int r = 0; r < Nregions; r++) set_region_parameters_native(&local[region_list[r]], Tissue, SC, A, region_list[r], dt);	// lib/Tissue.cpp
+	for (int r = 0; r < Nregions; r++)
+	{
+		if (local[region_list[r]].dt != dt)
+		{
+			printf("ERROR: branch parameters set dt = %f, but the simulation uses dt = %f\n", local[region_list[r]].dt, dt);
+			exit(1);
+		}
+	}
+	return Nregions;
+}
+
+// Advances one branch from the snapshot to the end of the simulation (or, with Early_stop, until its outcome is determined)
+// Returns the time quiescence was detected (as Early_stop; -1 if never); Vm linescan and activation to results_directory/Branch_<b>
+double branch_run(Tissue_snapshot *snap, int b, SC_variables sc, Tissue_parameters *t, Cell_parameters *P, int *index, Cell_parameters stim, Simulation_parameters Sim, double early_stop_start, const char *results_directory, double *end_time, double *active_fraction, int *type)
+{
+	int N						= snap->N;
+	State_variables *State		= new State_variables[N];
+	Model_variables *Variables	= new Model_variables[N];
+	double *Vm					= new double[N];
+	memcpy(State, snap->State, N*sizeof(State_variables));
+	memcpy(Variables, snap->Variables, N*sizeof(Model_variables));
+	memcpy(Vm, snap->Vm, N*sizeof(double));
+	sc.diff						= new double[N];	// own spatial differential; all other SC arrays are read only
+
+	char dir2[100], filename[1000];
+	sprintf(dir2, "Branch_%d", b);
+	sprintf(filename, "%s/%s/Vm_linescan_x.dat", results_directory, dir2);
+	std::ofstream out_ls(filename);
+	bool linescan			= (strcmp(t->Tissue_order, "geo") != 0);
+	bool early_stop_on		= (strcmp(Sim.Early_stop, "On") == 0);
+	bool conduction_1D		= (strcmp(t->Tissue_order, "1D") == 0 && Sim.S2_CL != 0);
+	int  steps_per_ms		= (int)(1/Sim.dt);
+	int  quiescent_time		= 0;	// ms
+	double quiescent_at		= -1;
+	int  left_ex, right_ex;
+
+	double sim_time;
+	int iteration_counter	= snap->iteration_counter;
+	for (sim_time = snap->sim_time; sim_time <= (float)Sim.Total_time; sim_time += Sim.dt)
+	{
+		compute_Istim(stim, &Variables[0], Sim.Paced_time, Sim.S2_time, sim_time, iteration_counter);	// lib/Model.c
+		step_tissue_native(&sc, t, P, index, State, Variables, Vm, t->S2_stim_area, Sim.dt, sim_time, Variables[0].Istim, Variables[0].Istim_S2);
+		if (linescan == true && iteration_counter%steps_per_ms == 0) linescan_out_X(out_ls, sc, Vm, int(float(sc.NY/2)), int(float(sc.NZ/2)));	// lib/Outputs.cpp
+		iteration_counter++;
+
+		// Outcome monitor || as the Early_stop check of the trunk
+		if (sim_time > early_stop_start && iteration_counter%steps_per_ms == 0)
+		{
+			int Nactive = 0;
+			#pragma omp parallel for reduction(+:Nactive) if(!omp_in_parallel())
+			for (int n = 0; n < N; n++) if (Vm[n] > Sim.Early_stop_Vm) Nactive++;
+			if (Nactive <= Sim.Early_stop_active*N) quiescent_time++;
+			else quiescent_time = 0;
+			if (quiescent_time >= Sim.Early_stop_quiescent && quiescent_at < 0) quiescent_at = sim_time;
+
+			if (early_stop_on == true && (quiescent_at >= 0 || (conduction_1D == true && conduction_success_type(Variables, N, Sim.S2_time-5, &left_ex, &right_ex) == 2))) break;
+		}
+	}
+	out_ls.close();
+
+	*end_time			= sim_time;
+	int Nactive			= 0;
+	for (int n = 0; n < N; n++) if (Vm[n] > Sim.Early_stop_Vm) Nactive++;
+	*active_fraction	= (double)Nactive/N;
+	*type				= (conduction_1D == true) ? conduction_success_type(Variables, N, Sim.S2_time-5, &left_ex, &right_ex) : -1;	// lib/Tissue.cpp
+	Output_activation(results_directory, dir2, Variables, sc);	// lib/Outputs.cpp
+
+	delete [] State;
+	delete [] Variables;
+	delete [] Vm;
+	delete [] sc.diff;
+	return quiescent_at;
+}
+
+void run_branch_scenarios(Branch_scenarios *bs, Simulation_parameters Sim, Tissue_parameters Tissue, SC_variables SC, Cell_parameters *Params, Cell_parameters Params_global, const char *results_directory)
+{
+	if (bs->taken == false)
+	{
+		printf("Simulation ended before Branch_time = %.0f ms; no branches run\n", bs->time);
+		return;
+	}
+
+	// Parameters of each branch, once per region
+	std::vector<Cell_parameters*> P(bs->N);
+	std::vector<int*> index(bs->N);
+	Cell_parameters *local	= new Cell_parameters[SC.N];
+	int *region_node		= new int[SC.N];
+	int *region_list		= new int[SC.N];
+	int *region_pos			= new int[SC.N];
+	for (int b = 0; b < bs->N; b++)
+	{
+		int Nregions	= branch_parameters(bs->A[b], Tissue, SC, Params, Params_global, Sim.dt, local, region_node, region_list);
+		P[b]			= new Cell_parameters[Nregions];
+		index[b]		= new int[SC.N];
+		for (int r = 0; r < Nregions; r++)
+		{
+			P[b][r]						= local[region_list[r]];
+			region_pos[region_list[r]]	= r;
+		}
+		for (int n = 0; n < SC.N; n++) index[b][n] = region_pos[region_node[n]];
+	}
+	delete [] local;
+	delete [] region_node;
+	delete [] region_list;
+	delete [] region_pos;
+
+	// Run the branches
+	double early_stop_start = ((Sim.S2_CL != 0 && Sim.S2_time > Sim.Paced_time) ? Sim.S2_time : Sim.Paced_time) + Params[0].stimduration;
+	std::vector<double> quiescent_at(bs->N), end_time(bs->N), active_fraction(bs->N);
+	std::vector<int> type(bs->N);
+	printf("Running %d branches from time = %.0fms\n", bs->N, bs->snap.sim_time);
+	#pragma omp parallel for schedule(dynamic) if(bs->N >= omp_get_max_threads())
+	for (int b = 0; b < bs->N; b++)
+	{
+		quiescent_at[b] = branch_run(&bs->snap, b, SC, &Tissue, P[b], index[b], Params[0], Sim, early_stop_start, results_directory, &end_time[b], &active_fraction[b], &type[b]);
+		printf("Branch %d finished at time = %.0fms\n", b, end_time[b]);
+	}
+
+	// Summary
+	char filename[1000];
+	sprintf(filename, "%s/Branch_results.dat", results_directory);
+	FILE *out = fopen(filename, "w");
+	fprintf(out, "# branch end_time quiescent_at active_fraction conduction_type | branch arguments\n");
+	for (int b = 0; b < bs->N; b++) fprintf(out, "%d %f %f %f %d | %s\n", b, end_time[b], quiescent_at[b], active_fraction[b], type[b], bs->line[b]);
+	fclose(out);
+	printf("Results of %d branches written to %s\n", bs->N, filename);
+
+	for (int b = 0; b < bs->N; b++)
+	{
+		delete [] P[b];
+		delete [] index[b];
+	}
+}
+
+void branch_scenarios_free(Branch_scenarios *bs)
+{
+	for (int b = 0; b < bs->N; b++)
+	{
+		delete [] bs->line[b];
+		delete [] bs->buffer[b];
+	}
+	delete [] bs->line;
+	delete [] bs->buffer;
+	delete [] bs->A;
+	if (bs->taken == true) tissue_snapshot_free(&bs->snap);
+}
+// End Branch scenarios =========================================================================//|
+
+// Modulation events =============================================================================\|
+// A timeline of changes to the conditions and modulation (ISO, ACh, remodelling, current scaling etc) applied during the
+// run, replacing write-state/restart cycles. Each line of the event file is "time [ramp x [ramp_step x]] arguments";
+// events are cumulative (each on top of the command line and all earlier events), direct modulation follows the
+// Direct_modulation map as at setup, and ISO/ACh/remodelling the maps. A ramp changes each numeric argument linearly
+// from its previous value (as set by the command line, settings file and earlier events; else 1 for scale factors and
+// proportions, 0 otherwise) in steps of ramp_step (default 10 ms), reaching the event value at time + ramp. Ramps
+// apply to ISO, ACh, the proportions and direct current modulation (ramp_arguments).
+// On each event the parameters are reset once per parameter region and copied only to regions which have changed
+
+static bool is_number(const std::string &s)
+{
+	char *end;
+	strtod(s.c_str(), &end);
+	return s.size() > 0 && *end == 0;
+}
+
+// Arguments which can be ramped: name, value field, _arg flag and the value used while the argument has not been set
+typedef struct{
+	const char *name;
+	size_t value, set;
+	double unset;
+}Ramp_argument;
+static const Ramp_argument ramp_arguments[] = {
+	{"ISO", offsetof(Argument_parameters, ISO), offsetof(Argument_parameters, ISO_arg), 0}, {"ACh", offsetof(Argument_parameters, ACh), offsetof(Argument_parameters, ACh_arg), 0}, {"Remodelling_proportion", offsetof(Argument_parameters, Remodelling_prop), offsetof(Argument_parameters, Remodelling_prop_arg), 1},
+	{"Agent_proportion", offsetof(Argument_parameters, Agent_prop), offsetof(Argument_parameters, Agent_prop_arg), 1}, {"Spatial_gradient_proportion", offsetof(Argument_parameters, spatial_gradient_prop), offsetof(Argument_parameters, spatial_gradient_prop_arg), 1}, {"INa_scale", offsetof(Argument_parameters, GNa), offsetof(Argument_parameters, GNa_arg), 1},
+	{"INaL_scale", offsetof(Argument_parameters, GNaL), offsetof(Argument_parameters, GNaL_arg), 1}, {"Ito_scale", offsetof(Argument_parameters, Gto), offsetof(Argument_parameters, Gto_arg), 1}, {"ICaL_scale", offsetof(Argument_parameters, GCaL), offsetof(Argument_parameters, GCaL_arg), 1},
+	{"IKur_scale", offsetof(Argument_parameters, GKur), offsetof(Argument_parameters, GKur_arg), 1}, {"IKr_scale", offsetof(Argument_parameters, GKr), offsetof(Argument_parameters, GKr_arg), 1}, {"IKs_scale", offsetof(Argument_parameters, GKs), offsetof(Argument_parameters, GKs_arg), 1},
+	{"IK1_scale", offsetof(Argument_parameters, GK1), offsetof(Argument_parameters, GK1_arg), 1}, {"INCX_scale", offsetof(Argument_parameters, GNCX), offsetof(Argument_parameters, GNCX_arg), 1}, {"ICaP_scale", offsetof(Argument_parameters, GCaP), offsetof(Argument_parameters, GCaP_arg), 1},
+	{"INab_scale", offsetof(Argument_parameters, GNab), offsetof(Argument_parameters, GNab_arg), 1}, {"ICab_scale", offsetof(Argument_parameters, GCab), offsetof(Argument_parameters, GCab_arg), 1}, {"IKb_scale", offsetof(Argument_parameters, GKb), offsetof(Argument_parameters, GKb_arg), 1},
+	{"INaK_scale", offsetof(Argument_parameters, GNaK), offsetof(Argument_parameters, GNaK_arg), 1}, {"IClCa_scale", offsetof(Argument_parameters, GClCa), offsetof(Argument_parameters, GClCa_arg), 1}, {"IClb_scale", offsetof(Argument_parameters, GClb), offsetof(Argument_parameters, GClb_arg), 1},
+	{"IKACh_scale", offsetof(Argument_parameters, GKACh), offsetof(Argument_parameters, GKACh_arg), 1}, {"Jup_scale", offsetof(Argument_parameters, Gup), offsetof(Argument_parameters, Gup_arg), 1}, {"Jleak_scale", offsetof(Argument_parameters, Gleak), offsetof(Argument_parameters, Gleak_arg), 1},
+	{"Jrel_scale", offsetof(Argument_parameters, Grel), offsetof(Argument_parameters, Grel_arg), 1}, {"INa_va_tau_scale", offsetof(Argument_parameters, INa_va_tau_scale), offsetof(Argument_parameters, INa_va_tau_scale_arg), 1}, {"INa_vi_1_tau_scale", offsetof(Argument_parameters, INa_vi_1_tau_scale), offsetof(Argument_parameters, INa_vi_1_tau_scale_arg), 1},
+	{"INa_vi_2_tau_scale", offsetof(Argument_parameters, INa_vi_2_tau_scale), offsetof(Argument_parameters, INa_vi_2_tau_scale_arg), 1}, {"INaL_va_tau_scale", offsetof(Argument_parameters, INaL_va_tau_scale), offsetof(Argument_parameters, INaL_va_tau_scale_arg), 1}, {"INaL_vi_tau_scale", offsetof(Argument_parameters, INaL_vi_tau_scale), offsetof(Argument_parameters, INaL_vi_tau_scale_arg), 1},
+	{"Ito_va_tau_scale", offsetof(Argument_parameters, Ito_va_tau_scale), offsetof(Argument_parameters, Ito_va_tau_scale_arg), 1}, {"Ito_vi_tau_scale", offsetof(Argument_parameters, Ito_vi_tau_scale), offsetof(Argument_parameters, Ito_vi_tau_scale_arg), 1}, {"ICaL_va_tau_scale", offsetof(Argument_parameters, ICaL_va_tau_scale), offsetof(Argument_parameters, ICaL_va_tau_scale_arg), 1},
+	{"ICaL_vi_tau_scale", offsetof(Argument_parameters, ICaL_vi_tau_scale), offsetof(Argument_parameters, ICaL_vi_tau_scale_arg), 1}, {"IKur_va_tau_scale", offsetof(Argument_parameters, IKur_va_tau_scale), offsetof(Argument_parameters, IKur_va_tau_scale_arg), 1}, {"IKur_vi_tau_scale", offsetof(Argument_parameters, IKur_vi_tau_scale), offsetof(Argument_parameters, IKur_vi_tau_scale_arg), 1},
+	{"IKr_va_tau_scale", offsetof(Argument_parameters, IKr_va_tau_scale), offsetof(Argument_parameters, IKr_va_tau_scale_arg), 1}, {"IKs_va_tau_scale", offsetof(Argument_parameters, IKs_va_tau_scale), offsetof(Argument_parameters, IKs_va_tau_scale_arg), 1}, {"IKACh_va_tau_scale", offsetof(Argument_parameters, IKACh_va_tau_scale), offsetof(Argument_parameters, IKACh_va_tau_scale_arg), 1},
+	{"INa_va_shift", offsetof(Argument_parameters, INa_va_shift), offsetof(Argument_parameters, INa_va_shift_arg), 0}, {"INa_vi_shift", offsetof(Argument_parameters, INa_vi_shift), offsetof(Argument_parameters, INa_vi_shift_arg), 0}, {"INaL_va_shift", offsetof(Argument_parameters, INaL_va_shift), offsetof(Argument_parameters, INaL_va_shift_arg), 0},
+	{"INaL_vi_shift", offsetof(Argument_parameters, INaL_vi_shift), offsetof(Argument_parameters, INaL_vi_shift_arg), 0}, {"Ito_va_ss_shift", offsetof(Argument_parameters, Ito_va_ss_shift), offsetof(Argument_parameters, Ito_va_ss_shift_arg), 0}, {"Ito_va_tau_shift", offsetof(Argument_parameters, Ito_va_tau_shift), offsetof(Argument_parameters, Ito_va_tau_shift_arg), 0},
+	{"Ito_vi_ss_shift", offsetof(Argument_parameters, Ito_vi_ss_shift), offsetof(Argument_parameters, Ito_vi_ss_shift_arg), 0}, {"Ito_vi_tau_shift", offsetof(Argument_parameters, Ito_vi_tau_shift), offsetof(Argument_parameters, Ito_vi_tau_shift_arg), 0}, {"Ito_shift", offsetof(Argument_parameters, Ito_shift), offsetof(Argument_parameters, Ito_shift_arg), 0},
+	{"ICaL_va_ss_shift", offsetof(Argument_parameters, ICaL_va_ss_shift), offsetof(Argument_parameters, ICaL_va_ss_shift_arg), 0}, {"ICaL_va_tau_shift", offsetof(Argument_parameters, ICaL_va_tau_shift), offsetof(Argument_parameters, ICaL_va_tau_shift_arg), 0}, {"ICaL_vi_ss_shift", offsetof(Argument_parameters, ICaL_vi_ss_shift), offsetof(Argument_parameters, ICaL_vi_ss_shift_arg), 0},
+	{"ICaL_vi_tau_shift", offsetof(Argument_parameters, ICaL_vi_tau_shift), offsetof(Argument_parameters, ICaL_vi_tau_shift_arg), 0}, {"ICaL_shift", offsetof(Argument_parameters, ICaL_shift), offsetof(Argument_parameters, ICaL_shift_arg), 0}, {"IKur_va_ss_shift", offsetof(Argument_parameters, IKur_va_ss_shift), offsetof(Argument_parameters, IKur_va_ss_shift_arg), 0},
+	{"IKur_va_tau_shift", offsetof(Argument_parameters, IKur_va_tau_shift), offsetof(Argument_parameters, IKur_va_tau_shift_arg), 0}, {"IKur_vi_ss_shift", offsetof(Argument_parameters, IKur_vi_ss_shift), offsetof(Argument_parameters, IKur_vi_ss_shift_arg), 0}, {"IKur_vi_tau_shift", offsetof(Argument_parameters, IKur_vi_tau_shift), offsetof(Argument_parameters, IKur_vi_tau_shift_arg), 0},
+	{"IKur_shift", offsetof(Argument_parameters, IKur_shift), offsetof(Argument_parameters, IKur_shift_arg), 0}, {"IKr_va_ss_shift", offsetof(Argument_parameters, IKr_va_ss_shift), offsetof(Argument_parameters, IKr_va_ss_shift_arg), 0}, {"IKr_va_tau_shift", offsetof(Argument_parameters, IKr_va_tau_shift), offsetof(Argument_parameters, IKr_va_tau_shift_arg), 0},
+	{"IKr_vi_ss_shift", offsetof(Argument_parameters, IKr_vi_ss_shift), offsetof(Argument_parameters, IKr_vi_ss_shift_arg), 0}, {"IKs_va_ss_shift", offsetof(Argument_parameters, IKs_va_ss_shift), offsetof(Argument_parameters, IKs_va_ss_shift_arg), 0}, {"IKs_va_tau_shift", offsetof(Argument_parameters, IKs_va_tau_shift), offsetof(Argument_parameters, IKs_va_tau_shift_arg), 0},
+	{"IK1_va_shift", offsetof(Argument_parameters, IK1_va_shift), offsetof(Argument_parameters, IK1_va_shift_arg), 0}, {"IK1_Erev_shift", offsetof(Argument_parameters, IK1_Erev_shift), offsetof(Argument_parameters, IK1_Erev_shift_arg), 0}, {"IKACh_va_ss_shift", offsetof(Argument_parameters, IKACh_va_ss_shift), offsetof(Argument_parameters, IKACh_va_ss_shift_arg), 0},
+	{"IKACh_va_tau_shift", offsetof(Argument_parameters, IKACh_va_tau_shift), offsetof(Argument_parameters, IKACh_va_tau_shift_arg), 0}, {"Ito_va_ss_kscale", offsetof(Argument_parameters, Ito_va_ss_kscale), offsetof(Argument_parameters, Ito_va_ss_kscale_arg), 1}, {"Ito_vi_ss_kscale", offsetof(Argument_parameters, Ito_vi_ss_kscale), offsetof(Argument_parameters, Ito_vi_ss_kscale_arg), 1},
+	{"ICaL_va_ss_kscale", offsetof(Argument_parameters, ICaL_va_ss_kscale), offsetof(Argument_parameters, ICaL_va_ss_kscale_arg), 1}, {"ICaL_vi_ss_kscale", offsetof(Argument_parameters, ICaL_vi_ss_kscale), offsetof(Argument_parameters, ICaL_vi_ss_kscale_arg), 1}, {"IKur_va_ss_kscale", offsetof(Argument_parameters, IKur_va_ss_kscale), offsetof(Argument_parameters, IKur_va_ss_kscale_arg), 1},
+	{"IKur_vi_ss_kscale", offsetof(Argument_parameters, IKur_vi_ss_kscale), offsetof(Argument_parameters, IKur_vi_ss_kscale_arg), 1}, {"IKr_va_ss_kscale", offsetof(Argument_parameters, IKr_va_ss_kscale), offsetof(Argument_parameters, IKr_va_ss_kscale_arg), 1}, {"IKr_vi_ss_kscale", offsetof(Argument_parameters, IKr_vi_ss_kscale), offsetof(Argument_parameters, IKr_vi_ss_kscale_arg), 1},
+	{"IKs_va_ss_kscale", offsetof(Argument_parameters, IKs_va_ss_kscale), offsetof(Argument_parameters, IKs_va_ss_kscale_arg), 1}, {"IKACh_va_ss_kscale", offsetof(Argument_parameters, IKACh_va_ss_kscale), offsetof(Argument_parameters, IKACh_va_ss_kscale_arg), 1}};
+
+// Value of the rampable argument name in A (the unset value if it has not been set) || false if name cannot be ramped
+static bool argument_value(const Argument_parameters &A, const std::string &name, double *value)
+{
+	for (size_t r = 0; r < sizeof(ramp_arguments)/sizeof(Ramp_argument); r++)
+	{
+		if (name != ramp_arguments[r].name) continue;
+		const char *a = (const char*)&A;
+		*value = (*(const bool*)(a + ramp_arguments[r].set) == true) ? *(const double*)(a + ramp_arguments[r].value) : ramp_arguments[r].unset;
+		return true;
+	}
+	return false;
+}
+
+void modulation_events_setup(Modulation_events *ev, Argument_parameters *Argin, int Nstrands, const char *directory)
+{
+	if (Nstrands > 0 || Argin->Branch_file_arg == true)
+	{
+		printf("ERROR: Event_file cannot be combined with Strand_file or Branch_file\n");
+		exit(1);
+	}
+	std::vector<std::string> lines;
+	int Nlines = read_batch_file(Argin->Event_file, &lines);	// lib/Arguments.c
+
+	// Expand ramps into steps, substituting the interpolated values; each step is set on top of the previous one
+	char filename[500];
+	sprintf(filename, "%s/Event_schedule.dat", directory);
+	FILE *log = fopen(filename, "w");
+	std::vector<double> times;
+	std::vector<char*> steps, buffers;
+	std::vector<Argument_parameters> A;
+	double time_prev = -1;
+	for (int l = 0; l < Nlines; l++)
+	{
+		std::istringstream in(lines[l]);
+		std::vector<std::string> tok;
+		std::string t;
+		while (in >> t) tok.push_back(t);
+		if (is_number(tok[0]) == false || atof(tok[0].c_str()) < time_prev)
+		{
+			printf("ERROR: Event \"%s\" must start with its time (ms), in increasing order\n", lines[l].c_str());
+			exit(1);
+		}
+		double time = time_prev = atof(tok[0].c_str());
+		double ramp = 0, ramp_step = 10;
+		size_t i = 1;
+		while (i+1 < tok.size() && (tok[i] == "ramp" || tok[i] == "ramp_step"))
+		{
+			if (tok[i] == "ramp") ramp = atof(tok[i+1].c_str());
+			else ramp_step = atof(tok[i+1].c_str());
+			i += 2;
+		}
+		std::vector<std::string> args(tok.begin()+i, tok.end());
+		if (args.size() == 0 || ramp < 0 || ramp_step <= 0)
+		{
+			printf("ERROR: Event \"%s\" has no arguments or an invalid ramp\n", lines[l].c_str());
+			exit(1);
+		}
+		int Nsteps = (ramp > 0) ? (int)ceil(ramp/ramp_step - 1e-9) : 1;
+
+		// Values before this event of its ramped arguments
+		std::vector<double> start(args.size(), 0);
+		for (size_t a = 1; a < args.size() && Nsteps > 1; a++)
+		{
+			if (is_number(args[a]) == false || is_number(args[a-1]) == true) continue;
+			if (argument_value((A.size() == 0) ? *Argin : A.back(), args[a-1], &start[a]) == false)
+			{
+				printf("ERROR: \"%s\" cannot be ramped (event \"%s\"); ramps apply to ISO, ACh, proportions and direct current modulation\n", args[a-1].c_str(), lines[l].c_str());
+				exit(1);
+			}
+		}
+
+		for (int k = 1; k <= Nsteps; k++)
+		{
+			std::string step;
+			for (size_t a = 0; a < args.size(); a++)
+			{
+				char value[100];
+				if (a > 0 && is_number(args[a]) == true && is_number(args[a-1]) == false && Nsteps > 1)
+				{
+					sprintf(value, "%.10g", start[a] + (atof(args[a].c_str()) - start[a])*k/Nsteps);
+					step += value;
+				}
+				else step += args[a];
+				step += " ";
+			}
+			times.push_back(time + ((Nsteps > 1) ? ramp*k/Nsteps : 0));
+			steps.push_back(new char[step.size()+1]);
+			buffers.push_back(new char[step.size()+1]);
+			strcpy(steps.back(), step.c_str());
+			A.push_back(Argument_parameters());
+			fprintf(log, "%f ", times.back());
+			set_batch_job_arguments(&A.back(), (A.size() == 1) ? Argin : &A[A.size()-2], steps.back(), buffers.back(), log, "Tissue_native");	// lib/Arguments.c
+			fprintf(log, "\n");
+		}
+	}
+	fclose(log);
+
+	// Arguments in effect from each event
+	ev->N		= (int)steps.size();
+	ev->next	= 0;
+	ev->time	= new double[ev->N];
+	ev->line	= new char*[ev->N];
+	ev->buffer	= new char*[ev->N];
+	ev->A		= new Argument_parameters[ev->N];
+	for (int e = 0; e < ev->N; e++)
+	{
+		ev->time[e]		= times[e];
+		ev->line[e]		= steps[e];
+		ev->buffer[e]	= buffers[e];
+		ev->A[e]		= A[e];
+	}
+	printf(">%d modulation events (%d lines) read from %s\n", ev->N, Nlines, Argin->Event_file);
+}
+
+// Non-double fields of Cell_parameters; every other aligned word of the struct is a double
+static const size_t cell_string_fields[]	= {offsetof(Cell_parameters, Model), offsetof(Cell_parameters, Celltype), offsetof(Cell_parameters, Agent),
+	offsetof(Cell_parameters, Remodelling), offsetof(Cell_parameters, ISO_model), offsetof(Cell_parameters, ACh_model),
+	offsetof(Cell_parameters, spatial_gradient), offsetof(Cell_parameters, Mutation), offsetof(Cell_parameters, tau_ss_type),
+	offsetof(Cell_parameters, Ca_handling), offsetof(Cell_parameters, environment)};
+static const size_t cell_int_fields[]		= {offsetof(Cell_parameters, Het_set_ref), offsetof(Cell_parameters, ISO_set_ref),
+	offsetof(Cell_parameters, Agent_set_ref), offsetof(Cell_parameters, Remodelling_set_ref), offsetof(Cell_parameters, Mutation_set_ref),
+	offsetof(Cell_parameters, ACh_set_ref), offsetof(Cell_parameters, NRyR_mean), offsetof(Cell_parameters, NLTCC_mean)};
+
+// Field by field comparison (strings by content, doubles bitwise; padding is ignored)
+static bool cell_parameters_differ(const Cell_parameters &a, const Cell_parameters &b)
+{
+	const int Nstrings = sizeof(cell_string_fields)/sizeof(size_t), Nints = sizeof(cell_int_fields)/sizeof(size_t);
+	const char *pa = (const char*)&a, *pb = (const char*)&b;
+	std::vector<char> other(sizeof(Cell_parameters)/sizeof(double)+1, 0);	// words holding a non-double field
+	for (int f = 0; f < Nstrings; f++)
+	{
+		const char *x = *(const char* const*)(pa + cell_string_fields[f]), *y = *(const char* const*)(pb + cell_string_fields[f]);
+		if (x != y && (x == NULL || y == NULL || strcmp(x, y) != 0)) return true;
+		other[cell_string_fields[f]/sizeof(double)] = 1;
+	}
+	for (int f = 0; f < Nints; f++)
+	{
+		if (*(const int*)(pa + cell_int_fields[f]) != *(const int*)(pb + cell_int_fields[f])) return true;
+		other[cell_int_fields[f]/sizeof(double)] = 1;
+	}
+	if (a.hAM != b.hAM) return true;
+	other[offsetof(Cell_parameters, hAM)/sizeof(double)] = 1;
+	for (size_t w = 0; w < sizeof(Cell_parameters)/sizeof(double); w++)
+	{
+		if (other[w] == 1) continue;
+		if (memcmp(pa + w*sizeof(double), pb + w*sizeof(double), sizeof(double)) != 0) return true;
+	}
+	return false;
+}
+
+// Resets the parameters of every region from the event's arguments (as the tissue setup); only changed regions are copied to their nodes
+void apply_modulation_event(Modulation_events *ev, int e, Tissue_parameters Tissue, SC_variables SC, Cell_parameters *Params, Cell_parameters Params_global, int *region_node, int *region_list, int Nregions, double dt)
+{
+	Argument_parameters &A = ev->A[e];
+	Cell_parameters conditions;
+	set_model_conditions(&conditions, A);	// lib/Initialisation.c
+	if (A.Model_arg == true && strcmp(A.Model, Params_global.Model) != 0)
+	{
+		printf("ERROR: Model cannot be changed by a modulation event (\"%s\")\n", A.Model);
+		exit(1);
+	}
+	conditions.Model = Params_global.Model;
+
+	std::vector<char> changed(SC.N, 0);	// by first node of region
+	int Nchanged = 0;
+	#pragma omp parallel for schedule(dynamic) reduction(+:Nchanged)
+	for (int r = 0; r < Nregions; r++)
+	{
+		int n = region_list[r];
+		Cell_parameters p = Params[n];	// fields not set by the setup keep their values
+		set_local_model_conditions(conditions, &p);	// lib/Initialisation.c
+		if (strcmp(Tissue.ISO_map_on, "On") == 0)	p.ISO				*= Tissue.ISO_map[n];
+		if (strcmp(Tissue.remod_map_on, "On") == 0)	p.Remodelling_prop	*= Tissue.remod_map[n];
+		if (strcmp(Tissue.ACh_map_on, "On") == 0)	p.ACh				*= Tissue.ACh_map[n];
+		set_region_parameters_native(&p, Tissue, SC, A, n, dt);	// lib/Tissue.cpp
+		if (p.dt != dt)
+		{
+			printf("ERROR: modulation event sets dt = %f, but the simulation uses dt = %f\n", p.dt, dt);
+			exit(1);
+		}
+		if (cell_parameters_differ(p, Params[n]) == true)
+		{
+			Params[n]	= p;
+			changed[n]	= 1;
+			Nchanged++;
+		}
+	}
+	int Ncells = 0;
+	#pragma omp parallel for reduction(+:Ncells)
+	for (int n = 0; n < SC.N; n++)
+	{
+		if (changed[region_node[n]] == 0) continue;
+		if (region_node[n] != n) Params[n] = Params[region_node[n]];
+		Ncells++;
+	}
+	printf("Modulation event %d (%s) at time = %.2fms: %d of %d regions (%d cells) updated\n", e, ev->line[e], ev->time[e], Nchanged, Nregions, Ncells);
+}
+
+void modulation_events_free(Modulation_events *ev)
+{
+	for (int e = 0; e < ev->N; e++)
+	{
+		delete [] ev->line[e];
+		delete [] ev->buffer[e];
+	}
+	delete [] ev->time;
+	delete [] ev->line;
+	delete [] ev->buffer;
+	delete [] ev->A;
+}
+// End Modulation events ========================================================================//|
+
+// Pacing protocol ===============================================================================\|
+// Replaces the S1 (BCL) and S2 train of compute_Istim() with a list of stimulus trains, one per line of the protocol file:
+// "site S1 start 0 repeats 10 interval 500" (S1 pacing), "site S2 start 5000 repeats 20 interval 150" (burst),
+// "site S1 start 10000 repeats 30 interval 400 decrement 10 interval_min 200" (decremental); duration and amplitude
+// default to the model stimulus (stimduration, stimmag). Sites are S1, S2 or, with Multi_stim, the stimulus map value n.
+// All pulses are compiled into a queue ordered by onset step; each step only the queue head and the pulses currently
+// on are checked, and site currents are applied through the stimulus site lists (apply_stimulus_site())
+
+static bool pulse_order(const std::vector<double> &a, const std::vector<double> &b) { return a[1] < b[1]; }
+
+void pacing_protocol_setup(Pacing_protocol *pp, const char *filename, Tissue_parameters Tissue, Cell_parameters p, Simulation_parameters *Sim, bool Total_time_arg, bool S2_area_set, const char *directory)
+{
+	std::vector<std::string> lines;
+	int Nlines = read_batch_file(filename, &lines);	// lib/Arguments.c
+	if (Nlines == 0)
+	{
+		printf("ERROR: Protocol file \"%s\" contains no stimuli\n", filename);
+		exit(1);
+	}
+	int steps_per_ms = (int)(1/Sim->dt);
+	int Nsites = (strcmp(Tissue.Multi_stim, "On") == 0) ? Tissue.Nstims + 1 : 2;
+
+	// Expand each train into pulses || site, onset step, stop step, amplitude
+	std::vector<std::vector<double> > pulses;
+	for (int l = 0; l < Nlines; l++)
+	{
+		std::istringstream in(lines[l]);
+		std::string key, value;
+		int site = 0, repeats = 1;
+		double start = 0, duration = p.stimduration, amplitude = p.stimmag, interval = Sim->BCL, decrement = 0, interval_min = 0;
+		while (in >> key >> value)
+		{
+			if      (key == "site")			site			= (value == "S1" || value == "1") ? 0 : (value == "S2") ? 1 : (is_number(value) == true) ? atoi(value.c_str()) : -1;
+			else if (key == "start")		start			= atof(value.c_str());
+			else if (key == "duration")		duration		= atof(value.c_str());
+			else if (key == "amplitude")	amplitude		= atof(value.c_str());
+			else if (key == "repeats")		repeats			= atoi(value.c_str());
+			else if (key == "interval")		interval		= atof(value.c_str());
+			else if (key == "decrement")	decrement		= atof(value.c_str());
+			else if (key == "interval_min")	interval_min	= atof(value.c_str());
+			else
+			{
+				printf("ERROR: \"%s\" is not a valid protocol entry (line \"%s\")\n", key.c_str(), lines[l].c_str());
+				exit(1);
+			}
+		}
+		if (site < 0 || site >= Nsites || (site == 1 && S2_area_set == false))
+		{
+			printf("ERROR: stimulus site in \"%s\" is not set in this tissue (S1, S2 or multi-stim map value 2-%d)\n", lines[l].c_str(), Nsites-1);
+			exit(1);
+		}
+		if (repeats < 1 || duration <= 0 || interval <= 0)
+		{
+			printf("ERROR: protocol line \"%s\" needs repeats >= 1, duration > 0 and interval > 0\n", lines[l].c_str());
+			exit(1);
+		}
+		double t = start;
+		for (int r = 0; r < repeats; r++)
+		{
+			int onset = (int)round(t*steps_per_ms);
+			std::vector<double> pulse = {(double)site, (double)onset, (double)(onset + (int)round(duration*steps_per_ms)), amplitude};
+			pulses.push_back(pulse);
+			t += interval;
+			interval = std::max(interval - decrement, interval_min);
+		}
+	}
+	std::stable_sort(pulses.begin(), pulses.end(), pulse_order);
+
+	pp->N			= (int)pulses.size();
+	pp->site		= new int[pp->N];
+	pp->start		= new int[pp->N];
+	pp->stop		= new int[pp->N];
+	pp->amplitude	= new double[pp->N];
+	pp->active		= new int[pp->N];
+	char name[500];
+	sprintf(name, "%s/Protocol_schedule.dat", directory);
+	FILE *out = fopen(name, "w");
+	fprintf(out, "# site onset(ms) duration(ms) amplitude\n");
+	for (int i = 0; i < pp->N; i++)
+	{
+		pp->site[i]			= (int)pulses[i][0];
+		pp->start[i]		= (int)pulses[i][1];
+		pp->stop[i]			= (int)pulses[i][2];
+		pp->amplitude[i]	= pulses[i][3];
+		fprintf(out, "%d %f %f %f\n", pp->site[i], pp->start[i]*Sim->dt, (pp->stop[i]-pp->start[i])*Sim->dt, pp->amplitude[i]);
+	}
+	fclose(out);
+	pacing_protocol_seek(pp, 0);
+
+	// Simulation timing from the protocol || S2 is part of the protocol; run one BCL after the last onset unless Total_time is passed
+	double last_onset	= pp->start[pp->N-1]*Sim->dt;
+	Sim->S2_CL			= 0;
+	Sim->Paced_time		= last_onset;
+	if (Total_time_arg == false)
+	{
+		Sim->Total_time					= (int)ceil(last_onset) + Sim->BCL;
+		Sim->Spatial_output_end_time	= Sim->Total_time;
+	}
+	printf(">Pacing protocol: %d pulses from %d trains in %s; last onset at %.2f ms\n", pp->N, Nlines, filename, last_onset);
+}
+
+// Sets the queue position and pulses on for a run (or restart) starting at step iteration_counter
+void pacing_protocol_seek(Pacing_protocol *pp, int iteration_counter)
+{
+	pp->next	= 0;
+	pp->Nactive	= 0;
+	while (pp->next < pp->N && pp->start[pp->next] < iteration_counter)
+	{
+		if (pp->stop[pp->next] > iteration_counter) pp->active[pp->Nactive++] = pp->next;
+		pp->next++;
+	}
+}
+
+// Site currents for this step || pulse on for steps start to stop-1, as compute_Istim(); onsets reset measurement of var (Variables[0])
+void pacing_protocol_step(Pacing_protocol *pp, Model_variables *var, int iteration_counter)
+{
+	while (pp->next < pp->N && pp->start[pp->next] == iteration_counter)
+	{
+		pp->active[pp->Nactive++] = pp->next++;
+		var->ex_switch = 0;
+	}
+	for (int s = 0; s < 22; s++) pp->Istim[s] = 0.0;
+	for (int a = 0; a < pp->Nactive; a++)
+	{
+		int i = pp->active[a];
+		if (pp->stop[i] <= iteration_counter)
+		{
+			pp->active[a--] = pp->active[--pp->Nactive];	// pulse has ended
+			continue;
+		}
+		pp->Istim[pp->site[i]] += pp->amplitude[i];
+	}
+}
+
+void pacing_protocol_free(Pacing_protocol *pp)
+{
+	delete [] pp->site;
+	delete [] pp->start;
+	delete [] pp->stop;
+	delete [] pp->amplitude;
+	delete [] pp->active;
+}
+// End Pacing protocol ==========================================================================//|
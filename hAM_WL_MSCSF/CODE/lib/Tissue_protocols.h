@@ -0,0 +1,113 @@
+// Source code associated with  ===========================  //
+// "Multi-scale cardiac simulation framework" =============  //
+// For simulation of cardiac cellular and tissue dynamics =  //
+// from the spatial cellular to full organ scales. ========  //
+// With implementation of multiple, published cell models =  //
+// as well as novel models developed in my lab. ===========  //
+// ========================================================  //
+// This file: Tissue protocols: batched independent =======  //
+// 1D strands, and runs from an in-memory snapshot ========  //
+// of the tissue (vulnerability window search). ===========  //
+// ========================================================  //
+// GNU 3 LICENSE TEXT =====================================  //
+// COPYRIGHT (C) 2016-2019 MICHAEL A. COLMAN ==============  //
+// THIS PROGRAM IS FREE SOFTWARE: YOU CAN REDISTRIBUTE IT =  //
+// AND/OR MODIFY IT UNDER THE TERMS OF THE GNU GENERAL ====  //
+// PUBLIC LICENSE AS PUBLISHED BY THE FREE SOFTWARE =======  //
+// FOUNDATION, EITHER VERSION 3 OF THE LICENSE, OR (AT YOUR  //
+// OPTION) ANY LATER VERSION. =============================  //
+// THIS PROGRAM IS DISTRIBUTED IN THE HOPE THAT IT WILL BE=  //
+// USEFUL, BUT WITHOUT ANY WARRANTY; WITHOUT EVEN THE =====  //
+// IMPLIED WARRANTY OF MERCHANTABILITY OR FITNESS FOR A ===  //
+// PARTICULAR PURPOSE.  SEE THE GNU GENERAL PUBLIC LICENSE=  //
+// FOR MORE DETAILS. ======================================  //
+// YOU SHOULD HAVE RECEIVED A COPY OF THE GNU GENERAL =====  //
+// PUBLIC LICENSE ALONG WITH THIS PROGRAM.  IF NOT, SEE ===  //
+// <https://www.gnu.org/licenses/>. =======================  //
+// ========================================================  //
+// ADDITIONAL LICENSE TEXT ================================  //
+// THIS SOFTWARE IS PROVIDED OPEN SOURCE AND MAY BE FREELY=  //
+// USED, DISTRIBUTED AND UPDATED, PROVIDED: ===============  //
+//  (i) THE APPROPRIATE WORK(S) IS(ARE) CITED. THIS =======  //
+//      PERTAINS TO THE CITATION OF COLMAN 2019 PLOS COMP =  //
+//      BIOL (FOR THIS IMPLEMTATION) AND ALL WORKS ========  //
+//      ASSOCIATED WITH THE SPECIFIC MODELS AND COMPONENTS=  //
+//      USED IN PARTICULAR SIMULATIONS. IT IS THE USER'S ==  //
+//      RESPONSIBILITY TO ENSURE ALL RELEVANT WORKS ARE ===  //
+//      CITED. PLEASE SEE FULL DOCUMENTATION AND ON-SCREEN=  //
+//      DISCLAIMER OUTPUTS FOR A GUIDE. ===================  //
+//  (ii) ALL OF THIS TEXT IS RETAINED WITHIN OR ASSOCIATED=  //
+//      WITH THE SOURCE CODE AND/OR BINARY FORM OF THE ====  //
+//      SOFTWARE. =========================================  //
+// ========================================================  //
+// ANY INTENDED COMMERCIAL USE OF THIS SOFTWARE MUST BE BY   //
+// EXPRESS PERMISSION OF MICHAEL A COLMAN ONLY. IN NO EVENT  //
+// ARE THE COPYRIGHT HOLDERS LIABLE FOR ANY DIRECT, =======  //
+// INDIRECT INCIDENTAL, SPECIAL, EXEMPLARY OR CONSEQUENTIAL  //
+// DAMAGES ASSOCIATED WITH USE OF THIS SOFTWARE ===========  //
+// ========================================================  //
+// THIS SOFTWARE CONTAINS IMPLEMENTATIONS OF MODELS AND ===  //
+// COMPONENTS WHICH I (MICHAEL COLMAN) DID NOT DEVELOP.====  //
+// ALL OF THESE COMPONENTS HAVE BEEN CODED FROM PROVIDED ==  //
+// SOURCE CODE OR INFORMATION IN THE PUBLICATIONS. ========  //
+// I CLAIM NO RIGHTS OR INTELLECTUAL PROPERTY OWNERSHIP ===  //
+// FOR THESE MODELS AND COMPONENTS, OTHER THAN THEIR ======  //
+// SPECIFIC IMPLEMENTATION IN THIS CODE PACKAGE. FURTHER TO  //
+// THE ABOVE STATEMENT, ANY INDTENDED COMMERCIAL USE OF ===  //
+// THOSE COMPONENTS MUST BE BY EXPRESS PERMISSION OF THE ==  //
+// ORIGINAL COPYRIGHT HOLDERS. ============================  //
+// WHERE IMPLEMENTED FROM PROVIDED CODE, ANY DISCLAIMERS ==  //
+// PRESENT IN THE ORIGINAL CODE HAVE BEEN RETAINED IN THE =  //
+// RELEVANT FILE. =========================================  //
+// ========================================================  //
+// Contact: m.a.colman@leeds.ac.uk ========================  //
+// For updates, corrections etc, please check: ============  //
+// 1. http://physicsoftheheart.com/ =======================  //
+// 2. https://github.com/michaelcolman ====================  //
+// ========================================================  //
+
+#ifndef TISSUE_PROTOCOLS_H
+#define TISSUE_PROTOCOLS_H
+
+#include "Structs.h"
+#include <vector>
+
+// Strand batch (independent 1D strands as rows of one domain)
+void strand_batch_setup(Strand_batch *sb, Argument_parameters *Argin, Simulation_parameters *Sim, const char *directory);
+void strand_batch_tissue(Strand_batch *sb, Tissue_parameters *t);
+void strand_batch_conditions(Strand_batch *sb, Cell_parameters Params_global);
+void strand_batch_stimulus(Strand_batch *sb, Tissue_parameters *t, SC_variables *sc, Cell_parameters p, Simulation_parameters Sim);
+void strand_batch_compute_Istim(Strand_batch *sb, Cell_parameters p, Simulation_parameters Sim, double sim_time, int iteration_counter);
+void strand_batch_apply_S2(Strand_batch *sb, Tissue_parameters *t, SC_variables sc);
+bool strand_batch_full_conduction(Strand_batch *sb, Model_variables *var, int NX);
+void strand_batch_results(Strand_batch *sb, Model_variables *var, int NX, const char *directory, const char *results_directory);
+void strand_batch_free(Strand_batch *sb);
+
+// Tissue snapshot and step
+void tissue_snapshot_take(Tissue_snapshot *s, State_variables *State, Model_variables *Variables, double *Vm, int N, double sim_time, int iteration_counter);
+void tissue_snapshot_free(Tissue_snapshot *s);
+void step_tissue_native(SC_variables *sc, Tissue_parameters *t, Cell_parameters *Params, int *param_index, State_variables *State, Model_variables *Variables, double *Vm, int *S2_stim_area, double dt, double sim_time, double Istim, double Istim_S2);
+
+// Vulnerability window search
+int vw_evaluate(Tissue_snapshot *snap, SC_variables sc, Tissue_parameters *t, Cell_parameters *Params, Simulation_parameters Sim, int *S2_stim_area, double S2, double window, int *left, int *right);
+void run_vulnerability_window_search(Argument_parameters A, Simulation_parameters Sim, Tissue_parameters Tissue, SC_variables SC, Cell_parameters *Params, State_variables *State, Model_variables *Variables, double *Vm, const char *directory);
+
+// Branch scenarios (what-if runs from a snapshot of the tissue)
+void branch_scenarios_setup(Branch_scenarios *bs, Argument_parameters *Argin, Simulation_parameters Sim, Tissue_parameters Tissue, int Nstrands, double sim_time_start, const char *directory, const char *results_directory);
+int branch_parameters(Argument_parameters A, Tissue_parameters Tissue, SC_variables SC, Cell_parameters *Params, Cell_parameters Params_global, double dt, Cell_parameters *local, int *region_node, int *region_list);
+double branch_run(Tissue_snapshot *snap, int b, SC_variables sc, Tissue_parameters *t, Cell_parameters *P, int *index, Cell_parameters stim, Simulation_parameters Sim, double early_stop_start, const char *results_directory, double *end_time, double *active_fraction, int *type);
+void run_branch_scenarios(Branch_scenarios *bs, Simulation_parameters Sim, Tissue_parameters Tissue, SC_variables SC, Cell_parameters *Params, Cell_parameters Params_global, const char *results_directory);
+void branch_scenarios_free(Branch_scenarios *bs);
+
+// Modulation events (condition and modulation changes during the run)
+void modulation_events_setup(Modulation_events *ev, Argument_parameters *Argin, int Nstrands, const char *directory);
+void apply_modulation_event(Modulation_events *ev, int e, Tissue_parameters Tissue, SC_variables SC, Cell_parameters *Params, Cell_parameters Params_global, int *region_node, int *region_list, int Nregions, double dt);
+void modulation_events_free(Modulation_events *ev);
+
+// Pacing protocol (timed stimulus trains on the stimulus sites)
+void pacing_protocol_setup(Pacing_protocol *pp, const char *filename, Tissue_parameters Tissue, Cell_parameters p, Simulation_parameters *Sim, bool Total_time_arg, bool S2_area_set, const char *directory);
+void pacing_protocol_seek(Pacing_protocol *pp, int iteration_counter);
+void pacing_protocol_step(Pacing_protocol *pp, Model_variables *var, int iteration_counter);
+void pacing_protocol_free(Pacing_protocol *pp);
+
+#endif